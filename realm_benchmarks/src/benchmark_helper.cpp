@@ -0,0 +1,183 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <memory>
+
+#include "benchmark_helper.h"
+
+using namespace realm;
+
+cv::Mat benchmark::createDummyPose()
+{
+  cv::Mat pose = cv::Mat::zeros(3, 4, CV_64F);
+  pose.at<double>(0, 1) = 1.0;
+  pose.at<double>(1, 0) = 1.0;
+  pose.at<double>(2, 2) = -1.0;
+  pose.at<double>(0, 3) = 500.0;
+  pose.at<double>(1, 3) = 600.0;
+  pose.at<double>(2, 3) = 1200.0;
+  return pose;
+}
+
+camera::Pinhole benchmark::createDummyPinhole()
+{
+  cv::Mat K = cv::Mat::eye(3, 3, CV_64F);
+  K.at<double>(0, 0) = 1200.0;
+  K.at<double>(1, 1) = 1200.0;
+  K.at<double>(0, 2) = 600.0;
+  K.at<double>(1, 2) = 500.0;
+  return camera::Pinhole(K, cv::Mat::zeros(5, 1, CV_64F), 1200, 1000);
+}
+
+Frame::Ptr benchmark::createDummyFrame(uint64_t seed)
+{
+  cv::RNG rng(seed);
+  cv::Mat img(1000, 1200, CV_8UC4);
+  rng.fill(img, cv::RNG::UNIFORM, 0, 256);
+
+  UTMPose utm(603976, 5791569, 100.0, 45.0, 32, 'U');
+  auto cam = std::make_shared<camera::Pinhole>(createDummyPinhole());
+
+  auto frame = std::make_shared<Frame>("DUMMY_CAM", 123456, 1234567890, img, utm, cam);
+  frame->setVisualPose(createDummyPose());
+  frame->setKeyframe(true);
+  return frame;
+}
+
+camera::Pinhole::Ptr benchmark::createNadirCamera(int width, int height)
+{
+  cv::Mat K = cv::Mat::eye(3, 3, CV_64F);
+  K.at<double>(0, 0) = width;
+  K.at<double>(1, 1) = width;
+  K.at<double>(0, 2) = width/2.0;
+  K.at<double>(1, 2) = height/2.0;
+
+  auto cam = std::make_shared<camera::Pinhole>(K, cv::Mat::zeros(5, 1, CV_64F), width, height);
+
+  cv::Mat pose = cv::Mat::zeros(3, 4, CV_64F);
+  pose.at<double>(0, 0) = 1.0;
+  pose.at<double>(1, 1) = -1.0;
+  pose.at<double>(2, 2) = -1.0;
+  pose.at<double>(2, 3) = 1200.0;
+  cam->setPose(pose);
+  return cam;
+}
+
+cv::Mat benchmark::createSyntheticCloud(int n, uint64_t seed)
+{
+  cv::RNG rng(seed);
+  cv::Mat points(n, 3, CV_64F);
+  rng.fill(points.col(0), cv::RNG::UNIFORM, -600.0, 600.0);
+  rng.fill(points.col(1), cv::RNG::UNIFORM, -500.0, 500.0);
+  rng.fill(points.col(2), cv::RNG::NORMAL, 0.0, 20.0);
+  return points;
+}
+
+CvGridMap benchmark::createSyntheticSurface(const cv::Rect2d &roi, double resolution, double invalid_ratio, uint64_t seed)
+{
+  cv::RNG rng(seed);
+  CvGridMap map(roi, resolution);
+  cv::Size2i dim = map.size();
+
+  // Smooth hills with some high frequent noise on top
+  cv::Mat elevation(dim, CV_32F);
+  rng.fill(elevation, cv::RNG::NORMAL, 0.0, 0.2);
+  for (int r = 0; r < dim.height; ++r)
+  {
+    float* row = elevation.ptr<float>(r);
+    for (int c = 0; c < dim.width; ++c)
+    {
+      cv::Point2d pt = map.atPosition2d(r, c);
+      row[c] += static_cast<float>(20.0*sin(pt.x/97.0)*cos(pt.y/131.0) + 5.0*sin(pt.x/23.0 + pt.y/17.0));
+    }
+  }
+
+  cv::Mat color_rgb(dim, CV_8UC4);
+  rng.fill(color_rgb, cv::RNG::UNIFORM, 0, 256);
+
+  cv::Mat random(dim, CV_32F);
+  rng.fill(random, cv::RNG::UNIFORM, 0.0, 1.0);
+  cv::Mat valid = (random >= invalid_ratio);
+
+  map.add("elevation", elevation);
+  map.add("color_rgb", color_rgb);
+  map.add("valid", valid);
+  return map;
+}
+
+CvGridMap benchmark::createSyntheticBlendMap(int size, bool is_reference, uint64_t seed)
+{
+  cv::RNG rng(seed);
+  CvGridMap map(cv::Rect2d(0.0, 0.0, size - 1, size - 1), 1.0);
+  cv::Size2i dim = map.size();
+
+  cv::Mat elevation(dim, CV_32F);
+  rng.fill(elevation, cv::RNG::NORMAL, 100.0, 1.0);
+  cv::Mat elevation_angle(dim, CV_32F);
+  rng.fill(elevation_angle, cv::RNG::UNIFORM, 45.0, 90.0);
+  cv::Mat color_rgb(dim, CV_8UC4);
+  rng.fill(color_rgb, cv::RNG::UNIFORM, 0, 256);
+  cv::Mat normals(dim, CV_32FC3);
+  rng.fill(normals, cv::RNG::UNIFORM, -1.0, 1.0);
+  cv::Mat elevated(dim, CV_8UC1);
+  rng.fill(elevated, cv::RNG::UNIFORM, 0, 2);
+  cv::Mat valid(dim, CV_8UC1);
+  rng.fill(valid, cv::RNG::UNIFORM, 0, 4);
+  valid = (valid > 0);
+
+  map.add("elevation", elevation);
+  map.add("elevation_angle", elevation_angle);
+  map.add("color_rgb", color_rgb);
+  map.add("elevation_normal", normals);
+  map.add("elevated", elevated*255);
+  map.add("valid", valid);
+
+  if (is_reference)
+  {
+    cv::Mat elevation_var(dim, CV_32F);
+    rng.fill(elevation_var, cv::RNG::UNIFORM, 0.0, 2.0);
+    cv::Mat elevation_hyp(dim, CV_32F);
+    rng.fill(elevation_hyp, cv::RNG::NORMAL, 100.0, 2.0);
+    cv::Mat num_observations(dim, CV_16UC1);
+    rng.fill(num_observations, cv::RNG::UNIFORM, 0, 5);
+
+    map.add("elevation_var", elevation_var);
+    map.add("elevation_hyp", elevation_hyp);
+    map.add("num_observations", num_observations);
+  }
+  return map;
+}
+
+cv::Mat benchmark::createSyntheticDepthMap(const camera::Pinhole::Ptr &cam, uint64_t seed)
+{
+  cv::RNG rng(seed);
+  cv::Mat depth_map(cam->height(), cam->width(), CV_32F);
+  rng.fill(depth_map, cv::RNG::NORMAL, 0.0, 0.2);
+
+  // Terrain below the nadir camera varies smoothly by about +-25 m around the altitude
+  for (int r = 0; r < depth_map.rows; ++r)
+  {
+    float* row = depth_map.ptr<float>(r);
+    for (int c = 0; c < depth_map.cols; ++c)
+      row[c] += static_cast<float>(1200.0 - 20.0*sin(c/97.0)*cos(r/131.0) - 5.0*sin(c/23.0 + r/17.0));
+  }
+  return depth_map;
+}
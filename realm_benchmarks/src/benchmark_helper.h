@@ -0,0 +1,101 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_BENCHMARK_HELPER_H
+#define PROJECT_BENCHMARK_HELPER_H
+
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+#include <realm_core/camera.h>
+#include <realm_core/frame.h>
+#include <realm_core/cv_grid_map.h>
+
+namespace realm
+{
+namespace benchmark
+{
+
+/*!
+ * @brief Nadir looking camera pose at 1200 m altitude, same as the dummy pose of the realm_core tests. Camera x-axis
+ * points along world y-axis, so the footprint of the dummy pinhole is about x = [0, 1000], y = [0, 1200].
+ */
+cv::Mat createDummyPose();
+
+/*!
+ * @brief Pinhole with 1200x1000 pixels and a focal length of 1200 pixels, same as the dummy pinhole of the tests
+ */
+camera::Pinhole createDummyPinhole();
+
+/*!
+ * @brief Creates a frame with dummy pinhole, dummy pose and a random CV_8UC4 image. Other than the test fixture the
+ * image has four channels and the pose is set, so the frame can be used directly for rectification.
+ * @param seed Seed of the random image
+ */
+Frame::Ptr createDummyFrame(uint64_t seed);
+
+/*!
+ * @brief Creates a nadir looking camera with 1200 m altitude above the origin
+ * @param width Image width in pixels, also used as focal length
+ * @param height Image height in pixels
+ */
+camera::Pinhole::Ptr createNadirCamera(int width, int height);
+
+/*!
+ * @brief Creates a synthetic sparse cloud of terrain points below the nadir camera. Some points are slightly displaced in
+ * height, so several points share one pixel.
+ * @param n Number of points
+ * @param seed Seed of the random generator
+ * @return Point cloud with rows x, y, z as CV_64F
+ */
+cv::Mat createSyntheticCloud(int n, uint64_t seed);
+
+/*!
+ * @brief Creates a smooth synthetic terrain as grid map with layers "elevation" (CV_32F), "color_rgb" (CV_8UC4) and
+ * "valid" (CV_8UC1). A fraction of the elements is marked invalid to resemble holes of the reconstruction.
+ * @param roi Region of interest of the map
+ * @param resolution Resolution of the map
+ * @param invalid_ratio Fraction of invalid grid elements in [0, 1]
+ * @param seed Seed of the random generator
+ */
+CvGridMap createSyntheticSurface(const cv::Rect2d &roi, double resolution, double invalid_ratio, uint64_t seed);
+
+/*!
+ * @brief Creates a synthetic map with all layers needed for blending. Values are random, but drawn so that all branches
+ * of the blending are hit in a realistic ratio.
+ * @param size Number of grid elements in both directions
+ * @param is_reference If true, the additional layers of the global map are created as well
+ * @param seed Seed of the random generator
+ */
+CvGridMap createSyntheticBlendMap(int size, bool is_reference, uint64_t seed);
+
+/*!
+ * @brief Creates a smooth synthetic depth map as seen by the nadir camera
+ * @param cam Camera as created by createNadirCamera(...)
+ * @param seed Seed of the random generator
+ * @return Depth map of type CV_32F
+ */
+cv::Mat createSyntheticDepthMap(const camera::Pinhole::Ptr &cam, uint64_t seed);
+
+} // namespace benchmark
+} // namespace realm
+
+#endif //PROJECT_BENCHMARK_HELPER_H
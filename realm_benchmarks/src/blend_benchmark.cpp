@@ -0,0 +1,195 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+
+#include <opencv2/core.hpp>
+
+#include <realm_core/cv_grid_map.h>
+#include <realm_stages/blending.h>
+
+#include "benchmark_helper.h"
+
+using namespace realm;
+
+/*!
+ * @brief Sequential per grid element blending as it was implemented in the mosaicing stage before. Used as baseline for
+ * timing and as reference for the bit exact comparison.
+ */
+void blendSequential(CvGridMap &ref, const CvGridMap &inp, const blending::Settings &settings)
+{
+  cv::Mat ref_ele = ref["elevation"], ref_var = ref["elevation_var"], ref_hyp = ref["elevation_hyp"];
+  cv::Mat ref_angle = ref["elevation_angle"], ref_nobs = ref["num_observations"], ref_rgb = ref["color_rgb"];
+  cv::Mat ref_elevated = ref["elevated"], ref_valid = ref["valid"], ref_normal = ref["elevation_normal"];
+  cv::Mat inp_ele = inp["elevation"], inp_angle = inp["elevation_angle"], inp_rgb = inp["color_rgb"];
+  cv::Mat inp_elevated = inp["elevated"], inp_valid = inp["valid"], inp_normal = inp["elevation_normal"];
+
+  for (int r = 0; r < ref_ele.rows; ++r)
+    for (int c = 0; c < ref_ele.cols; ++c)
+    {
+      float* ele = &ref_ele.ptr<float>(r)[c];
+      float* var = &ref_var.ptr<float>(r)[c];
+      float* hyp = &ref_hyp.ptr<float>(r)[c];
+      float* angle = &ref_angle.ptr<float>(r)[c];
+      uint16_t* nobs = &ref_nobs.ptr<uint16_t>(r)[c];
+      cv::Vec4b* rgb = &ref_rgb.ptr<cv::Vec4b>(r)[c];
+      uchar* elevated = &ref_elevated.ptr<uchar>(r)[c];
+      uchar* valid = &ref_valid.ptr<uchar>(r)[c];
+      cv::Vec3f* normal = &ref_normal.ptr<cv::Vec3f>(r)[c];
+      const float i_ele = inp_ele.ptr<float>(r)[c];
+      const float i_angle = inp_angle.ptr<float>(r)[c];
+      const cv::Vec4b i_rgb = inp_rgb.ptr<cv::Vec4b>(r)[c];
+      const uchar i_elevated = inp_elevated.ptr<uchar>(r)[c];
+      const uchar i_valid = inp_valid.ptr<uchar>(r)[c];
+      const cv::Vec3f i_normal = inp_normal.ptr<cv::Vec3f>(r)[c];
+
+      if (i_valid == 0)
+        continue;
+      if (*elevated && !i_elevated)
+        continue;
+
+      if (*nobs == 0 || (i_elevated && !*elevated))
+      {
+        *ele = i_ele; *elevated = i_elevated; *var = 0.0f; *hyp = 0.0f; *angle = i_angle; *rgb = i_rgb;
+        *nobs = 1; *valid = 255;
+        if (settings.use_surface_normals)
+          *normal = i_normal;
+        continue;
+      }
+
+      if (!i_elevated)
+      {
+        *ele = i_ele; *elevated = 0; *valid = 255; *nobs = (*nobs)+(uint16_t)1;
+        if (fabsf(i_angle - 90) < fabsf(*angle - 90))
+        {
+          *angle = i_angle; *rgb = i_rgb;
+        }
+        continue;
+      }
+
+      *valid = 0;
+      float variance_new = ((*nobs) + 1 - 2) / (float) ((*nobs) + 1 - 1) * (*var)
+                           + (i_ele - *ele)*(i_ele - *ele) / (float) ((*nobs) + 1);
+      if (variance_new < settings.th_elevation_var)
+      {
+        *ele = (*ele) + (i_ele - (*ele))/ (float)(*nobs+1);
+        *var = variance_new;
+        *nobs = (*nobs)+(uint16_t)1;
+        if (settings.use_surface_normals)
+          *normal = (*normal) + (i_normal - (*normal))/ (float)(*nobs+1);
+        if (*nobs >= settings.th_elevation_min_nobs)
+          *valid = 255;
+        if (fabsf(i_angle - 90) < fabsf(*angle - 90))
+        {
+          *angle = i_angle; *rgb = i_rgb;
+        }
+        continue;
+      }
+      if (!std::isnan(*hyp))
+      {
+        float variance_hyp = (i_ele-(*hyp))*(i_ele-(*hyp)) / 2.0f;
+        if (variance_hyp < settings.th_elevation_var || variance_hyp < variance_new)
+        {
+          float elevation = (*ele);
+          *var = variance_hyp;
+          *ele = ((*hyp) + i_ele)/2.0f;
+          *hyp = elevation;
+          *nobs = 2;
+          if (settings.use_surface_normals)
+            *normal = ((*normal) + i_normal)/2.0f;
+          if (*nobs >= settings.th_elevation_min_nobs)
+            *valid = 255;
+          *angle = i_angle; *rgb = i_rgb;
+        }
+      }
+      *hyp = i_ele;
+    }
+}
+
+bool isBitIdentical(const CvGridMap &map1, const CvGridMap &map2)
+{
+  for (const auto &layer_name : map1.getAllLayerNames())
+  {
+    const cv::Mat &data1 = map1[layer_name];
+    const cv::Mat &data2 = map2[layer_name];
+    for (int r = 0; r < data1.rows; ++r)
+      if (memcmp(data1.ptr(r), data2.ptr(r), data1.cols*data1.elemSize()) != 0)
+      {
+        std::cout << "Mismatch in layer '" << layer_name << "' at row " << r << std::endl;
+        return false;
+      }
+  }
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  int size = (argc > 1 ? atoi(argv[1]) : 2000);
+  int repetitions = (argc > 2 ? atoi(argv[2]) : 10);
+  int threads = (argc > 3 ? atoi(argv[3]) : -1);
+
+  if (threads > 0)
+    cv::setNumThreads(threads);
+
+  std::cout << "Blend benchmark: " << size << "x" << size << " grid, " << repetitions << " repetitions, "
+            << cv::getNumThreads() << " threads" << std::endl;
+
+  CvGridMap inp = benchmark::createSyntheticBlendMap(size, false, 2);
+  CvGridMap ref_template = benchmark::createSyntheticBlendMap(size, true, 1);
+
+  for (bool use_normals : {false, true})
+  {
+    blending::Settings settings{1.0f, 2, use_normals};
+
+    double time_sequential = 0.0;
+    double time_parallel = 0.0;
+    bool is_identical = true;
+
+    for (int i = 0; i < repetitions; ++i)
+    {
+      CvGridMap ref_sequential = ref_template.clone();
+      CvGridMap ref_parallel = ref_template.clone();
+
+      auto t0 = std::chrono::high_resolution_clock::now();
+      blendSequential(ref_sequential, inp, settings);
+      auto t1 = std::chrono::high_resolution_clock::now();
+      blending::blendOverlap(ref_parallel, inp, settings);
+      auto t2 = std::chrono::high_resolution_clock::now();
+
+      time_sequential += std::chrono::duration<double, std::milli>(t1 - t0).count();
+      time_parallel += std::chrono::duration<double, std::milli>(t2 - t1).count();
+      is_identical = is_identical && isBitIdentical(ref_sequential, ref_parallel);
+    }
+
+    std::cout << "- use_surface_normals: " << use_normals << std::endl;
+    std::cout << "  sequential: " << time_sequential / repetitions << " ms" << std::endl;
+    std::cout << "  parallel:   " << time_parallel / repetitions << " ms" << std::endl;
+    std::cout << "  speedup:    " << time_sequential / time_parallel << std::endl;
+    std::cout << "  identical:  " << (is_identical ? "yes" : "NO") << std::endl;
+
+    if (!is_identical)
+      return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
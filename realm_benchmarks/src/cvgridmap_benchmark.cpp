@@ -0,0 +1,79 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include <opencv2/core.hpp>
+
+#include <realm_core/cv_grid_map.h>
+
+using namespace realm;
+
+/*!
+ * @brief Microbenchmark of the per grid element layer access. Compares the string based access through
+ * atPosition3d(r, c, name) and operator[] with typed layer handles, that are resolved once before the loop.
+ */
+int main(int argc, char **argv)
+{
+  int size = (argc > 1 ? atoi(argv[1]) : 1000);
+  int repetitions = (argc > 2 ? atoi(argv[2]) : 5);
+
+  // Typical layer count of the global map in the mosaicing stage, elevation is intentionally one of the last layers
+  CvGridMap map(cv::Rect2d(0.0, 0.0, size - 1, size - 1), 1.0);
+  for (const auto &layer_name : {"color_rgb", "elevation_angle", "elevated", "num_observations", "valid",
+                                 "elevation_var", "elevation_hyp", "elevation"})
+    map.add(layer_name, cv::Mat(map.size(), CV_32F, 1.0f));
+
+  double time_position3d = 0.0;
+  double time_operator = 0.0;
+  double time_handle = 0.0;
+  double checksum = 0.0;
+
+  for (int i = 0; i < repetitions; ++i)
+  {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < size; ++r)
+      for (int c = 0; c < size; ++c)
+        checksum += map.atPosition3d(r, c, "elevation").z;
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < size; ++r)
+      for (int c = 0; c < size; ++c)
+        checksum += map["elevation"].at<float>(r, c);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    LayerHandle<float> elevation = map.getHandle<float>("elevation");
+    for (int r = 0; r < size; ++r)
+      for (int c = 0; c < size; ++c)
+        checksum += elevation(r, c);
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    time_position3d += std::chrono::duration<double, std::milli>(t1 - t0).count();
+    time_operator += std::chrono::duration<double, std::milli>(t2 - t1).count();
+    time_handle += std::chrono::duration<double, std::milli>(t3 - t2).count();
+  }
+
+  std::cout << "CvGridMap layer access benchmark: " << size << "x" << size << " grid, " << repetitions
+            << " repetitions (checksum " << checksum << ")" << std::endl;
+  std::cout << "  atPosition3d(r, c, name): " << time_position3d / repetitions << " ms" << std::endl;
+  std::cout << "  operator[](name).at(r, c): " << time_operator / repetitions << " ms" << std::endl;
+  std::cout << "  LayerHandle(r, c):         " << time_handle / repetitions << " ms" << std::endl;
+  return EXIT_SUCCESS;
+}
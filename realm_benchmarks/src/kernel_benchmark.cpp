@@ -0,0 +1,532 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <ctime>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+#include <opencv2/core.hpp>
+
+#include <realm_core/loguru.h>
+#include <realm_core/cv_grid_map.h>
+#include <realm_core/stereo.h>
+#include <realm_core/inpaint.h>
+#include <realm_ortho/rectification.h>
+#include <realm_ortho/dsm.h>
+#include <realm_ortho/delaunay_2d.h>
+#include <realm_ortho/grid_mesher.h>
+#include <realm_stages/blending.h>
+#include <realm_stages/conversions.h>
+
+#include "benchmark_helper.h"
+
+using namespace realm;
+
+/*!
+ * @brief Base of all kernel benchmarks. Input data is created once per size in setup(...) and restored before every
+ * repetition in prepare(), only run() is timed. Size is the number of grid elements or pixels per edge.
+ */
+class KernelBenchmark
+{
+  public:
+    using Ptr = std::shared_ptr<KernelBenchmark>;
+
+  public:
+    explicit KernelBenchmark(const std::string &name) : _name(name) {}
+    virtual ~KernelBenchmark() = default;
+
+    const std::string &name() const { return _name; }
+
+    virtual void setup(int size) = 0;
+    virtual void prepare() {}
+    virtual void run() = 0;
+
+  private:
+    std::string _name;
+};
+
+/*!
+ * @brief Timing statistics of one benchmark for one combination of size and thread count
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    int size;
+    int threads;
+    int repetitions;
+    double mean_ms;
+    double median_ms;
+    double min_ms;
+    double max_ms;
+    double stddev_ms;
+};
+
+class CvGridMapAddBenchmark : public KernelBenchmark
+{
+  public:
+    CvGridMapAddBenchmark() : KernelBenchmark("cvgridmap_add") {}
+    void setup(int size) override
+    {
+      // Submap overlaps a quarter of the map and extends it to the upper right, like a new frame in the mosaic
+      _ref = benchmark::createSyntheticSurface(cv::Rect2d(0.0, 0.0, size, size), 1.0, 0.1, 1);
+      _submap = benchmark::createSyntheticSurface(cv::Rect2d(size/2.0, size/2.0, size, size), 1.0, 0.1, 2);
+    }
+    void prepare() override { _map = _ref.clone(); }
+    void run() override { _map.add(_submap, REALM_OVERWRITE_ZERO, true); }
+
+  private:
+    CvGridMap _ref, _submap, _map;
+};
+
+class CvGridMapExtendBenchmark : public KernelBenchmark
+{
+  public:
+    CvGridMapExtendBenchmark() : KernelBenchmark("cvgridmap_extend_to_include") {}
+    void setup(int size) override
+    {
+      _ref = benchmark::createSyntheticSurface(cv::Rect2d(0.0, 0.0, size, size), 1.0, 0.1, 1);
+      _roi = cv::Rect2d(-size/4.0, -size/4.0, 1.5*size, 1.5*size);
+    }
+    void prepare() override { _map = _ref.clone(); }
+    void run() override { _map.extendToInclude(_roi); }
+
+  private:
+    CvGridMap _ref, _map;
+    cv::Rect2d _roi;
+};
+
+class CvGridMapOverlapBenchmark : public KernelBenchmark
+{
+  public:
+    CvGridMapOverlapBenchmark() : KernelBenchmark("cvgridmap_get_overlap") {}
+    void setup(int size) override
+    {
+      _map1 = benchmark::createSyntheticSurface(cv::Rect2d(0.0, 0.0, size, size), 1.0, 0.1, 1);
+      _map2 = benchmark::createSyntheticSurface(cv::Rect2d(size/2.0, size/2.0, size, size), 1.0, 0.1, 2);
+    }
+    void run() override { _overlap = _map1.getOverlap(_map2); }
+
+  private:
+    CvGridMap _map1, _map2;
+    CvGridMap::Overlap _overlap;
+};
+
+class CvGridMapChangeResolutionBenchmark : public KernelBenchmark
+{
+  public:
+    CvGridMapChangeResolutionBenchmark() : KernelBenchmark("cvgridmap_change_resolution") {}
+    void setup(int size) override
+    {
+      _ref = benchmark::createSyntheticSurface(cv::Rect2d(0.0, 0.0, size, size), 1.0, 0.1, 1);
+    }
+    void prepare() override { _map = _ref.clone(); }
+    void run() override { _map.changeResolution(2.0); }
+
+  private:
+    CvGridMap _ref, _map;
+};
+
+class BackprojectFromGridBenchmark : public KernelBenchmark
+{
+  public:
+    BackprojectFromGridBenchmark() : KernelBenchmark("ortho_backproject_from_grid") {}
+    void setup(int size) override
+    {
+      // Observed surface covers most of the footprint of the dummy frame, size defines the grid resolution
+      _frame = benchmark::createDummyFrame(1);
+      CvGridMap surface = benchmark::createSyntheticSurface(cv::Rect2d(0.0, 0.0, 1000.0, 1000.0), 1000.0/size, 0.0, 1);
+      _frame->setObservedMap(std::make_shared<CvGridMap>(surface));
+      _frame->setSurfaceAssumption(SurfaceAssumption::ELEVATION);
+    }
+    void prepare() override { _map = CvGridMap(); }
+    void run() override { ortho::backprojectFromGrid(_frame, _map, cv::INTER_LINEAR); }
+
+  private:
+    Frame::Ptr _frame;
+    CvGridMap _map;
+};
+
+class MosaicingBlendBenchmark : public KernelBenchmark
+{
+  public:
+    MosaicingBlendBenchmark() : KernelBenchmark("mosaicing_blend") {}
+    void setup(int size) override
+    {
+      _ref = benchmark::createSyntheticBlendMap(size, true, 1);
+      _inp = benchmark::createSyntheticBlendMap(size, false, 2);
+    }
+    void prepare() override { _map = _ref.clone(); }
+    void run() override { blending::blendOverlap(_map, _inp, blending::Settings{1.0f, 2, true}); }
+
+  private:
+    CvGridMap _ref, _inp, _map;
+};
+
+class DsmBenchmark : public KernelBenchmark
+{
+  public:
+    DsmBenchmark() : KernelBenchmark("dsm_construction") {}
+    void setup(int size) override
+    {
+      // Sparse cloud with a quarter of the points of the final grid, as it is the case for keyframe based clouds
+      _roi = cv::Rect2d(0.0, 0.0, size, size);
+      CvGridMap surface = benchmark::createSyntheticSurface(_roi, 2.0, 0.0, 1);
+      _points = cvtToPointCloud(surface, "elevation", "", "", "valid").colRange(0, 3).clone();
+    }
+    void run() override
+    {
+      _dsm = std::make_shared<DigitalSurfaceModel>(_roi, _points, DigitalSurfaceModel::SurfaceNormalMode::NONE, 1.0, 1.0);
+    }
+
+  private:
+    cv::Rect2d _roi;
+    cv::Mat _points;
+    DigitalSurfaceModel::Ptr _dsm;
+};
+
+class ReprojectDepthMapBenchmark : public KernelBenchmark
+{
+  public:
+    ReprojectDepthMapBenchmark() : KernelBenchmark("stereo_reproject_depth_map") {}
+    void setup(int size) override
+    {
+      _cam = benchmark::createNadirCamera(size, size);
+      _depth_map = benchmark::createSyntheticDepthMap(_cam, 1);
+    }
+    void run() override { stereo::reprojectDepthMap(_cam, _depth_map, _img3d, _normals, true); }
+
+  private:
+    camera::Pinhole::Ptr _cam;
+    cv::Mat _depth_map, _img3d, _normals;
+};
+
+class DepthMapFromPointCloudBenchmark : public KernelBenchmark
+{
+  public:
+    DepthMapFromPointCloudBenchmark() : KernelBenchmark("stereo_depth_map_from_point_cloud") {}
+    void setup(int size) override
+    {
+      _cam = benchmark::createNadirCamera(size, size);
+      _points = benchmark::createSyntheticCloud(size*size/4, 1);
+    }
+    void run() override { _depth_map = stereo::computeDepthMapFromPointCloud(_cam, _points); }
+
+  private:
+    camera::Pinhole::Ptr _cam;
+    cv::Mat _points, _depth_map;
+};
+
+class CvtToPointCloudBenchmark : public KernelBenchmark
+{
+  public:
+    CvtToPointCloudBenchmark() : KernelBenchmark("cvt_to_point_cloud") {}
+    void setup(int size) override
+    {
+      camera::Pinhole::Ptr cam = benchmark::createNadirCamera(size, size);
+      stereo::reprojectDepthMap(cam, benchmark::createSyntheticDepthMap(cam, 1), _img3d, _normals, true);
+
+      cv::RNG rng(1);
+      _color = cv::Mat(size, size, CV_8UC4);
+      rng.fill(_color, cv::RNG::UNIFORM, 0, 256);
+      cv::Mat random(size, size, CV_32F);
+      rng.fill(random, cv::RNG::UNIFORM, 0.0, 1.0);
+      _mask = (random >= 0.1);
+    }
+    void run() override { _points = cvtToPointCloud(_img3d, _color, _normals, _mask); }
+
+  private:
+    cv::Mat _img3d, _color, _normals, _mask, _points;
+};
+
+class DelaunayBenchmark : public KernelBenchmark
+{
+  public:
+    DelaunayBenchmark() : KernelBenchmark("delaunay_build_mesh") {}
+    void setup(int size) override
+    {
+      // Only a quarter of the grid elements is valid, triangulation of the full grid is rarely needed
+      _surface = benchmark::createSyntheticSurface(cv::Rect2d(0.0, 0.0, size, size), 1.0, 0.75, 1);
+    }
+    void run() override { _vertex_ids = _delaunay.buildMesh(_surface, "valid"); }
+
+  private:
+    CvGridMap _surface;
+    Delaunay2D _delaunay;
+    std::vector<cv::Point2i> _vertex_ids;
+};
+
+class GridMesherBenchmark : public KernelBenchmark
+{
+  public:
+    GridMesherBenchmark(const std::string &name, double th_planarity)
+    : KernelBenchmark(name),
+      _mesher(GridMesher::Settings{true, 3.0, th_planarity, 32})
+    {
+    }
+    void setup(int size) override
+    {
+      // Mostly valid global map with some holes, as it is meshed by the mosaicing stage
+      _surface = benchmark::createSyntheticSurface(cv::Rect2d(0.0, 0.0, size, size), 1.0, 0.01, 1);
+    }
+    void run() override { _vertex_ids = _mesher.buildMesh(_surface, "valid", "elevation"); }
+
+  private:
+    CvGridMap _surface;
+    GridMesher _mesher;
+    std::vector<cv::Point2i> _vertex_ids;
+};
+
+class InpaintBenchmark : public KernelBenchmark
+{
+  public:
+    InpaintBenchmark() : KernelBenchmark("inpaint") {}
+    void setup(int size) override
+    {
+      // Half of the elements are holes, radius is chosen like for the sparse depth interpolation
+      CvGridMap surface = benchmark::createSyntheticSurface(cv::Rect2d(0.0, 0.0, size, size), 1.0, 0.5, 1);
+      _elevation = surface["elevation"];
+      _mask = (surface["valid"] == 0);
+      _radius = std::max(0.01*size, 3.0);
+    }
+    void run() override { realm::inpaint(_elevation, _mask, _result, _radius, INPAINT_NS); }
+
+  private:
+    cv::Mat _elevation, _mask, _result;
+    double _radius;
+};
+
+std::vector<int> parseList(const std::string &text)
+{
+  std::vector<int> values;
+  std::stringstream ss(text);
+  std::string item;
+  while (std::getline(ss, item, ','))
+    values.push_back(std::stoi(item));
+  if (values.empty())
+    throw(std::invalid_argument("Error: Empty list '" + text + "'."));
+  return values;
+}
+
+BenchmarkResult evaluate(const std::string &name, int size, int threads, std::vector<double> times)
+{
+  std::sort(times.begin(), times.end());
+
+  double sum = 0.0;
+  for (double t : times)
+    sum += t;
+  double mean = sum / times.size();
+
+  double sum_sq = 0.0;
+  for (double t : times)
+    sum_sq += (t - mean)*(t - mean);
+
+  size_t n = times.size();
+  double median = (n % 2 == 1 ? times[n/2] : (times[n/2 - 1] + times[n/2]) / 2.0);
+  return BenchmarkResult{name, size, threads, static_cast<int>(n), mean, median, times.front(), times.back(),
+                         std::sqrt(sum_sq / n)};
+}
+
+bool writeJson(const std::string &filename, const std::vector<BenchmarkResult> &results)
+{
+  std::ofstream file(filename, std::ios::out | std::ios::trunc);
+  if (!file.is_open())
+    return false;
+
+  char timestamp[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  file << "{\n";
+  file << "  \"benchmark\": \"realm_kernel_benchmark\",\n";
+  file << "  \"timestamp\": \"" << timestamp << "\",\n";
+  file << "  \"opencv_version\": \"" << CV_VERSION << "\",\n";
+  file << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+  file << "  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult &r = results[i];
+    file << (i == 0 ? "\n" : ",\n");
+    file << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"threads\": " << r.threads
+         << ", \"repetitions\": " << r.repetitions << ", \"mean_ms\": " << r.mean_ms
+         << ", \"median_ms\": " << r.median_ms << ", \"min_ms\": " << r.min_ms << ", \"max_ms\": " << r.max_ms
+         << ", \"stddev_ms\": " << r.stddev_ms << "}";
+  }
+  file << "\n  ]\n}\n";
+  return file.good();
+}
+
+void printUsage()
+{
+  std::cout << "Usage: realm_kernel_benchmark [options]\n"
+            << "  --sizes <n,...>        Grid/image edge lengths (default: 500,1000,2000)\n"
+            << "  --threads <n,...>      OpenCV thread counts, 0 is the OpenCV default (default: 1,0)\n"
+            << "  --repetitions <n>      Timed repetitions per case (default: 5)\n"
+            << "  --filter <text>        Only run benchmarks whose name contains text\n"
+            << "  --output <file.json>   Write results as JSON\n"
+            << "  --list                 List all benchmarks and exit" << std::endl;
+}
+
+/*!
+ * @brief Benchmark suite of the hot kernels of realm_core, realm_ortho and realm_stages. All inputs are synthetic and
+ * seeded, so results of different releases are comparable. Every benchmark is run for all combinations of size and
+ * thread count, one untimed warm up run precedes the timed repetitions.
+ */
+int main(int argc, char **argv)
+{
+  std::vector<int> sizes{500, 1000, 2000};
+  std::vector<int> thread_counts{1, 0};
+  int repetitions = 5;
+  std::string filter;
+  std::string filename_output;
+  bool do_list = false;
+
+  try
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+      bool has_value = (i + 1 < argc);
+      if (arg == "--sizes" && has_value)
+        sizes = parseList(argv[++i]);
+      else if (arg == "--threads" && has_value)
+        thread_counts = parseList(argv[++i]);
+      else if (arg == "--repetitions" && has_value)
+        repetitions = std::max(std::stoi(argv[++i]), 1);
+      else if (arg == "--filter" && has_value)
+        filter = argv[++i];
+      else if (arg == "--output" && has_value)
+        filename_output = argv[++i];
+      else if (arg == "--list")
+        do_list = true;
+      else
+      {
+        printUsage();
+        return (arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE);
+      }
+    }
+  }
+  catch (std::exception &e)
+  {
+    std::cout << "Error parsing arguments: " << e.what() << std::endl;
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  // Kernels log every call, which would distort the timing
+  loguru::g_stderr_verbosity = loguru::Verbosity_WARNING;
+
+  std::vector<KernelBenchmark::Ptr> benchmarks{
+      std::make_shared<CvGridMapAddBenchmark>(),
+      std::make_shared<CvGridMapExtendBenchmark>(),
+      std::make_shared<CvGridMapOverlapBenchmark>(),
+      std::make_shared<CvGridMapChangeResolutionBenchmark>(),
+      std::make_shared<BackprojectFromGridBenchmark>(),
+      std::make_shared<MosaicingBlendBenchmark>(),
+      std::make_shared<DsmBenchmark>(),
+      std::make_shared<ReprojectDepthMapBenchmark>(),
+      std::make_shared<DepthMapFromPointCloudBenchmark>(),
+      std::make_shared<CvtToPointCloudBenchmark>(),
+      std::make_shared<DelaunayBenchmark>(),
+      std::make_shared<GridMesherBenchmark>("grid_mesher_build_mesh", 0.0),
+      std::make_shared<GridMesherBenchmark>("grid_mesher_build_mesh_decimated", 0.5),
+      std::make_shared<InpaintBenchmark>()
+  };
+
+  if (do_list)
+  {
+    for (const auto &kernel : benchmarks)
+      std::cout << kernel->name() << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  const int threads_default = cv::getNumThreads();
+  std::vector<BenchmarkResult> results;
+  bool has_failed = false;
+
+  std::cout << "Kernel benchmark: " << repetitions << " repetitions, " << threads_default << " default threads"
+            << std::endl;
+
+  for (const auto &kernel : benchmarks)
+  {
+    if (!filter.empty() && kernel->name().find(filter) == std::string::npos)
+      continue;
+
+    for (int size : sizes)
+    {
+      try
+      {
+        cv::setNumThreads(threads_default);
+        kernel->setup(size);
+
+        for (int threads : thread_counts)
+        {
+          cv::setNumThreads(threads > 0 ? threads : threads_default);
+
+          kernel->prepare();
+          kernel->run();
+
+          std::vector<double> times;
+          for (int i = 0; i < repetitions; ++i)
+          {
+            kernel->prepare();
+            auto t0 = std::chrono::high_resolution_clock::now();
+            kernel->run();
+            auto t1 = std::chrono::high_resolution_clock::now();
+            times.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+          }
+
+          BenchmarkResult result = evaluate(kernel->name(), size, cv::getNumThreads(), times);
+          results.push_back(result);
+
+          std::cout << "- " << result.name << " [size " << size << ", threads " << result.threads << "]: "
+                    << result.median_ms << " ms (mean " << result.mean_ms << ", min " << result.min_ms
+                    << ", max " << result.max_ms << ")" << std::endl;
+        }
+      }
+      catch (std::exception &e)
+      {
+        std::cout << "- " << kernel->name() << " [size " << size << "]: FAILED (" << e.what() << ")" << std::endl;
+        has_failed = true;
+      }
+    }
+  }
+  cv::setNumThreads(threads_default);
+
+  if (!filename_output.empty())
+  {
+    if (!writeJson(filename_output, results))
+    {
+      std::cout << "Error: Writing results to '" << filename_output << "' failed." << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::cout << "Results written to '" << filename_output << "'." << std::endl;
+  }
+  return (has_failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
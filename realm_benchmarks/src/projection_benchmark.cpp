@@ -0,0 +1,126 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+
+#include <opencv2/core.hpp>
+
+#include <realm_core/camera.h>
+#include <realm_core/stereo.h>
+
+#include "benchmark_helper.h"
+
+using namespace realm;
+
+/*!
+ * @brief Per point projection as it was implemented in stereo::computeDepthMapFromPointCloud before. Every point is
+ * copied into a temporary matrix and the last point written into a pixel wins. Used as baseline for timing and as
+ * reference for the comparison.
+ */
+cv::Mat projectSequential(const camera::Pinhole::Ptr &cam, const cv::Mat &points)
+{
+  uint32_t width = cam->width();
+  uint32_t height = cam->height();
+  cv::Mat depth_map = cv::Mat(height, width, CV_32F, -1.0);
+
+  cv::Mat T_w2c = cam->Tw2c();
+  cv::Mat Rwc2 = T_w2c.row(2).colRange(0, 3).t();
+  double zwc = T_w2c.at<double>(2, 3);
+
+  cv::Mat P_cv = cam->P();
+  double P[3][4]{P_cv.at<double>(0, 0), P_cv.at<double>(0, 1), P_cv.at<double>(0, 2), P_cv.at<double>(0, 3),
+                 P_cv.at<double>(1, 0), P_cv.at<double>(1, 1), P_cv.at<double>(1, 2), P_cv.at<double>(1, 3),
+                 P_cv.at<double>(2, 0), P_cv.at<double>(2, 1), P_cv.at<double>(2, 2), P_cv.at<double>(2, 3)};
+
+  for (int i = 0; i < points.rows; ++i)
+  {
+    cv::Mat pt = points.row(i).t();
+    double depth = Rwc2.dot(pt) + zwc;
+    double w = P[2][0]*pt.at<double>(0) + P[2][1]*pt.at<double>(1) + P[2][2]*pt.at<double>(2) + P[2][3]*1.0;
+    auto u = (int)((P[0][0]*pt.at<double>(0) + P[0][1]*pt.at<double>(1) + P[0][2]*pt.at<double>(2) + P[0][3]*1.0)/w);
+    auto v = (int)((P[1][0]*pt.at<double>(0) + P[1][1]*pt.at<double>(1) + P[1][2]*pt.at<double>(2) + P[1][3]*1.0)/w);
+
+    if (u >= 0 && u < width && v >= 0 && v < height)
+      if (depth > 0)
+        depth_map.at<float>(v, u) = static_cast<float>(depth);
+      else
+        depth_map.at<float>(v, u) = -1.0f;
+  }
+  return depth_map;
+}
+
+int main(int argc, char **argv)
+{
+  int n = (argc > 1 ? atoi(argv[1]) : 200000);
+  int repetitions = (argc > 2 ? atoi(argv[2]) : 10);
+  int threads = (argc > 3 ? atoi(argv[3]) : -1);
+
+  if (threads > 0)
+    cv::setNumThreads(threads);
+
+  camera::Pinhole::Ptr cam = benchmark::createNadirCamera(1200, 1000);
+  cv::Mat points = benchmark::createSyntheticCloud(n, 1);
+
+  std::cout << "Projection benchmark: " << n << " points, " << cam->width() << "x" << cam->height() << " image, "
+            << repetitions << " repetitions, " << cv::getNumThreads() << " threads" << std::endl;
+
+  double time_sequential = 0.0;
+  double time_parallel = 0.0;
+  bool is_consistent = true;
+
+  for (int i = 0; i < repetitions; ++i)
+  {
+    cv::Mat depth_parallel, indices;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    cv::Mat depth_sequential = projectSequential(cam, points);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    stereo::projectPointCloud(cam, points, depth_parallel, indices);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    time_sequential += std::chrono::duration<double, std::milli>(t1 - t0).count();
+    time_parallel += std::chrono::duration<double, std::milli>(t2 - t1).count();
+
+    // All points are in front of the camera, so the same pixels must be covered. Depth of the z-buffer is never
+    // larger than the one of the last written point.
+    for (int r = 0; r < depth_sequential.rows && is_consistent; ++r)
+      for (int c = 0; c < depth_sequential.cols; ++c)
+      {
+        const float d_seq = depth_sequential.at<float>(r, c);
+        const float d_par = depth_parallel.at<float>(r, c);
+        if ((d_seq > 0.0f) != (d_par > 0.0f) || d_par > d_seq)
+        {
+          std::cout << "Mismatch at pixel (" << r << ", " << c << ")" << std::endl;
+          is_consistent = false;
+          break;
+        }
+      }
+  }
+
+  std::cout << "  sequential: " << time_sequential / repetitions << " ms" << std::endl;
+  std::cout << "  parallel:   " << time_parallel / repetitions << " ms" << std::endl;
+  std::cout << "  speedup:    " << time_sequential / time_parallel << std::endl;
+  std::cout << "  consistent: " << (is_consistent ? "yes" : "NO") << std::endl;
+
+  return (is_consistent ? EXIT_SUCCESS : EXIT_FAILURE);
+}
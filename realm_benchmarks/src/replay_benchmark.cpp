@@ -0,0 +1,368 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iterator>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <unordered_map>
+
+#include <sys/resource.h>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <realm_core/loguru.h>
+#include <realm_core/metrics.h>
+#include <realm_io/exif_import.h>
+#include <realm_io/realm_import.h>
+#include <realm_io/utilities.h>
+#include <realm_stages/pipeline.h>
+
+using namespace realm;
+
+/*!
+ * @brief Throughput and latency of one stage, read from the metrics registry after the replay
+ */
+struct StageReport
+{
+    std::string name;
+    uint64_t frames_in;
+    uint64_t frames_out;
+    uint64_t frames_dropped;
+    double throughput;
+    metrics::Histogram::Snapshot latency;
+    metrics::Histogram::Snapshot queue_wait;
+};
+
+/*!
+ * @brief Checksum of a final result of the mosaicing stage
+ * @var source "pixels" if the raster was decoded, "file" if only the file content could be hashed, "missing" if the
+ *      result was not written, e.g. because saving is disabled in the profile
+ */
+struct ChecksumReport
+{
+    std::string name;
+    std::string source;
+    std::string checksum;
+};
+
+/*!
+ * @brief 64 bit FNV-1a hash, continued from a previous hash value
+ */
+uint64_t hashBytes(const unsigned char* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/*!
+ * @brief Computes the checksum of a result file. Raster data is decoded first, so metadata written by the GIS library
+ * does not influence the checksum. If OpenCV can not decode the file, its content is hashed instead.
+ */
+ChecksumReport computeChecksum(const std::string &name, const std::string &filepath)
+{
+  if (!io::fileExists(filepath))
+    return ChecksumReport{name, "missing", ""};
+
+  uint64_t hash;
+  std::string source;
+
+  cv::Mat img = cv::imread(filepath, cv::IMREAD_UNCHANGED);
+  if (!img.empty())
+  {
+    int header[3]{img.rows, img.cols, img.type()};
+    hash = hashBytes(reinterpret_cast<const unsigned char*>(header), sizeof(header));
+    for (int r = 0; r < img.rows; ++r)
+      hash = hashBytes(img.ptr(r), img.cols*img.elemSize(), hash);
+    source = "pixels";
+  }
+  else
+  {
+    std::ifstream file(filepath, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    hash = hashBytes(reinterpret_cast<const unsigned char*>(content.data()), content.size());
+    source = "file";
+  }
+
+  std::stringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return ChecksumReport{name, source, ss.str()};
+}
+
+/*!
+ * @brief Peak resident set size of the process
+ * @return peak RSS in [MB]
+ */
+double getPeakRss()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0.0;
+  // Linux reports kilobytes
+  return usage.ru_maxrss / 1024.0;
+}
+
+std::string toJson(const metrics::Histogram::Snapshot &snapshot)
+{
+  std::stringstream ss;
+  ss << "{\"count\": " << snapshot.count << ", \"p50\": " << snapshot.p50_ms << ", \"p95\": " << snapshot.p95_ms
+     << ", \"p99\": " << snapshot.p99_ms << ", \"max\": " << snapshot.max_ms << "}";
+  return ss.str();
+}
+
+std::string escapeJson(const std::string &text)
+{
+  std::string result;
+  for (char c : text)
+  {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result;
+}
+
+void printUsage()
+{
+  std::cout << "Usage: realm_replay_benchmark <profile_dir> <image_dir> <output_dir> <vslam_method> <densifier_method> [options]\n"
+            << "  --fps <hz|max>         Simulated camera frame rate, 'max' feeds as fast as the first stage accepts\n"
+            << "                         frames (default: fps of the camera profile)\n"
+            << "  --poses <file>         Trajectory in TUM format, poses are set as visual pose of the frames\n"
+            << "  --camera_id <id>       Camera id of the frames (default: realm)\n"
+            << "  --max_frames <n>       Only replay the first n images\n"
+            << "  --report <file.json>   Write the report as JSON\n"
+            << "Example: realm_replay_benchmark .../profiles/alexa_noreco .../images .../output orb_slam2 dummy --fps max"
+            << std::endl;
+}
+
+/*!
+ * @brief Headless replay of an image folder through the complete stage chain. Reports throughput, frame drops and
+ * latencies of every stage, the end-to-end latency from frame acquisition until the mosaicing stage, the peak memory
+ * and checksums of the final ortho photo and elevation map. Runs without ROS, with the dummy densifier also without GPU.
+ */
+int main(int argc, char **argv)
+{
+  if (argc < 6)
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  std::string path_profile = argv[1];
+  std::string path_images = argv[2];
+  std::string path_output = argv[3];
+  std::string method_vslam = argv[4];
+  std::string method_densifier = argv[5];
+
+  std::string fps_arg;
+  std::string filepath_poses;
+  std::string filename_report;
+  std::string camera_id = "realm";
+  size_t max_frames = 0;
+
+  for (int i = 6; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if (arg == "--fps" && has_value)
+      fps_arg = argv[++i];
+    else if (arg == "--poses" && has_value)
+      filepath_poses = argv[++i];
+    else if (arg == "--camera_id" && has_value)
+      camera_id = argv[++i];
+    else if (arg == "--max_frames" && has_value)
+      max_frames = static_cast<size_t>(std::max(atoi(argv[++i]), 0));
+    else if (arg == "--report" && has_value)
+      filename_report = argv[++i];
+    else
+    {
+      printUsage();
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!io::dirExists(path_images))
+    throw(std::invalid_argument("Error: Image folder '" + path_images + "' does not exist!"));
+
+  io::Exiv2FrameReader reader(io::Exiv2FrameReader::FrameTags::loadFromFile(path_profile + "/config/exif.yaml"));
+  auto cam = std::make_shared<camera::Pinhole>(io::loadCameraFromYaml(path_profile + "/camera/calib.yaml"));
+
+  std::unordered_map<uint64_t, cv::Mat> poses;
+  if (!filepath_poses.empty())
+  {
+    poses = io::loadTrajectoryFromTxtTUM(filepath_poses);
+    LOG_F(INFO, "Loaded %lu external poses.", poses.size());
+  }
+
+  // Stages in pipeline order, see stages::Pipeline
+  const std::vector<std::string> stage_names{"pose_estimation", "densification", "surface_generation",
+                                             "ortho_rectification", "mosaicing"};
+
+  stages::Pipeline pipeline(path_profile, path_output, method_vslam, method_densifier);
+
+  bool is_max_rate = (fps_arg == "max");
+  double fps = (fps_arg.empty() || is_max_rate ? pipeline.getFps() : atof(fps_arg.c_str()));
+  if (!is_max_rate && fps <= 0.0)
+    throw(std::invalid_argument("Error: Frame rate must be positive or 'max'!"));
+  auto t_frame = std::chrono::microseconds(static_cast<int64_t>(1/fps*1000000.0));
+
+  std::vector<std::string> file_list = io::getFileList(path_images);
+  if (max_frames > 0 && max_frames < file_list.size())
+    file_list.resize(max_frames);
+
+  pipeline.start();
+
+  auto t_start = std::chrono::steady_clock::now();
+  auto t_next = t_start;
+  for (size_t i = 0; i < file_list.size(); ++i)
+  {
+    LOG_F(INFO, "Image #%lu / %lu, image path: %s", i + 1, file_list.size(), file_list[i].c_str());
+
+    // Every frame needs its own camera model, because the frame sets its pose while it is processed by the stages
+    auto cam_frame = std::make_shared<camera::Pinhole>(*cam);
+    Frame::Ptr frame = reader.loadFrameFromExiv2(camera_id, cam_frame, file_list[i]);
+
+    if (!poses.empty())
+    {
+      auto it = poses.find(frame->getTimestamp());
+      if (it == poses.end() || it->second.empty())
+        throw(std::runtime_error("Error adding external pose informations: No pose was found. Maybe images or provided pose file do not match?"));
+      frame->setVisualPose(it->second);
+    }
+
+    // Image is decoded while the previous frame is still processed, then either the simulated camera clock or the
+    // first stage determines when the frame is fed
+    if (is_max_rate)
+    {
+      while (!pipeline.isInputIdle())
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+    }
+    else
+    {
+      std::this_thread::sleep_until(t_next);
+      t_next += t_frame;
+    }
+    pipeline.addFrame(frame);
+  }
+
+  // Settle time is waited after the last activity of the stages and is not part of the processing time
+  const int64_t t_settle = 1000;
+  pipeline.finish(t_settle);
+  double t_total = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count() - t_settle/1000.0;
+
+  // Collect the report from the metrics of all stages
+  metrics::Registry &registry = metrics::Registry::instance();
+  std::vector<StageReport> stage_reports;
+  uint64_t frames_dropped = 0;
+  for (const auto &stage_name : stage_names)
+  {
+    std::string prefix = "realm_" + metrics::toMetricName("Stage [" + stage_name + "]") + "_";
+    StageReport report;
+    report.name = stage_name;
+    report.frames_in = registry.counter(prefix + "frames_in")->value();
+    report.frames_out = registry.counter(prefix + "frames_out")->value();
+    report.frames_dropped = registry.counter(prefix + "frames_dropped")->value();
+    report.throughput = (t_total > 0.0 ? report.frames_out / t_total : 0.0);
+    report.latency = registry.histogram(prefix + "latency_ms")->snapshot();
+    report.queue_wait = registry.histogram(prefix + "queue_wait_ms")->snapshot();
+    stage_reports.push_back(report);
+    frames_dropped += report.frames_dropped;
+  }
+
+  std::string prefix_last = "realm_" + metrics::toMetricName("Stage [" + stage_names.back() + "]") + "_";
+  metrics::Histogram::Snapshot latency_e2e = registry.histogram(prefix_last + "frame_age_ms")->snapshot();
+  double peak_rss = getPeakRss();
+
+  std::string path_mosaicing = pipeline.getOutputPath() + "/mosaicing";
+  std::vector<ChecksumReport> checksums{computeChecksum("ortho", path_mosaicing + "/ortho/ortho.tif"),
+                                        computeChecksum("elevation", path_mosaicing + "/elevation/gtiff/elevation.tif")};
+
+  std::cout << "Replay benchmark: " << file_list.size() << " frames, " << (is_max_rate ? std::string("max") : std::to_string(fps))
+            << " fps, " << t_total << " s" << std::endl;
+  for (const auto &report : stage_reports)
+    std::cout << "- " << report.name << ": in " << report.frames_in << ", out " << report.frames_out
+              << ", dropped " << report.frames_dropped << ", " << report.throughput << " fps, latency p50/p95/p99 "
+              << report.latency.p50_ms << "/" << report.latency.p95_ms << "/" << report.latency.p99_ms << " ms"
+              << std::endl;
+  std::cout << "- end-to-end latency p50/p95/p99/max: " << latency_e2e.p50_ms << "/" << latency_e2e.p95_ms << "/"
+            << latency_e2e.p99_ms << "/" << latency_e2e.max_ms << " ms (" << latency_e2e.count << " frames)" << std::endl;
+  std::cout << "- frames dropped: " << frames_dropped << std::endl;
+  std::cout << "- peak RSS: " << peak_rss << " MB" << std::endl;
+  for (const auto &checksum : checksums)
+    std::cout << "- checksum " << checksum.name << ": " << (checksum.checksum.empty() ? "-" : checksum.checksum)
+              << " (" << checksum.source << ")" << std::endl;
+
+  if (filename_report.empty())
+    return EXIT_SUCCESS;
+
+  char timestamp[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  std::ofstream file(filename_report, std::ios::out | std::ios::trunc);
+  file << "{\n";
+  file << "  \"benchmark\": \"realm_replay_benchmark\",\n";
+  file << "  \"timestamp\": \"" << timestamp << "\",\n";
+  file << "  \"profile\": \"" << escapeJson(path_profile) << "\",\n";
+  file << "  \"vslam\": \"" << escapeJson(method_vslam) << "\",\n";
+  file << "  \"densifier\": \"" << escapeJson(method_densifier) << "\",\n";
+  file << "  \"fps\": " << (is_max_rate ? std::string("\"max\"") : std::to_string(fps)) << ",\n";
+  file << "  \"frames\": " << file_list.size() << ",\n";
+  file << "  \"frames_dropped\": " << frames_dropped << ",\n";
+  file << "  \"time_s\": " << t_total << ",\n";
+  file << "  \"peak_rss_mb\": " << peak_rss << ",\n";
+  file << "  \"end_to_end_latency_ms\": " << toJson(latency_e2e) << ",\n";
+  file << "  \"stages\": [";
+  for (size_t i = 0; i < stage_reports.size(); ++i)
+  {
+    const StageReport &r = stage_reports[i];
+    file << (i == 0 ? "\n" : ",\n");
+    file << "    {\"name\": \"" << r.name << "\", \"frames_in\": " << r.frames_in << ", \"frames_out\": " << r.frames_out
+         << ", \"frames_dropped\": " << r.frames_dropped << ", \"throughput_fps\": " << r.throughput
+         << ", \"latency_ms\": " << toJson(r.latency) << ", \"queue_wait_ms\": " << toJson(r.queue_wait) << "}";
+  }
+  file << "\n  ],\n";
+  file << "  \"checksums\": {";
+  for (size_t i = 0; i < checksums.size(); ++i)
+    file << (i == 0 ? "" : ", ") << "\"" << checksums[i].name << "\": {\"source\": \"" << checksums[i].source
+         << "\", \"value\": \"" << checksums[i].checksum << "\"}";
+  file << "}\n}\n";
+
+  if (!file.good())
+  {
+    std::cout << "Error: Writing report to '" << filename_report << "' failed." << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Report written to '" << filename_report << "'." << std::endl;
+  return EXIT_SUCCESS;
+}
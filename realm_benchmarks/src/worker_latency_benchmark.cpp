@@ -0,0 +1,184 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdlib>
+
+#include <realm_core/worker_thread_base.h>
+
+using namespace realm;
+
+using Clock = std::chrono::steady_clock;
+
+/*!
+ * @brief Minimal stage of a synthetic pipeline. Receives timestamps, simulates a fixed processing time and forwards
+ * them to the next stage. The last stage of the pipeline records the end to end latency.
+ */
+class BenchmarkStage : public WorkerThreadBase
+{
+  public:
+    BenchmarkStage(const std::string &name, int64_t sleep_time, int64_t work_time, bool is_event_driven)
+    : WorkerThreadBase(name, sleep_time, false),
+      _work_time(work_time),
+      _next(nullptr)
+    {
+      setEventDriven(is_event_driven);
+    }
+
+    void setNext(BenchmarkStage* next)
+    {
+      _next = next;
+    }
+
+    void addFrame(const Clock::time_point &t_created)
+    {
+      {
+        std::unique_lock<std::mutex> lock(_mutex_buffer);
+        _buffer.push_back(t_created);
+      }
+      notifyWorkAvailable();
+    }
+
+    std::vector<double> getLatencies()
+    {
+      std::unique_lock<std::mutex> lock(_mutex_buffer);
+      return _latencies;
+    }
+
+  protected:
+    bool process() override
+    {
+      Clock::time_point t_created;
+      {
+        std::unique_lock<std::mutex> lock(_mutex_buffer);
+        if (_buffer.empty())
+          return false;
+        t_created = _buffer.front();
+        _buffer.pop_front();
+      }
+
+      // Busy waiting, so the simulated processing time is not affected by the scheduler
+      Clock::time_point t_end = Clock::now() + std::chrono::milliseconds(_work_time);
+      while (Clock::now() < t_end);
+
+      if (_next)
+        _next->addFrame(t_created);
+      else
+      {
+        std::unique_lock<std::mutex> lock(_mutex_buffer);
+        _latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t_created).count());
+      }
+      return true;
+    }
+
+    void reset() override
+    {
+      std::unique_lock<std::mutex> lock(_mutex_reset_requested);
+      _reset_requested = false;
+    }
+
+  private:
+    int64_t _work_time;
+    BenchmarkStage* _next;
+    std::mutex _mutex_buffer;
+    std::deque<Clock::time_point> _buffer;
+    std::vector<double> _latencies;
+};
+
+/*!
+ * @brief Runs a pipeline of chained stages and feeds it with the given frame rate
+ * @return Latencies of all frames that passed the pipeline in [ms]
+ */
+std::vector<double> runPipeline(int num_stages, double fps, int num_frames, int64_t work_time, bool is_event_driven)
+{
+  // Sleep time is derived from the frame rate the same way the stages do
+  auto sleep_time = static_cast<int64_t>(1/fps*1000.0);
+
+  std::vector<std::unique_ptr<BenchmarkStage>> stages;
+  for (int i = 0; i < num_stages; ++i)
+    stages.emplace_back(new BenchmarkStage("stage_" + std::to_string(i), sleep_time, work_time, is_event_driven));
+  for (int i = 0; i < num_stages - 1; ++i)
+    stages[i]->setNext(stages[i+1].get());
+  for (auto &stage : stages)
+    stage->start();
+
+  for (int i = 0; i < num_frames; ++i)
+  {
+    stages.front()->addFrame(Clock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
+  }
+
+  // Give the last frames time to pass through the pipeline
+  std::this_thread::sleep_for(std::chrono::milliseconds(2*num_stages*(sleep_time + work_time)));
+
+  std::vector<double> latencies = stages.back()->getLatencies();
+  for (auto &stage : stages)
+  {
+    stage->requestFinish();
+    stage->join();
+  }
+  return latencies;
+}
+
+void printLatencies(const std::string &name, std::vector<double> latencies, int num_frames)
+{
+  if (latencies.empty())
+  {
+    std::cout << "- " << name << ": no frame passed the pipeline" << std::endl;
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  double sum = 0.0;
+  for (double l : latencies)
+    sum += l;
+
+  std::cout << "- " << name << ":" << std::endl;
+  std::cout << "  frames:  " << latencies.size() << "/" << num_frames << std::endl;
+  std::cout << "  avg:     " << sum / latencies.size() << " ms" << std::endl;
+  std::cout << "  median:  " << latencies[latencies.size()/2] << " ms" << std::endl;
+  std::cout << "  max:     " << latencies.back() << " ms" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+  int num_stages = (argc > 1 ? atoi(argv[1]) : 5);
+  double fps = (argc > 2 ? atof(argv[2]) : 10.0);
+  int num_frames = (argc > 3 ? atoi(argv[3]) : 50);
+  int64_t work_time = (argc > 4 ? atoi(argv[4]) : 10);
+
+  if (num_stages <= 0 || fps <= 0.0 || num_frames <= 0 || work_time < 0)
+  {
+    std::cout << "Usage: realm_worker_latency_benchmark [num_stages] [fps] [num_frames] [work_time_ms]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Worker latency benchmark: " << num_stages << " stages, " << fps << " fps, " << num_frames
+            << " frames, " << work_time << " ms processing per stage" << std::endl;
+
+  printLatencies("polling", runPipeline(num_stages, fps, num_frames, work_time, false), num_frames);
+  printLatencies("event driven", runPipeline(num_stages, fps, num_frames, work_time, true), num_frames);
+  return EXIT_SUCCESS;
+}
@@ -232,7 +232,8 @@ class Pinhole
     void setDistortionMap(const double &k1, const double &k2, const double &p1, const double &p2, const double &k3);
 
     /*!
-     * @brief Setter for lens distortion. Directly initializes the rectification maps
+     * @brief Setter for lens distortion. Directly initializes the rectification maps. Maps are shared with all other
+     *        camera models of identical intrinsics, distortion and image size through the UndistortionMapCache.
      * @param dist_coeffs Lens distortion coefficients (k1, k2, p1, p2, k3)
      */
     void setDistortionMap(const cv::Mat &dist_coeffs);
@@ -310,7 +311,7 @@ class Pinhole
     // Interior parameters
     cv::Mat _camera_matrix; // K
 
-    // Distortion parameters
+    // Distortion parameters. Undistortion maps are shared through the cache and must not be modified
     cv::Mat _distortion_coeff;
     cv::Mat _undistortion_map1;
     cv::Mat _undistortion_map2;
@@ -23,6 +23,10 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
 
 #include <opencv2/core.hpp>
 
@@ -40,6 +44,67 @@ enum
   REALM_OVERWRITE_ZERO,
 };
 
+/*!
+ * @brief Typed access to the data of a single grid map layer. The string lookup and type check are done once when the
+ * handle is resolved, element access afterwards is plain pointer arithmetic. Intended for per grid element loops.
+ * Beware: The handle shares the layer data, but is not updated if the layer is reallocated, e.g. by extendToInclude,
+ * changeResolution, setGeometry or by adding new data with the same layer name.
+ * @tparam T Element type of the layer, e.g. float for CV_32F, cv::Vec4b for CV_8UC4. Handles resolved from a const map
+ * have a const qualified element type and give read only access.
+ */
+template<typename T>
+class LayerHandle
+{
+  public:
+    LayerHandle()
+    : _data(nullptr),
+      _step(0)
+    {
+    }
+
+    explicit LayerHandle(const cv::Mat &data)
+    : _mat(data),
+      _data(data.data),
+      _step(data.step[0])
+    {
+      if (data.empty())
+        throw(std::invalid_argument("Error creating layer handle: Layer data empty!"));
+      if (data.type() != cv::DataType<typename std::remove_const<T>::type>::type)
+        throw(std::invalid_argument("Error creating layer handle: Layer type mismatch!"));
+    }
+
+    /*!
+     * @brief Element access without any checks
+     * @param r row in the data matrix
+     * @param c col in the data matrix
+     * @return Reference to the element
+     */
+    inline T& operator()(int r, int c) const
+    {
+      return reinterpret_cast<T*>(_data + r*_step)[c];
+    }
+
+    /*!
+     * @brief Pointer to the first element of a row
+     * @param r row in the data matrix
+     * @return Pointer to the row
+     */
+    inline T* ptr(int r) const
+    {
+      return reinterpret_cast<T*>(_data + r*_step);
+    }
+
+    int rows() const { return _mat.rows; }
+    int cols() const { return _mat.cols; }
+    bool empty() const { return _data == nullptr; }
+
+  private:
+    // Keeps the layer data alive as long as the handle exists
+    cv::Mat _mat;
+    uchar* _data;
+    size_t _step;
+};
+
 /*!
  * @brief Idea adapted from Péter Frankhauser's GridMap library. However due to overhead and performance issues this
  * slim intermediate class was designed to provide an easy and efficient interface for the basic realm package
@@ -75,14 +140,14 @@ class CvGridMap
      * @brief Function to create deep copy of CvGridMap
      * @return Deep copy of this object
      */
-    CvGridMap clone();
+    CvGridMap clone() const;
 
     /*!
      * @brief Function to create deep copy of specific layers of this object
      * @param layer_names Vector of layer names
      * @return Deep copy of this object with specified layers only
      */
-    CvGridMap cloneSubmap(const std::vector<std::string> &layer_names);
+    CvGridMap cloneSubmap(const std::vector<std::string> &layer_names) const;
 
     /*!
      * @brief Adds a layer with name and data to the appropriate container
@@ -145,7 +210,7 @@ class CvGridMap
     void changeResolution(double resolution);
 
     /*!
-     * @brief Iterates through container to find layer by name and returns true if found
+     * @brief Looks up the layer by name and returns true if found
      * @param layer_name name of the desired layer
      * @return true if found, false if not existend
      */
@@ -165,7 +230,7 @@ class CvGridMap
     bool containsRoi(const cv::Rect2d &roi) const;
 
     /*!
-     * @brief Iterates through container to find layer and returns the data when found, exception when non existend
+     * @brief Looks up the layer by name and returns the data when found, exception when non existend
      * @param layer_name name of the desired layer
      * @return data matrix of the desired layer: float, double, CV8UC as data mat is supported
      * @throws out_of_range if layer not existend, data can not be set. Exception out_of_range is thrown
@@ -173,7 +238,7 @@ class CvGridMap
     cv::Mat& get(const std::string &layer_name);
 
     /*!
-     * @brief Iterates through container to find layer and returns the data when found, exception when non existend
+     * @brief Looks up the layer by name and returns the data when found, exception when non existend
      * @param layer_name name of the desired layer
      * @return data matrix of the desired layer: float, double, CV8UC as data mat is supported
      * @throws out_of_range if layer does not exist, data can not be set. Exception out_of_range is thrown
@@ -198,10 +263,36 @@ class CvGridMap
      */
     const cv::Mat& operator[](const std::string& layer_name) const;
 
+    /*!
+     * @brief Resolves a typed handle for fast element access of a layer, e.g.
+     *        LayerHandle<float> elevation = map.getHandle<float>("elevation"); elevation(r, c) = 1.0f;
+     * @param layer_name name of the desired layer
+     * @return Handle to the layer data
+     * @throws out_of_range if layer does not exist, invalid_argument if layer type does not match T
+     */
+    template<typename T>
+    LayerHandle<T> getHandle(const std::string &layer_name)
+    {
+      return LayerHandle<T>(get(layer_name));
+    }
+
+    /*!
+     * @brief Resolves a read only typed handle for fast element access of a layer
+     * @param layer_name name of the desired layer
+     * @return Handle to the layer data
+     * @throws out_of_range if layer does not exist, invalid_argument if layer type does not match T
+     */
+    template<typename T>
+    LayerHandle<const T> getHandle(const std::string &layer_name) const
+    {
+      return LayerHandle<const T>(get(layer_name));
+    }
+
     /*!
      * @brief Function to grab a whole layer including name and interpolation flag
      * @param layer_name Name of the layer to be grabbed
      * @return Layer
+     * @throws out_of_range if layer does not exist
      */
     Layer getLayer(const std::string& layer_name) const;
 
@@ -222,16 +313,21 @@ class CvGridMap
      * @brief Extracts a region of interest from specified layers
      * @param layer_names names of the desired layers of the submap
      * @param roi region of interest to be extracted
+     * @param deep_copy If true, the data of the roi is cloned. If false, the submap is a view on the data of this map,
+     *        so writing to the submap's layers writes directly into this map
      * @return submap of roi with desired layers
+     * @throws out_of_range if roi does not overlap with this map
      */
-    CvGridMap getSubmap(const std::vector<std::string> &layer_names, const cv::Rect2d &roi) const;
+    CvGridMap getSubmap(const std::vector<std::string> &layer_names, const cv::Rect2d &roi, bool deep_copy = true) const;
 
     /*!
      * @brief Extracts the overlapping region of two CvGridMaps and returns it as an isolated CvGridMap
      * @param other_map Other grid map to be compared with
+     * @param deep_copy If true, the overlapping data of both maps is cloned. If false, both returned maps are views on
+     *        the data of the original maps, no data is copied and writing to the overlap writes directly into them
      * @return Overlapping region as submap
      */
-    Overlap getOverlap(const CvGridMap &other_map) const;
+    Overlap getOverlap(const CvGridMap &other_map, bool deep_copy = true) const;
 
     /*!
      * @brief Accessing 2d index in the grid at a position in the world frame
@@ -299,6 +395,8 @@ class CvGridMap
     // vector of all layers added, currently very dynamic operations
     // like adding and removing layers frequently is not expected
     std::vector<Layer> _layers;
+    // Lookup of the index in "_layers" by layer name
+    std::unordered_map<std::string, uint32_t> _layer_lookup;
 
     void mergeMatrices(const cv::Mat &mat1, cv::Mat &mat2, int flag_merge_handling);
 
@@ -325,8 +423,9 @@ class CvGridMap
      * @brief Function to find the idx of a layer inside the layer container
      * @param layer_name Name of the layer to be found
      * @return idx of the layer inside vector "layers"
+     * @throws out_of_range if layer does not exist
      */
-    uint32_t findContainerIdx(const std::string &layer_name);
+    uint32_t findContainerIdx(const std::string &layer_name) const;
 
     /*!
      * @brief Function to fit the desired roi to a valid number.
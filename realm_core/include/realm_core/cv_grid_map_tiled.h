@@ -0,0 +1,208 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_CV_GRID_MAP_TILED_H
+#define PROJECT_CV_GRID_MAP_TILED_H
+
+#include <map>
+#include <vector>
+#include <memory>
+
+#include <opencv2/core.hpp>
+
+#include <realm_core/cv_grid_map.h>
+
+namespace realm
+{
+
+/*!
+ * @brief Sparse, tiled counterpart of the CvGridMap. The world is partitioned into fixed size tiles of
+ * tile_size x tile_size grid cells, which are keyed by their integer tile coordinate and only allocated once data is
+ * written into them. Adding a submap therefore only costs the tiles it touches, independent of the overall extent of
+ * the map. Layer semantics are the same as for CvGridMap: float layers are initialized with NaN, all other layers with
+ * zero. Data is exchanged with the rest of the framework as dense CvGridMap through add(...) and getSubmap(...).
+ */
+
+class CvGridMapTiled
+{
+  public:
+    using Ptr = std::shared_ptr<CvGridMapTiled>;
+    using ConstPtr = std::shared_ptr<const CvGridMapTiled>;
+
+    //! Integer tile coordinate (x = tile column index, y = tile row index in world frame, growing north)
+    using TileIndex = std::pair<int, int>;
+
+  public:
+    /*!
+     * @brief Constructor for the tiled grid map
+     * @param resolution Resolution as [m/cell], must match the resolution of all submaps added later on
+     * @param tile_size Number of grid cells per tile edge
+     * @throws invalid_argument if resolution or tile size are not positive
+     */
+    explicit CvGridMapTiled(double resolution, int tile_size = 256);
+
+    /*!
+     * @brief Adds a submap to the tiled map. Tiles touched by the submap are allocated if they do not exist yet. The
+     * overlap handling is identical to CvGridMap::add(...).
+     * @param submap Dense grid map with the same resolution as this map
+     * @param flag_overlap_handle REALM_OVERWRITE_ALL or REALM_OVERWRITE_ZERO
+     * @throws invalid_argument if resolution of submap does not match
+     */
+    void add(const CvGridMap &submap, int flag_overlap_handle);
+
+    /*!
+     * @brief Iterates through the registered layers and returns true if found
+     * @param layer_name name of the desired layer
+     * @return true if found, false if not existend
+     */
+    bool exists(const std::string &layer_name) const;
+
+    /*!
+     * @brief Function to check wether any data was added to the map
+     * @return true if no tile was allocated yet
+     */
+    bool empty() const;
+
+    /*!
+     * @brief Iterates through all registered layers and extracts their names
+     * @return vector of all layer names
+     */
+    std::vector<std::string> getAllLayerNames() const;
+
+    /*!
+     * @brief Extracts all data of the desired layers as dense grid map. The roi is the bounding box of all submaps
+     * added so far. Beware: This allocates the full bounding box, it is intended for exports, not for the incremental
+     * update loop.
+     * @param layer_names names of the desired layers within the grid map
+     * @return dense grid map of desired layers
+     */
+    CvGridMap getSubmap(const std::vector<std::string> &layer_names) const;
+
+    /*!
+     * @brief Extracts a region of interest of specified layers as dense grid map. Data is copied from the allocated
+     * tiles, regions without tiles are filled with the layer's default value (NaN for float, zero otherwise).
+     * @param layer_names names of the desired layers of the submap
+     * @param roi region of interest to be extracted
+     * @return dense grid map of roi with desired layers
+     * @throws out_of_range if one of the layers does not exist
+     */
+    CvGridMap getSubmap(const std::vector<std::string> &layer_names, const cv::Rect2d &roi) const;
+
+    /*!
+     * @brief Extracts all layers as dense grid map covering the bounding box of the data
+     * @return dense grid map
+     */
+    CvGridMap toCvGridMap() const;
+
+    /*!
+     * @brief Getter for the resolution of the grid
+     * @return resolution of the grid
+     */
+    double resolution() const;
+
+    /*!
+     * @brief Getter for the number of grid cells per tile edge
+     * @return tile size
+     */
+    int tileSize() const;
+
+    /*!
+     * @brief Getter for the number of tiles currently allocated
+     * @return number of allocated tiles
+     */
+    size_t getNumberOfTiles() const;
+
+    /*!
+     * @brief Getter for the bounding box of all submaps added so far
+     * @return roi in the world frame
+     */
+    cv::Rect2d roi() const;
+
+    /*!
+     * @brief Prints debug information of the tiled map, e.g. number of tiles, layers, roi in the world frame
+     */
+    void printInfo() const;
+
+  private:
+    //! Type and interpolation of a registered layer, data is stored per tile
+    struct LayerInfo
+    {
+        std::string name;
+        int type;
+        int interpolation;
+    };
+
+    //! Layer data of one tile, index corresponds to index in _layers. Might be empty if layer was never written
+    using Tile = std::vector<cv::Mat>;
+
+    // resolution therefor [m] / cell
+    double _resolution;
+
+    // Number of cells of one tile in both directions
+    int _tile_size;
+
+    // Bounding box of all added data in global grid indices. Column index is x / resolution, row index is
+    // y / resolution and therefore grows north, unlike the row index of the matrices
+    bool _has_data;
+    int _col_min;
+    int _col_max;
+    int _row_min;
+    int _row_max;
+
+    // Registered layers
+    std::vector<LayerInfo> _layers;
+
+    // Sparse tile storage
+    std::map<TileIndex, Tile> _tiles;
+
+    /*!
+     * @brief Function to find the idx of a layer inside the layer container
+     * @param layer_name Name of the layer to be found
+     * @return idx of the layer inside vector "layers", -1 if not existend
+     */
+    int findContainerIdx(const std::string &layer_name) const;
+
+    /*!
+     * @brief Creates a matrix of given size and type filled with the default value of CvGridMap layers
+     * @param size size of the matrix
+     * @param type OpenCV matrix type
+     * @return NaN initialized matrix for float types, zero initialized for all others
+     */
+    static cv::Mat createDefaultMat(const cv::Size2i &size, int type);
+
+    /*!
+     * @brief Computes the global grid index of the upper left element of a grid map
+     * @param map Grid map with the same resolution as this map
+     * @param col Output; global column index of the upper left element
+     * @param row Output; global row index of the upper left element (growing north)
+     */
+    void computeGlobalIndex(const CvGridMap &map, int &col, int &row) const;
+
+    /*!
+     * @brief Floor division for negative indices
+     */
+    static int floorDiv(int value, int divisor);
+
+    static void mergeMatrices(const cv::Mat &from, cv::Mat &to, int flag_merge_handling);
+};
+
+}
+
+#endif //PROJECT_CV_GRID_MAP_TILED_H
@@ -22,6 +22,7 @@
 #define PROJECT_FRAME_H
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -34,6 +35,7 @@
 #include <realm_core/utm32.h>
 #include <realm_core/camera.h>
 #include <realm_core/cv_grid_map.h>
+#include <realm_core/tracing.h>
 
 namespace realm
 {
@@ -110,7 +112,9 @@ class Frame
     cv::Mat getDefaultPose() const;
 
     /*!
-     * @brief Getter for the undistorted image
+     * @brief Getter for the undistorted image. It is computed with the first access and memoized afterwards as level
+     *        1.0 of the image pyramid. No deep copy, the returned image is shared and must not be modified. Clone it
+     *        before painting on it.
      * @return Undistorted image in full resolution
      */
     cv::Mat getImageUndistorted() const;
@@ -122,7 +126,9 @@ class Frame
     cv::Mat getImageRaw() const;
 
     /*!
-     * @brief Getter for the surface point cloud
+     * @brief Getter for the surface point cloud. No deep copy, the returned points are shared and must not be modified.
+     *        Transformations of the frame replace the point cloud instead of writing into it, so handed out points
+     *        stay valid.
      * @return Surface point cloud with row(i) = (x, y, z)
      */
     cv::Mat getSurfacePoints() const;
@@ -158,6 +164,13 @@ class Frame
      */
     SurfaceAssumption  getSurfaceAssumption() const;
 
+    /*!
+     * @brief Getter for the trace context, which contains the time the frame entered the pipeline and all spans
+     *        recorded for the frame by the stages so far
+     * @return Copy of the trace context
+     */
+    tracing::TraceContext getTraceContext() const;
+
     /*!
      * @brief Getter for the observed map, that is a grid in the reference plane
      * @return Grid map of the observed scene
@@ -205,17 +218,62 @@ class Frame
     cv::Size getResizedImageSize() const;
 
     /*!
-     * @brief Getter for the resized, undistorted image
+     * @brief Getter for the image size of an arbitrary level of the image pyramid
+     * @param factor Resize factor of the pyramid level
+     * @return Resized image size
+     */
+    cv::Size getResizedImageSize(double factor) const;
+
+    /*!
+     * @brief Getter for the default resize factor, that was set with 'setImageResizeFactor(...)'
+     * @return Default resize factor of the frame
+     */
+    double getImageResizeFactor() const;
+
+    /*!
+     * @brief Getter for the resized, undistorted image at the default resize factor. See overload for details.
      * @return Resized, undistorted image depending on the image resize factor set
      */
     cv::Mat getResizedImageUndistorted() const;
 
     /*!
-     * @brief Getter for the resized, distorted raw image
+     * @brief Getter for the resized, undistorted image of an arbitrary level of the image pyramid. It is computed with
+     *        the first access and memoized afterwards, so consumers working on different scales do not evict each
+     *        other. No deep copy, the returned image is shared and must not be modified. Clone it before painting on it.
+     * @param factor Resize factor of the pyramid level, e.g. 0.5 for half of the original edge length
+     * @return Resized, undistorted image
+     */
+    cv::Mat getResizedImageUndistorted(double factor) const;
+
+    /*!
+     * @brief Getter for the grayscale version of the resized, undistorted image at the default resize factor.
+     * @return Resized, undistorted grayscale image of type CV_8UC1
+     */
+    cv::Mat getResizedImageUndistortedGray() const;
+
+    /*!
+     * @brief Getter for the grayscale version of the resized, undistorted image of an arbitrary level of the image
+     *        pyramid. Memoized the same way as the color image. No deep copy, the returned image must not be modified.
+     * @param factor Resize factor of the pyramid level
+     * @return Resized, undistorted grayscale image of type CV_8UC1
+     */
+    cv::Mat getResizedImageUndistortedGray(double factor) const;
+
+    /*!
+     * @brief Getter for the resized, distorted raw image at the default resize factor. See overload for details.
      * @return Resized, distorted raw image depending on the image resize factor set
      */
     cv::Mat getResizedImageRaw() const;
 
+    /*!
+     * @brief Getter for the resized, distorted raw image of an arbitrary level of the image pyramid. Computed with the
+     *        first access. No deep copy, the returned image is shared and must not be modified. Clone it before
+     *        painting on it.
+     * @param factor Resize factor of the pyramid level
+     * @return Resized, distorted raw image
+     */
+    cv::Mat getResizedImageRaw(double factor) const;
+
     /*!
      * @brief Getter for the resized calibration matrix (pinhole only)
      * @return Resized calibration matrix (pinhole only), that is computed depending on the image resize factor
@@ -223,11 +281,26 @@ class Frame
     cv::Mat getResizedCalibration() const;
 
     /*!
-     * @brief Getter for the resized calibration model
+     * @brief Getter for the calibration matrix (pinhole only) of an arbitrary level of the image pyramid
+     * @param factor Resize factor of the pyramid level
+     * @return Resized calibration matrix
+     */
+    cv::Mat getResizedCalibration(double factor) const;
+
+    /*!
+     * @brief Getter for the resized calibration model at the default resize factor. See overload for details.
      * @return Resized calibration model, that is computed depending on the image resize factor
      */
     camera::Pinhole::Ptr getResizedCamera() const;
 
+    /*!
+     * @brief Getter for the calibration model of an arbitrary level of the image pyramid. The model is memoized until
+     *        the pose changes, the returned model is a copy of it and can therefore be modified.
+     * @param factor Resize factor of the pyramid level
+     * @return Resized calibration model
+     */
+    camera::Pinhole::Ptr getResizedCamera(double factor) const;
+
     /*!
      * @brief Setter for the camera pose computed by either the default pose or more advanced approached, e.g. visual SLAM
      * @param pose 3x4 camera pose matrix
@@ -263,6 +336,18 @@ class Frame
      */
     void setPoseAccurate(bool flag);
 
+    /*!
+     * @brief Setter for the trace context, e.g. after the frame was transported between processes
+     * @param context Trace context of the frame
+     */
+    void setTraceContext(const tracing::TraceContext &context);
+
+    /*!
+     * @brief Appends a span to the trace context of the frame, so it travels with the frame to the following stages
+     * @param span Span of work done for this frame
+     */
+    void addTraceSpan(const tracing::Span &span);
+
     /*!
      * @brief Setter for surface assumption. Default is PLANAR, but as soon as surface generation computed a 2.5D
      *        elevation, this function should be called.
@@ -270,14 +355,22 @@ class Frame
     void setSurfaceAssumption(SurfaceAssumption assumption);
 
     /*!
-     * @brief Setter for image resize factor. Many computations can not be done on full sized images. Resizing image and
-     *        camera model behind it can be usefull to reduce computational costs. Settings this resize factor is
-     *        necessary to call getter for functions with "getResized..." name.
+     * @brief Setter for the default image resize factor. Many computations can not be done on full sized images.
+     *        Resizing image and camera model behind it can be usefull to reduce computational costs. Settings this
+     *        resize factor is necessary to call the getter functions with "getResized..." name without an explicit
+     *        factor. It only selects the default level of the image pyramid, nothing is computed or discarded here.
      * @param value Resize factor for image size, e.g. 0.1 means the image is resized to 10% of original edge length,
      *        therefore 1% of the original resolution
      */
     void setImageResizeFactor(const double &value);
 
+    /*!
+     * @brief Releases the image pyramid with all memoized images and camera models. Should be called by the last stage
+     *        that consumes the frame, as the images are kept alive as long as the frame otherwise. Images handed out before
+     *        stay valid, later calls of the getters compute them again.
+     */
+    void releaseCache();
+
     /*!
      * @brief Function to print basic frame informations. Is usefull for debugging at certain points to check if the frame
      *        contains all the informations that it is expected to do.
@@ -408,9 +501,6 @@ class Frame
     // Note that data computed after frame creation might not be set at certain processing stages. It is also not
     // invariant over all processing steps, which is why it must be protected with mutex
 
-    //! Resized image, resize factor defined through image resize factor, only grabbable if factor was set
-    cv::Mat _img_resized;
-
     //! Reconstructed 3D surface points structured as cv::Mat
     //! Note: Point cloud can be either dense or sparse, and it can contain only positional informations (x,y,z),
     //!       optionally color (x,y,z,r,g,b) or also point normal (x,y,z,r,g,b,nx,ny,nz)
@@ -432,8 +522,8 @@ class Frame
     //! 3x4 camera motion in the geographic frame
     cv::Mat _motion_c2g;
 
-    //! Mutex for img resized
-    std::mutex _mutex_img_resized;
+    //! Mutex for the default image resize factor
+    mutable std::mutex _mutex_img_resized;
 
     //! Mutex for surface points
     std::mutex _mutex_surface_pts;
@@ -447,6 +537,51 @@ class Frame
     //! Mutex for transformation from world to geographic coordinate frame
     std::mutex _mutex_T_w2g;
 
+    //! Trace context of the frame, acquisition time is set on construction
+    tracing::TraceContext _trace_context;
+
+    //! Mutex for the trace context
+    mutable std::mutex _mutex_trace_context;
+
+    //! Level of the image pyramid. Holds all products derived for one resize factor, each of them is computed on
+    //! first access by the const getters. Empty if not computed yet.
+    struct PyramidLevel
+    {
+        cv::Mat img_raw;
+        cv::Mat img_undistorted;
+        cv::Mat img_undistorted_gray;
+        camera::Pinhole::Ptr camera;
+    };
+
+    //! Lazily filled image pyramid, key is the resize factor of the level
+    mutable std::map<double, PyramidLevel> _pyramid;
+
+    //! Mutex for the image pyramid
+    mutable std::mutex _mutex_pyramid;
+
+    /*!
+     * @brief Grabs a level of the image pyramid and computes its raw image, if not done yet. Must be called with
+     *        _mutex_pyramid locked.
+     * @param factor Resize factor of the pyramid level
+     * @return Reference to the pyramid level
+     * @throws invalid_argument if factor is not positive
+     */
+    PyramidLevel& getPyramidLevel(double factor) const;
+
+    /*!
+     * @brief Grabs the camera model of a pyramid level and computes it, if not done yet. Must be called with
+     *        _mutex_pyramid locked.
+     * @param level Pyramid level the camera belongs to
+     * @param factor Resize factor of the pyramid level
+     * @return Camera model of the pyramid level
+     */
+    camera::Pinhole::Ptr getPyramidCamera(PyramidLevel &level, double factor) const;
+
+    /*!
+     * @brief Resets the memoized camera models of all pyramid levels, as they depend on the pose
+     */
+    void invalidatePyramidCameras();
+
     /*!
      * @brief Private function to compute scene depth using the previously set surface points. Can obviously only be
      *        computed if surface points were generated by e.g. visual SLAM or stereo reconstruction. Be careful to
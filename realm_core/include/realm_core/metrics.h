@@ -0,0 +1,236 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_METRICS_H
+#define PROJECT_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace realm
+{
+namespace metrics
+{
+
+/*!
+ * @brief Monotonic counter, e.g. for the number of processed or dropped frames. Updates are lock-free.
+ */
+class Counter
+{
+  public:
+    using Ptr = std::shared_ptr<Counter>;
+
+  public:
+    Counter();
+
+    /*!
+     * @brief Increments the counter
+     * @param n Number of increments
+     */
+    void increment(uint64_t n = 1);
+
+    /*!
+     * @brief Getter for the current value
+     * @return value of the counter
+     */
+    uint64_t value() const;
+
+  private:
+    std::atomic<uint64_t> _value;
+};
+
+/*!
+ * @brief Gauge for values that go up and down, e.g. the current depth of a queue. Updates are lock-free.
+ */
+class Gauge
+{
+  public:
+    using Ptr = std::shared_ptr<Gauge>;
+
+  public:
+    Gauge();
+
+    /*!
+     * @brief Sets the gauge to a new value
+     * @param value New value
+     */
+    void set(int64_t value);
+
+    /*!
+     * @brief Adds to the gauge, negative values are allowed
+     * @param n Value to be added
+     */
+    void add(int64_t n);
+
+    /*!
+     * @brief Getter for the current value
+     * @return value of the gauge
+     */
+    int64_t value() const;
+
+  private:
+    std::atomic<int64_t> _value;
+};
+
+/*!
+ * @brief Lock-free latency histogram. Durations are recorded in microseconds into logarithmic buckets with
+ * kSubBuckets buckets per power of two, so percentiles have a relative error below 10% for all durations from a
+ * microsecond up to several days. Recording is a handful of relaxed atomic operations and safe from any thread.
+ */
+class Histogram
+{
+  public:
+    using Ptr = std::shared_ptr<Histogram>;
+
+    //! Number of buckets per power of two
+    static constexpr int kSubBuckets = 8;
+
+    //! Total number of buckets. Bucket 0 holds all durations below one microsecond
+    static constexpr int kNumBuckets = 1 + 40*kSubBuckets;
+
+    /*!
+     * @brief Summary of the histogram. Percentiles are the upper bound of the bucket they fall in, but never larger
+     * than the maximum recorded value. All durations in milliseconds.
+     */
+    struct Snapshot
+    {
+        uint64_t count;
+        double sum_ms;
+        double max_ms;
+        double p50_ms;
+        double p95_ms;
+        double p99_ms;
+    };
+
+  public:
+    Histogram();
+
+    /*!
+     * @brief Records a duration
+     * @param ms Duration in milliseconds. Negative durations are recorded as zero.
+     */
+    void record(double ms);
+
+    /*!
+     * @brief Computes the summary of all recorded durations. Recording is not blocked, so under concurrent updates the
+     * snapshot might not contain all durations recorded while it was taken.
+     * @return summary of the histogram
+     */
+    Snapshot snapshot() const;
+
+    /*!
+     * @brief Computes a single percentile of all recorded durations
+     * @param p Percentile in the range [0, 1], e.g. 0.95
+     * @return percentile in milliseconds, zero if no data was recorded
+     */
+    double percentile(double p) const;
+
+    /*!
+     * @brief Clears all recorded durations
+     */
+    void reset();
+
+  private:
+    std::atomic<uint64_t> _buckets[kNumBuckets];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum_us;
+    std::atomic<uint64_t> _max_us;
+
+    /*!
+     * @brief Computes the bucket of a duration
+     * @param us Duration in microseconds
+     * @return bucket index
+     */
+    static int toBucket(uint64_t us);
+
+    /*!
+     * @brief Computes the upper bound of a bucket
+     * @param bucket Index of the bucket
+     * @return upper bound in microseconds
+     */
+    static double toUpperBound(int bucket);
+};
+
+/*!
+ * @brief Registry of all metrics of the process. Metrics are created on first request and identified by their name,
+ * so all callers requesting the same name share one metric. Names should follow the Prometheus convention, e.g.
+ * "realm_stage_densification_process_ms". Only creation is synchronized, updates of the metrics itself are lock-free.
+ */
+class Registry
+{
+  public:
+    /*!
+     * @brief Getter for the registry of the process
+     * @return process wide registry
+     */
+    static Registry& instance();
+
+    /*!
+     * @brief Getter for a counter, created if not existing yet
+     * @param name Name of the counter
+     * @return counter
+     */
+    Counter::Ptr counter(const std::string &name);
+
+    /*!
+     * @brief Getter for a gauge, created if not existing yet
+     * @param name Name of the gauge
+     * @return gauge
+     */
+    Gauge::Ptr gauge(const std::string &name);
+
+    /*!
+     * @brief Getter for a histogram, created if not existing yet
+     * @param name Name of the histogram
+     * @return histogram
+     */
+    Histogram::Ptr histogram(const std::string &name);
+
+    /*!
+     * @brief Creates a text representation of all metrics in the Prometheus text format. Histograms are written as
+     * summary with 0.5, 0.95 and 0.99 quantiles, sum, count and an additional "_max" gauge.
+     * @return text of all metrics, sorted by name
+     */
+    std::string toText();
+
+  private:
+    std::mutex _mutex;
+    std::map<std::string, Counter::Ptr> _counters;
+    std::map<std::string, Gauge::Ptr> _gauges;
+    std::map<std::string, Histogram::Ptr> _histograms;
+};
+
+/*!
+ * @brief Converts an arbitrary name, e.g. a thread name like "Stage [densification]", into a valid metric name
+ * component. All characters except letters and digits are replaced by underscores, consecutive, leading and trailing
+ * underscores are removed and letters are converted to lower case.
+ * @param name Arbitrary name
+ * @return sanitized name, e.g. "stage_densification"
+ */
+std::string toMetricName(const std::string &name);
+
+} // namespace metrics
+} // namespace realm
+
+#endif //PROJECT_METRICS_H
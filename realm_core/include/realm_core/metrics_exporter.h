@@ -0,0 +1,108 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_METRICS_EXPORTER_H
+#define PROJECT_METRICS_EXPORTER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <realm_core/metrics.h>
+#include <realm_core/timer.h>
+
+namespace realm
+{
+namespace metrics
+{
+
+/*!
+ * @brief Exports the text representation of a metrics registry. Two independent ways are provided: A file that is
+ * rewritten periodically, and a local endpoint on 127.0.0.1 that answers every TCP connection, e.g. from curl or a
+ * Prometheus scraper, with a minimal HTTP response containing the metrics. Both are stopped on destruction.
+ */
+class Exporter
+{
+  public:
+    using Ptr = std::shared_ptr<Exporter>;
+    using ConstPtr = std::shared_ptr<const Exporter>;
+
+  public:
+    /*!
+     * @brief Constructor of the exporter
+     * @param registry Registry to be exported, usually the one of the process
+     */
+    explicit Exporter(Registry &registry = Registry::instance());
+
+    ~Exporter();
+
+    Exporter(const Exporter &other) = delete;
+    Exporter& operator=(const Exporter &other) = delete;
+
+    /*!
+     * @brief Starts writing the metrics periodically into a file. The file is written to a temporary file first and
+     * then renamed, so readers never see partially written data. Calling it again restarts with the new parameters.
+     * @param filename Absolute path of the file
+     * @param period Period of time in seconds, must be positive
+     * @throws invalid_argument if period is not positive
+     */
+    void startFileExport(const std::string &filename, int period);
+
+    /*!
+     * @brief Starts the local text endpoint on 127.0.0.1
+     * @param port Port of the endpoint
+     * @return true if the endpoint is listening, false if it was already started or the port could not be bound
+     */
+    bool startEndpoint(int port);
+
+    /*!
+     * @brief Writes the metrics into the file set with startFileExport(...) immediately
+     */
+    void writeFile();
+
+  private:
+    Registry &_registry;
+
+    //! File export
+    std::string _filename;
+    Timer::Ptr _timer_file_export;
+
+    //! Endpoint
+    int _socket;
+    std::atomic<bool> _is_endpoint_running;
+    std::thread _thread_endpoint;
+
+    /*!
+     * @brief Loop of the endpoint thread. Waits for connections with a timeout, so a stop is noticed quickly.
+     */
+    void runEndpoint();
+
+    /*!
+     * @brief Answers a single connection of the endpoint with the current metrics
+     * @param connection Socket of the accepted connection
+     */
+    void answer(int connection);
+};
+
+} // namespace metrics
+} // namespace realm
+
+#endif //PROJECT_METRICS_EXPORTER_H
@@ -52,17 +52,49 @@ void remap(const Frame::Ptr &frame,
  */
 cv::Mat reprojectDepthMap(const camera::Pinhole::Ptr &cam, const cv::Mat &depthmap);
 
+/*!
+ * @brief Function for computation of world points and surface normals from depth map in one row parallel sweep. Saves
+ *        a second pass over the depth map compared to 'reprojectDepthMap' followed by 'computeNormalsFromDepthMap'.
+ *        Positions stay double precision, as world points might be in absolute UTM coordinates.
+ * @param cam Camera model, e.g. pinhole for projection of points. Must contain R, t and K
+ * @param depthmap Depth map computed with a stereo reconstruction framework of choice, normalised to min/max depth
+ * @param img3d Output; 3-channel double precision matrix (CV_64FC3) with world point coordinates at each element
+ * @param normals Output; normal map with type CV_32FC3, only written if compute_normals is set
+ * @param compute_normals Flag if normals should be computed
+ */
+void reprojectDepthMap(const camera::Pinhole::Ptr &cam,
+                       const cv::Mat &depthmap,
+                       cv::Mat &img3d,
+                       cv::Mat &normals,
+                       bool compute_normals = true);
+
 /*!
  * @brief Function for computation of depth and depth map from pointcloud and camera model
  * @param cam Camera model, e.g. pinhole for projection of points. Must contain R, t and K
  * @param points Point cloud structured es mat rowise x, y, z coordinates
- * @return depth map
+ * @return depth map of type CV_32F, -1 where no point was projected. See 'projectPointCloud' for details.
  */
 cv::Mat computeDepthMapFromPointCloud(const camera::Pinhole::Ptr &cam, const cv::Mat &points);
 
 /*!
- * @brief Function for computation of normals from an input depth map
- * @param depth Input depth map
+ * @brief Projects a point cloud into the image plane of a camera. The whole cloud is transformed in one parallel pass,
+ *        afterwards the points are written into a z-buffer, so the point closest to the camera wins for every pixel.
+ *        Points behind the camera are ignored. The result can be reused for all computations based on the sparse
+ *        depth, e.g. densification and masking, instead of projecting the cloud again.
+ * @param cam Camera model, e.g. pinhole for projection of points. Must contain R, t and K
+ * @param points Point cloud of type CV_64F structured as mat rowise x, y, z, ... coordinates
+ * @param depth_map Output; depth map of type CV_32F with the size of the camera, -1 where no point was projected
+ * @param index_map Output; map of type CV_32S with the row index of the projected point, -1 where no point was projected
+ * @throws invalid_argument if point matrix has wrong type
+ */
+void projectPointCloud(const camera::Pinhole::Ptr &cam,
+                       const cv::Mat &points,
+                       cv::Mat &depth_map,
+                       cv::Mat &index_map);
+
+/*!
+ * @brief Function for computation of normals from an input depth map. Rows are processed in parallel.
+ * @param depth Input depth map of type CV_32F with at least 3x3 elements
  * @return Normal map with type CV_32FC3
  */
 cv::Mat computeNormalsFromDepthMap(const cv::Mat& depth);
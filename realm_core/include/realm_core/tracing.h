@@ -0,0 +1,194 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_TRACING_H
+#define PROJECT_TRACING_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace realm
+{
+namespace tracing
+{
+
+/*!
+ * @brief One timed section of work, e.g. the processing of a frame inside a stage. Times are microseconds since unix
+ * epoch, so spans recorded by different processes on the same machine can be merged into one trace.
+ */
+struct Span
+{
+    std::string name;
+    uint32_t frame_id;
+    int64_t t_start;
+    int64_t t_end;
+    uint32_t pid;
+    uint32_t tid;
+};
+
+/*!
+ * @brief Trace context carried by a frame through the pipeline. Contains the time the frame entered the pipeline and
+ * all spans recorded for the frame so far, so the last stage knows the full path of the frame.
+ */
+struct TraceContext
+{
+    int64_t t_acquisition;
+    std::vector<Span> spans;
+};
+
+/*!
+ * @brief Process wide collector of spans. Each thread records into its own ring buffer of kBufferSize spans, older
+ * spans are overwritten. Tracing is disabled by default, then recording costs a single atomic load. Additionally the
+ * trace contexts of frames leaving a stage are kept, so the critical path of every frame can be exported, including
+ * the spans recorded in other processes.
+ */
+class Tracer
+{
+  public:
+    //! Number of spans kept per thread
+    static constexpr size_t kBufferSize = 8192;
+
+    //! Number of frame trace contexts kept
+    static constexpr size_t kMaxFrames = 256;
+
+  public:
+    /*!
+     * @brief Getter for the tracer of the process
+     * @return process wide tracer
+     */
+    static Tracer& instance();
+
+    /*!
+     * @brief Current time as used for all spans
+     * @return microseconds since unix epoch
+     */
+    static int64_t now();
+
+    /*!
+     * @brief Enables or disables the recording of spans
+     * @param flag true to enable
+     */
+    void setEnabled(bool flag);
+
+    /*!
+     * @brief Threadsafe check, if recording is enabled
+     * @return true if enabled
+     */
+    bool isEnabled() const
+    {
+      return _is_enabled.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * @brief Records a span into the ring buffer of the calling thread. Process and thread id of the span are set by
+     * the tracer, so the same span can afterwards be appended to the trace context of a frame.
+     * @param span Span to be recorded
+     */
+    void record(Span &span);
+
+    /*!
+     * @brief Keeps the trace context of a frame for export. A later context of the same frame replaces the former one.
+     * @param frame_id Id of the frame
+     * @param context Trace context of the frame
+     */
+    void recordFrame(uint32_t frame_id, const TraceContext &context);
+
+    /*!
+     * @brief Collects the spans of all threads and frames, duplicates are removed
+     * @return all spans sorted by start time
+     */
+    std::vector<Span> collect();
+
+    /*!
+     * @brief Removes all recorded spans and frames
+     */
+    void clear();
+
+    /*!
+     * @brief Writes all recorded spans as Chrome trace JSON, which can be opened with chrome://tracing or Perfetto.
+     * Spans are complete events on their process and thread. Spans of the same frame are connected with flow events in
+     * the order of their start, and every exported frame gets an async event from acquisition until its last span.
+     * @param filename Path of the output file
+     * @return true if written successfully
+     */
+    bool writeChromeTrace(const std::string &filename);
+
+  private:
+    //! Ring buffer of a single thread
+    struct ThreadBuffer
+    {
+        std::mutex mutex;
+        std::vector<Span> spans;
+        size_t next;
+        uint32_t tid;
+    };
+
+    Tracer();
+
+    std::atomic<bool> _is_enabled;
+
+    std::mutex _mutex_buffers;
+    std::vector<std::shared_ptr<ThreadBuffer>> _buffers;
+
+    std::mutex _mutex_frames;
+    std::map<uint32_t, TraceContext> _frames;
+    std::deque<uint32_t> _frame_order;
+
+    /*!
+     * @brief Getter for the ring buffer of the calling thread, created on first use
+     * @return ring buffer of the calling thread
+     */
+    ThreadBuffer* getThreadBuffer();
+};
+
+/*!
+ * @brief Records a span for the lifetime of the object, e.g. a scope of processing. Does nothing if tracing is
+ * disabled at construction.
+ */
+class ScopedSpan
+{
+  public:
+    /*!
+     * @brief Starts the span
+     * @param name Name of the span, e.g. "densification/process"
+     * @param frame_id Id of the frame the work belongs to
+     */
+    ScopedSpan(const std::string &name, uint32_t frame_id);
+
+    ~ScopedSpan();
+
+    ScopedSpan(const ScopedSpan &other) = delete;
+    ScopedSpan& operator=(const ScopedSpan &other) = delete;
+
+  private:
+    bool _is_active;
+    Span _span;
+};
+
+} // namespace tracing
+} // namespace realm
+
+#endif //PROJECT_TRACING_H
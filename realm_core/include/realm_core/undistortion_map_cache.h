@@ -0,0 +1,101 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_UNDISTORTION_MAP_CACHE_H
+#define PROJECT_UNDISTORTION_MAP_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace realm
+{
+namespace camera
+{
+
+/*!
+ * @brief Process wide, threadsafe cache for undistortion maps. Pinhole models are created and resized frequently,
+ *        e.g. for every access to the resized camera of a frame, but only few different combinations of intrinsics,
+ *        distortion and image size exist during a mission. Maps are therefore computed only once per combination in
+ *        the compact fixed point format (CV_16SC2 + CV_16UC1) and shared afterwards. The returned maps must be treated
+ *        as read only. If the capacity is reached, the least recently used maps are dropped.
+ */
+class UndistortionMapCache
+{
+  public:
+    /*!
+     * @brief Returns the undistortion maps for the given camera parameters. Computes and inserts them, if not cached
+     *        yet. The maps can directly be used with cv::remap(...).
+     * @param K Calibration matrix (3x3) of type CV_64F
+     * @param dist_coeffs Lens distortion coefficients, e.g. (k1, k2, p1, p2, k3), of type CV_64F
+     * @param size Image size the maps are computed for
+     * @param map1 Output; fixed point map of type CV_16SC2
+     * @param map2 Output; interpolation table of type CV_16UC1
+     */
+    static void get(const cv::Mat &K, const cv::Mat &dist_coeffs, const cv::Size &size, cv::Mat &map1, cv::Mat &map2);
+
+    /*!
+     * @brief Setter for the maximum number of cached map pairs. Exceeding entries are dropped immediately.
+     * @param capacity Maximum number of map pairs, must be positive
+     * @throws invalid_argument if capacity is not positive
+     */
+    static void setCapacity(size_t capacity);
+
+    /*!
+     * @brief Getter for the number of currently cached map pairs
+     * @return Number of cached map pairs
+     */
+    static size_t size();
+
+    /*!
+     * @brief Removes all cached maps
+     */
+    static void clear();
+
+  private:
+    //! Camera parameters as (fx, fy, skew, cx, cy, dist coeffs..., width, height). Exact comparison is intended.
+    using Key = std::vector<double>;
+
+    struct Entry
+    {
+        cv::Mat map1;
+        cv::Mat map2;
+        uint64_t last_access;
+    };
+
+    static std::mutex _mutex;
+    static std::map<Key, Entry> _entries;
+    static size_t _capacity;
+    static uint64_t _access_counter;
+
+    static Key createKey(const cv::Mat &K, const cv::Mat &dist_coeffs, const cv::Size &size);
+
+    /*!
+     * @brief Removes least recently used entries until the capacity is met. Mutex must be locked by the caller.
+     */
+    static void shrinkToCapacity();
+};
+
+} // namespace camera
+} // namespace realm
+
+#endif //PROJECT_UNDISTORTION_MAP_CACHE_H
@@ -24,8 +24,11 @@
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <condition_variable>
 #include <string>
 
+#include <realm_core/metrics.h>
+
 namespace realm
 {
 
@@ -74,6 +77,24 @@ class WorkerThreadBase
      */
     void requestFinish();
 
+    /*!
+     * @brief Switches between polling and event driven processing. In polling mode (default) the thread sleeps
+     * "sleep_time" after every call to process(). In event driven mode process() is called again immediately as long as
+     * it reports processed data. Otherwise the thread waits until notifyWorkAvailable() or a stop, reset, resume or
+     * finish request wakes it up. "sleep_time" is then only the maximum waiting time, so derived classes with time
+     * triggered work are still called regularly. Should be set before start().
+     * @param flag true for event driven processing, false for polling
+     */
+    void setEventDriven(bool flag);
+
+    /*!
+     * @brief Threadsafe check, if the thread has currently nothing to do. This is the case, if the last call of process()
+     * did not process any data and no new work was notified since then. Only meaningful, if the derived class calls
+     * notifyWorkAvailable() whenever data is added.
+     * @return true if idle, false if processing or work was notified
+     */
+    bool isIdle();
+
   protected:
 
     /*!
@@ -91,6 +112,12 @@ class WorkerThreadBase
      */
     bool _verbose;
 
+    /*!
+     * @brief Prefix of all metrics of this thread, e.g. "realm_stage_densification_" for thread "Stage [densification]".
+     * Derived classes should use it for their own metrics, so all metrics of one thread are grouped.
+     */
+    std::string _metrics_prefix;
+
     /*!
      * @brief Function that every derived worker thread should implement. run() will trigger process, if no stop, reset or
      * finish is requested from the main thread. process() should contain the general workflow.
@@ -143,6 +170,23 @@ class WorkerThreadBase
     bool _is_stopped;
     std::mutex _mutex_is_stopped;
 
+    /*!
+     * @brief Event driven processing: set true, if the thread should process as soon as possible, e.g. because new
+     * data was added or a request was received. Will be set false again, when the thread wakes up.
+     */
+    bool _is_event_driven;
+    bool _has_notification;
+    bool _is_idle;
+    uint64_t _nrof_notifications;
+    std::mutex _mutex_notification;
+    std::condition_variable _condition_notification;
+
+    /*!
+     * @brief Wakes up the thread in event driven mode. Should be called by the derived class after new data was
+     * added to its input buffer, e.g. at the end of addFrame(...). In polling mode only the idle state is updated.
+     */
+    void notifyWorkAvailable();
+
     /*!
      * @brief virtual function for the derived stage to be implemented. Has to reset all neccessary data to allow a
      * fresh new start of the stage.
@@ -180,6 +224,33 @@ class WorkerThreadBase
      */
     bool isStopped();
 
+  private:
+
+    /*!
+     * @brief Idle function of the loop. Sleeps for "sleep_time" in polling mode, waits for a notification or at most
+     * "sleep_time" in event driven mode.
+     */
+    void waitForWork();
+
+    /*!
+     * @brief Threadsafe getter for the number of notifications received so far
+     */
+    uint64_t getNumberOfNotifications();
+
+    /*!
+     * @brief Updates the idle state after a call to process()
+     * @param has_processed Return value of process()
+     * @param nrof_notifications Number of notifications before process() was called
+     */
+    void updateIdleState(bool has_processed, uint64_t nrof_notifications);
+
+    /*!
+     * @brief Metrics of the processing loop. Only calls to process() that actually processed data are recorded, so
+     * empty loops of an idle thread do not distort the duration.
+     */
+    metrics::Counter::Ptr _metric_process_calls;
+    metrics::Histogram::Ptr _metric_process_time;
+
 };
 
 } // namespace realm
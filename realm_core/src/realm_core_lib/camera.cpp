@@ -23,6 +23,7 @@
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include <realm_core/camera.h>
+#include <realm_core/undistortion_map_cache.h>
 
 namespace realm
 {
@@ -85,9 +86,10 @@ Pinhole::Pinhole(const Pinhole &that)
 {
   if (_do_undistort)
   {
+    // Undistortion maps are read only and shared through the cache, so no deep copy is needed
     _distortion_coeff = that._distortion_coeff.clone();
-    _undistortion_map1 = that._undistortion_map1.clone();
-    _undistortion_map2 = that._undistortion_map2.clone();
+    _undistortion_map1 = that._undistortion_map1;
+    _undistortion_map2 = that._undistortion_map2;
   }
 }
 
@@ -104,8 +106,8 @@ Pinhole& Pinhole::operator=(const Pinhole &that)
 
     if (_do_undistort) {
       _distortion_coeff = that._distortion_coeff.clone();
-      _undistortion_map1 = that._undistortion_map1.clone();
-      _undistortion_map2 = that._undistortion_map2.clone();
+      _undistortion_map1 = that._undistortion_map1;
+      _undistortion_map2 = that._undistortion_map2;
     }
   }
   return *this;
@@ -276,14 +278,11 @@ void Pinhole::setDistortionMap(const cv::Mat &dist_coeffs)
 {
   assert(!dist_coeffs.empty() && dist_coeffs.type() == CV_64F);
   _distortion_coeff = dist_coeffs;
-  cv::initUndistortRectifyMap(_camera_matrix,
-                              _distortion_coeff,
-                              cv::Mat_<double>::eye(3, 3),
-                              _camera_matrix,
-                              cv::Size(_img_width, _img_height),
-                              CV_16SC2,
-                              _undistortion_map1,
-                              _undistortion_map2);
+  UndistortionMapCache::get(_camera_matrix,
+                            _distortion_coeff,
+                            cv::Size(_img_width, _img_height),
+                            _undistortion_map1,
+                            _undistortion_map2);
   _do_undistort = true;
 }
 
@@ -303,11 +302,11 @@ Pinhole Pinhole::resize(double factor) const
   K.at<double>(1, 1) *= factor;
   K.at<double>(0, 2) *= factor;
   K.at<double>(1, 2) *= factor;
-  cv::Mat dist_coeffs = _distortion_coeff.clone();
   auto width = static_cast<uint32_t>(std::round((double)_img_width * factor));
   auto height = static_cast<uint32_t>(std::round((double)_img_height * factor));
 
-  Pinhole cam_resized(K, dist_coeffs, width, height);
+  // Undistortion maps of the resized model are taken from the cache, so only the first resize per factor computes them
+  Pinhole cam_resized = (_do_undistort ? Pinhole(K, _distortion_coeff.clone(), width, height) : Pinhole(K, width, height));
   if (!_exterior_rotation.empty() && !_exterior_translation.empty())
   {
     cam_resized._exterior_rotation = _exterior_rotation.clone();
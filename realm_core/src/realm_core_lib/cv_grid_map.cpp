@@ -40,7 +40,7 @@ CvGridMap::CvGridMap(const cv::Rect2d &roi, double resolution)
   setGeometry(roi, _resolution);
 }
 
-CvGridMap CvGridMap::clone()
+CvGridMap CvGridMap::clone() const
 {
   CvGridMap copy;
   copy.setGeometry(_roi, _resolution);
@@ -49,7 +49,7 @@ CvGridMap CvGridMap::clone()
   return copy;
 }
 
-CvGridMap CvGridMap::cloneSubmap(const std::vector<std::string> &layer_names)
+CvGridMap CvGridMap::cloneSubmap(const std::vector<std::string> &layer_names) const
 {
   CvGridMap copy;
   copy.setGeometry(_roi, _resolution);
@@ -64,11 +64,15 @@ CvGridMap CvGridMap::cloneSubmap(const std::vector<std::string> &layer_names)
 void CvGridMap::add(const Layer &layer)
 {
   // Add data if layer already exists, push to container if not
-  if (!exists(layer.name))
+  auto it = _layer_lookup.find(layer.name);
+  if (it == _layer_lookup.end())
+  {
     _layers.push_back(layer);
+    _layer_lookup[layer.name] = static_cast<uint32_t>(_layers.size() - 1);
+  }
   else
   {
-    _layers[findContainerIdx(layer.name)] = layer;
+    _layers[it->second] = layer;
   }
 }
 
@@ -165,12 +169,7 @@ bool CvGridMap::empty() const
 
 bool CvGridMap::exists(const std::string &layer_name) const
 {
-  for (const auto &layer : _layers)
-  {
-    if (layer.name == layer_name)
-      return true;
-  }
-  return false;
+  return _layer_lookup.find(layer_name) != _layer_lookup.end();
 }
 
 bool CvGridMap::containsRoi(const cv::Rect2d &roi) const
@@ -180,29 +179,26 @@ bool CvGridMap::containsRoi(const cv::Rect2d &roi) const
 
 cv::Mat& CvGridMap::get(const std::string& layer_name)
 {
-  for (auto &layer : _layers)
-  {
-    if (layer.name == layer_name)
-      return layer.data;
-  }
+  auto it = _layer_lookup.find(layer_name);
+  if (it != _layer_lookup.end())
+    return _layers[it->second].data;
   throw std::out_of_range("No layer with name '" + layer_name + "' available.");
 }
 
 const cv::Mat& CvGridMap::get(const std::string& layer_name) const
 {
-  for (const auto &layer : _layers)
-  {
-    if (layer.name == layer_name)
-      return layer.data;
-  }
+  auto it = _layer_lookup.find(layer_name);
+  if (it != _layer_lookup.end())
+    return _layers[it->second].data;
   throw std::out_of_range("No layer with name '" + layer_name + "' available.");
 }
 
 CvGridMap::Layer CvGridMap::getLayer(const std::string& layer_name) const
 {
-  for (const auto& layer : _layers)
-    if (layer.name == layer_name)
-      return layer;
+  auto it = _layer_lookup.find(layer_name);
+  if (it != _layer_lookup.end())
+    return _layers[it->second];
+  throw std::out_of_range("No layer with name '" + layer_name + "' available.");
 }
 
 std::vector<std::string> CvGridMap::getAllLayerNames() const
@@ -225,19 +221,28 @@ CvGridMap CvGridMap::getSubmap(const std::vector<std::string> &layer_names) cons
   return submap;
 }
 
-CvGridMap CvGridMap::getSubmap(const std::vector<std::string> &layer_names, const cv::Rect2d &roi) const
+CvGridMap CvGridMap::getSubmap(const std::vector<std::string> &layer_names, const cv::Rect2d &roi, bool deep_copy) const
 {
   CvGridMap submap;
   submap.setGeometry(roi, _resolution);
-  CvGridMap::Overlap overlap = getOverlap(submap);
 
-  if (overlap.first != nullptr && overlap.second != nullptr)
-    return overlap.first->getSubmap(layer_names);
-  else
+  cv::Rect2d overlap_roi = (_roi & submap._roi);
+  if (overlap_roi.area() < 10e-6)
     throw(std::out_of_range("Error extracting submap: No overlap!"));
+
+  // Only the desired layers are extracted, either as view or as deep copy
+  cv::Rect2i grid_roi(atIndexROI(overlap_roi));
+  submap.setGeometry(overlap_roi, _resolution);
+  for (const auto &layer_name : layer_names)
+  {
+    Layer layer = getLayer(layer_name);
+    cv::Mat data = (deep_copy ? layer.data(grid_roi).clone() : layer.data(grid_roi));
+    submap.add(layer.name, data, layer.interpolation);
+  }
+  return submap;
 }
 
-CvGridMap::Overlap CvGridMap::getOverlap(const CvGridMap &other_map) const
+CvGridMap::Overlap CvGridMap::getOverlap(const CvGridMap &other_map, bool deep_copy) const
 {
   cv::Rect2d overlap_roi = (_roi & other_map._roi);
 
@@ -254,7 +259,7 @@ CvGridMap::Overlap CvGridMap::getOverlap(const CvGridMap &other_map) const
   map_ref->setGeometry(overlap_roi, _resolution);
   for (const auto &layer : _layers)
   {
-    cv::Mat overlap_data = layer.data(this_grid_roi).clone();
+    cv::Mat overlap_data = (deep_copy ? layer.data(this_grid_roi).clone() : layer.data(this_grid_roi));
     map_ref->add(layer.name, overlap_data, layer.interpolation);
   }
 
@@ -263,7 +268,7 @@ CvGridMap::Overlap CvGridMap::getOverlap(const CvGridMap &other_map) const
   map_added->setGeometry(overlap_roi, _resolution);
   for (const auto &layer : other_map._layers)
   {
-    cv::Mat overlap_data = layer.data(other_grid_roi).clone();
+    cv::Mat overlap_data = (deep_copy ? layer.data(other_grid_roi).clone() : layer.data(other_grid_roi));
     map_added->add(layer.name, overlap_data, layer.interpolation);
   }
   return std::make_pair(map_ref, map_added);
@@ -399,7 +404,7 @@ cv::Point2d CvGridMap::atPosition2d(uint32_t r, uint32_t c) const
 
 cv::Point3d CvGridMap::atPosition3d(const int &r, const int &c, const std::string &layer_name) const
 {
-  cv::Mat layer_data = get(layer_name);
+  const cv::Mat &layer_data = get(layer_name);
 
   // check validity
   if (layer_data.empty())
@@ -498,11 +503,11 @@ bool CvGridMap::isMatrixTypeValid(int type)
   }
 }
 
-uint32_t CvGridMap::findContainerIdx(const std::string &layer_name)
+uint32_t CvGridMap::findContainerIdx(const std::string &layer_name) const
 {
-  for (uint32_t i = 0; i < _layers.size(); ++i)
-    if (_layers[i].name == layer_name)
-      return i;
+  auto it = _layer_lookup.find(layer_name);
+  if (it != _layer_lookup.end())
+    return it->second;
   throw(std::out_of_range("Error: Index for layer not found!"));
 }
 
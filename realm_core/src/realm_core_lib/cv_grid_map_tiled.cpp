@@ -0,0 +1,302 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include <realm_core/loguru.h>
+#include <realm_core/cv_grid_map_tiled.h>
+
+using namespace realm;
+
+CvGridMapTiled::CvGridMapTiled(double resolution, int tile_size)
+    : _resolution(resolution),
+      _tile_size(tile_size),
+      _has_data(false),
+      _col_min(0),
+      _col_max(0),
+      _row_min(0),
+      _row_max(0)
+{
+  if (_resolution < 10e-6)
+    throw(std::invalid_argument("Error: Resolution is zero!"));
+  if (_tile_size <= 0)
+    throw(std::invalid_argument("Error: Tile size must be positive!"));
+}
+
+void CvGridMapTiled::add(const CvGridMap &submap, int flag_overlap_handle)
+{
+  if (fabs(_resolution - submap.resolution()) > std::numeric_limits<double>::epsilon())
+    throw(std::invalid_argument("Error add submap: Resolution mismatch!"));
+
+  if (submap.empty())
+    return;
+
+  // Register all layers of the submap, that have not been seen yet. Each registered layer is paired with the
+  // corresponding data of the submap
+  std::vector<std::pair<int, cv::Mat>> layers_to_add;
+  for (const auto &layer_name : submap.getAllLayerNames())
+  {
+    CvGridMap::Layer layer = submap.getLayer(layer_name);
+    if (layer.data.empty())
+      continue;
+
+    int idx = findContainerIdx(layer.name);
+    if (idx < 0)
+    {
+      _layers.push_back(LayerInfo{layer.name, layer.data.type(), layer.interpolation});
+      idx = static_cast<int>(_layers.size()) - 1;
+    }
+    else if (_layers[idx].type != layer.data.type())
+      throw(std::invalid_argument("Error add submap: Layer type mismatch for layer '" + layer.name + "'!"));
+    layers_to_add.emplace_back(idx, layer.data);
+  }
+
+  // Global grid indices of the submap. Upper left is (col_first, row_first), lower right is (col_last, row_last)
+  int col_first, row_first;
+  computeGlobalIndex(submap, col_first, row_first);
+  int col_last = col_first + submap.size().width - 1;
+  int row_last = row_first - submap.size().height + 1;
+
+  // Iterate all tiles touched by the submap. Only these are allocated, all others remain untouched
+  for (int ty = floorDiv(row_last, _tile_size); ty <= floorDiv(row_first, _tile_size); ++ty)
+    for (int tx = floorDiv(col_first, _tile_size); tx <= floorDiv(col_last, _tile_size); ++tx)
+    {
+      int tile_col_first = tx*_tile_size;
+      int tile_row_first = ty*_tile_size + _tile_size - 1;
+
+      int c_lo = std::max(col_first, tile_col_first);
+      int c_hi = std::min(col_last, tile_col_first + _tile_size - 1);
+      int r_lo = std::max(row_last, tile_row_first - _tile_size + 1);
+      int r_hi = std::min(row_first, tile_row_first);
+
+      cv::Rect2i src_roi(c_lo - col_first, row_first - r_hi, c_hi - c_lo + 1, r_hi - r_lo + 1);
+      cv::Rect2i dst_roi(c_lo - tile_col_first, tile_row_first - r_hi, c_hi - c_lo + 1, r_hi - r_lo + 1);
+
+      Tile &tile = _tiles[TileIndex(tx, ty)];
+      if (tile.size() < _layers.size())
+        tile.resize(_layers.size());
+
+      for (const auto &layer : layers_to_add)
+      {
+        cv::Mat &tile_data = tile[layer.first];
+        if (tile_data.empty())
+          tile_data = createDefaultMat(cv::Size2i(_tile_size, _tile_size), _layers[layer.first].type);
+
+        cv::Mat dst_data_roi = tile_data(dst_roi);
+        mergeMatrices(layer.second(src_roi), dst_data_roi, flag_overlap_handle);
+      }
+    }
+
+  // Finally grow the bounding box of the data
+  if (!_has_data)
+  {
+    _col_min = col_first;
+    _col_max = col_last;
+    _row_min = row_last;
+    _row_max = row_first;
+    _has_data = true;
+  }
+  else
+  {
+    _col_min = std::min(_col_min, col_first);
+    _col_max = std::max(_col_max, col_last);
+    _row_min = std::min(_row_min, row_last);
+    _row_max = std::max(_row_max, row_first);
+  }
+}
+
+bool CvGridMapTiled::exists(const std::string &layer_name) const
+{
+  return findContainerIdx(layer_name) >= 0;
+}
+
+bool CvGridMapTiled::empty() const
+{
+  return _tiles.empty();
+}
+
+std::vector<std::string> CvGridMapTiled::getAllLayerNames() const
+{
+  std::vector<std::string> layer_names;
+  for (const auto &layer : _layers)
+    layer_names.push_back(layer.name);
+  return layer_names;
+}
+
+CvGridMap CvGridMapTiled::getSubmap(const std::vector<std::string> &layer_names) const
+{
+  if (!_has_data)
+    return CvGridMap();
+  return getSubmap(layer_names, roi());
+}
+
+CvGridMap CvGridMapTiled::getSubmap(const std::vector<std::string> &layer_names, const cv::Rect2d &roi) const
+{
+  CvGridMap submap(roi, _resolution);
+
+  int col_first, row_first;
+  computeGlobalIndex(submap, col_first, row_first);
+  int col_last = col_first + submap.size().width - 1;
+  int row_last = row_first - submap.size().height + 1;
+
+  // Create the dense output layers first with default values
+  std::vector<std::pair<int, cv::Mat>> layers_to_get;
+  for (const auto &layer_name : layer_names)
+  {
+    int idx = findContainerIdx(layer_name);
+    if (idx < 0)
+      throw(std::out_of_range("Error extracting submap: No layer with name '" + layer_name + "' available."));
+    layers_to_get.emplace_back(idx, createDefaultMat(submap.size(), _layers[idx].type));
+  }
+
+  // Copy the data of all allocated tiles inside the roi
+  for (int ty = floorDiv(row_last, _tile_size); ty <= floorDiv(row_first, _tile_size); ++ty)
+    for (int tx = floorDiv(col_first, _tile_size); tx <= floorDiv(col_last, _tile_size); ++tx)
+    {
+      auto it = _tiles.find(TileIndex(tx, ty));
+      if (it == _tiles.end())
+        continue;
+      const Tile &tile = it->second;
+
+      int tile_col_first = tx*_tile_size;
+      int tile_row_first = ty*_tile_size + _tile_size - 1;
+
+      int c_lo = std::max(col_first, tile_col_first);
+      int c_hi = std::min(col_last, tile_col_first + _tile_size - 1);
+      int r_lo = std::max(row_last, tile_row_first - _tile_size + 1);
+      int r_hi = std::min(row_first, tile_row_first);
+
+      cv::Rect2i src_roi(c_lo - tile_col_first, tile_row_first - r_hi, c_hi - c_lo + 1, r_hi - r_lo + 1);
+      cv::Rect2i dst_roi(c_lo - col_first, row_first - r_hi, c_hi - c_lo + 1, r_hi - r_lo + 1);
+
+      for (auto &layer : layers_to_get)
+      {
+        if (layer.first >= static_cast<int>(tile.size()) || tile[layer.first].empty())
+          continue;
+        cv::Mat dst_data_roi = layer.second(dst_roi);
+        tile[layer.first](src_roi).copyTo(dst_data_roi);
+      }
+    }
+
+  for (const auto &layer : layers_to_get)
+    submap.add(_layers[layer.first].name, layer.second, _layers[layer.first].interpolation);
+  return submap;
+}
+
+CvGridMap CvGridMapTiled::toCvGridMap() const
+{
+  return getSubmap(getAllLayerNames());
+}
+
+double CvGridMapTiled::resolution() const
+{
+  return _resolution;
+}
+
+int CvGridMapTiled::tileSize() const
+{
+  return _tile_size;
+}
+
+size_t CvGridMapTiled::getNumberOfTiles() const
+{
+  return _tiles.size();
+}
+
+cv::Rect2d CvGridMapTiled::roi() const
+{
+  if (!_has_data)
+    return cv::Rect2d();
+  return cv::Rect2d(_col_min*_resolution,
+                    _row_min*_resolution,
+                    (_col_max - _col_min)*_resolution,
+                    (_row_max - _row_min)*_resolution);
+}
+
+void CvGridMapTiled::printInfo() const
+{
+  std::cout.precision(10);
+  std::cout << "##### CvGridMapTiled Debug Info #####" << std::endl;
+  std::cout << "Geometry:" << std::endl;
+  std::cout << "- Roi: " << roi() << std::endl;
+  std::cout << "- Tile size: " << _tile_size << "x" << _tile_size << std::endl;
+  std::cout << "- Tiles allocated: " << _tiles.size() << std::endl;
+  std::cout << "Layers:" << std::endl;
+  for (const auto &layer : _layers)
+    std::cout << "- ['" << layer.name << "']" << std::endl;
+}
+
+int CvGridMapTiled::findContainerIdx(const std::string &layer_name) const
+{
+  for (int i = 0; i < static_cast<int>(_layers.size()); ++i)
+    if (_layers[i].name == layer_name)
+      return i;
+  return -1;
+}
+
+cv::Mat CvGridMapTiled::createDefaultMat(const cv::Size2i &size, int type)
+{
+  switch(CV_MAT_DEPTH(type))
+  {
+    case CV_32F:
+      return cv::Mat(size, type, cv::Scalar::all(std::numeric_limits<float>::quiet_NaN()));
+    case CV_64F:
+      return cv::Mat(size, type, cv::Scalar::all(std::numeric_limits<double>::quiet_NaN()));
+    default:
+      return cv::Mat::zeros(size, type);
+  }
+}
+
+void CvGridMapTiled::computeGlobalIndex(const CvGridMap &map, int &col, int &row) const
+{
+  // Geometry of CvGridMaps is always fitted to multiples of the resolution, therefore the world position of the
+  // upper left element can be converted into an integer index without loss
+  cv::Rect2d roi = map.roi();
+  col = static_cast<int>(std::round(roi.x / _resolution));
+  row = static_cast<int>(std::round((roi.y + roi.height) / _resolution));
+}
+
+int CvGridMapTiled::floorDiv(int value, int divisor)
+{
+  int quotient = value / divisor;
+  if ((value % divisor != 0) && ((value < 0) != (divisor < 0)))
+    --quotient;
+  return quotient;
+}
+
+void CvGridMapTiled::mergeMatrices(const cv::Mat &from, cv::Mat &to, int flag_merge_handling)
+{
+  switch(flag_merge_handling)
+  {
+    case REALM_OVERWRITE_ALL:
+      from.copyTo(to);
+      break;
+    case REALM_OVERWRITE_ZERO:
+      cv::Mat mask;
+      if (to.type() == CV_32F || to.type() == CV_64F)
+        mask = (to != to) & (from == from);
+      else
+        mask = (to == 0) & (from > 0);
+      from.copyTo(to, mask);
+      break;
+  }
+}
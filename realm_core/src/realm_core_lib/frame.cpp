@@ -49,6 +49,7 @@ Frame::Frame(const std::string &camera_id,
       _med_scene_depth(0.0)
 {
   _camera_model->setPose(getDefaultPose());
+  _trace_context.t_acquisition = tracing::Tracer::now();
 }
 
 // GETTER
@@ -66,13 +67,13 @@ uint32_t Frame::getFrameId() const
 uint32_t Frame::getResizedImageWidth() const
 {
   assert(_is_img_resizing_set);
-  return (uint32_t)((double) _camera_model->width() * _img_resize_factor);
+  return (uint32_t)((double) _camera_model->width() * getImageResizeFactor());
 }
 
 uint32_t Frame::getResizedImageHeight() const
 {
   assert(_is_img_resizing_set);
-  return (uint32_t)((double) _camera_model->height() * _img_resize_factor);
+  return (uint32_t)((double) _camera_model->height() * getImageResizeFactor());
 }
 
 double Frame::getMinSceneDepth() const
@@ -96,19 +97,26 @@ double Frame::getMedianSceneDepth() const
 cv::Size Frame::getResizedImageSize() const
 {
   assert(_is_img_resizing_set);
-  auto width = (uint32_t)((double) _camera_model->width() * _img_resize_factor);
-  auto height = (uint32_t)((double) _camera_model->height() * _img_resize_factor);
+  return getResizedImageSize(getImageResizeFactor());
+}
+
+cv::Size Frame::getResizedImageSize(double factor) const
+{
+  auto width = (uint32_t)((double) _camera_model->width() * factor);
+  auto height = (uint32_t)((double) _camera_model->height() * factor);
   return cv::Size(width, height);
 }
 
+double Frame::getImageResizeFactor() const
+{
+  std::lock_guard<std::mutex> lock(_mutex_img_resized);
+  return _img_resize_factor;
+}
+
 cv::Mat Frame::getImageUndistorted() const
 {
-  cv::Mat img_undistorted;
-  if(_camera_model->hasDistortion())
-    img_undistorted = _camera_model->undistort(_img, CV_INTER_LINEAR);
-  else
-    img_undistorted = _img;
-  return std::move(img_undistorted);
+  // Full resolution is just another level of the pyramid
+  return getResizedImageUndistorted(1.0);
 }
 
 cv::Mat Frame::getImageRaw() const
@@ -149,35 +157,81 @@ cv::Mat Frame::getDefaultPose() const
 
 cv::Mat Frame::getResizedImageUndistorted() const
 {
-  // - Resized image will be calculated and set with first
-  // access to avoid multiple costly resizing procedures
-  // - Check also if resize factor has not changed in the
-  // meantime
+  assert(_is_img_resizing_set);
+  return getResizedImageUndistorted(getImageResizeFactor());
+}
+
+cv::Mat Frame::getResizedImageUndistorted(double factor) const
+{
+  // - Resized undistorted image will be calculated and set with first
+  // access to avoid multiple costly remapping procedures
+  // - Levels are never discarded by other scales, so consumers of different scales do not evict each other. Only
+  // releaseCache() drops them.
   // - No deep copy
+  std::lock_guard<std::mutex> lock(_mutex_pyramid);
+  PyramidLevel &level = getPyramidLevel(factor);
+  if (level.img_undistorted.empty())
+  {
+    if (_camera_model->hasDistortion())
+      level.img_undistorted = getPyramidCamera(level, factor)->undistort(level.img_raw, CV_INTER_LINEAR);
+    else
+      level.img_undistorted = level.img_raw;
+  }
+  return level.img_undistorted;
+}
+
+cv::Mat Frame::getResizedImageUndistortedGray() const
+{
   assert(_is_img_resizing_set);
-  camera::Pinhole cam_resized = _camera_model->resize(_img_resize_factor);
-  return cam_resized.undistort(_img_resized, CV_INTER_LINEAR);
+  return getResizedImageUndistortedGray(getImageResizeFactor());
+}
+
+cv::Mat Frame::getResizedImageUndistortedGray(double factor) const
+{
+  cv::Mat img = getResizedImageUndistorted(factor);
+
+  std::lock_guard<std::mutex> lock(_mutex_pyramid);
+  PyramidLevel &level = getPyramidLevel(factor);
+  if (level.img_undistorted_gray.empty())
+  {
+    if (img.channels() == 4)
+      cv::cvtColor(img, level.img_undistorted_gray, cv::COLOR_BGRA2GRAY);
+    else if (img.channels() == 3)
+      cv::cvtColor(img, level.img_undistorted_gray, cv::COLOR_BGR2GRAY);
+    else
+      level.img_undistorted_gray = img;
+  }
+  return level.img_undistorted_gray;
 }
 
 cv::Mat Frame::getResizedImageRaw() const
 {
-  // deep copy, as it might be painted or modified
   assert(_is_img_resizing_set);
-  return _img_resized.clone();
+  return getResizedImageRaw(getImageResizeFactor());
+}
+
+cv::Mat Frame::getResizedImageRaw(double factor) const
+{
+  // - No deep copy, callers that paint on the image must clone it
+  std::lock_guard<std::mutex> lock(_mutex_pyramid);
+  return getPyramidLevel(factor).img_raw;
 }
 
 cv::Mat Frame::getResizedCalibration() const
 {
   assert(_is_img_resizing_set);
-  return _camera_model->resize(_img_resize_factor).K();
+  return getResizedCalibration(getImageResizeFactor());
+}
+
+cv::Mat Frame::getResizedCalibration(double factor) const
+{
+  return getResizedCamera(factor)->K();
 }
 
 cv::Mat Frame::getSurfacePoints() const
 {
-  if (_surface_points.empty())
-    return cv::Mat();
-  else
-    return _surface_points.clone();
+  // - No deep copy, surface points are never modified inplace
+  return _surface_points;
 }
 
 cv::Mat Frame::getPose() const
@@ -218,6 +272,12 @@ SurfaceAssumption Frame::getSurfaceAssumption() const
   return _surface_assumption;
 }
 
+tracing::TraceContext Frame::getTraceContext() const
+{
+  std::lock_guard<std::mutex> lock(_mutex_trace_context);
+  return _trace_context;
+}
+
 CvGridMap::Ptr Frame::getObservedMap() const
 {
   assert(_observed_map != nullptr);
@@ -243,7 +303,16 @@ uint64_t Frame::getTimestamp() const
 camera::Pinhole::Ptr Frame::getResizedCamera() const
 {
   assert(_is_img_resizing_set);
-  return std::make_shared<camera::Pinhole>(_camera_model->resize(_img_resize_factor));
+  return getResizedCamera(getImageResizeFactor());
+}
+
+camera::Pinhole::Ptr Frame::getResizedCamera(double factor) const
+{
+  // - Resized model is computed with first access and reset, if the pose changes
+  // - Copy is returned, as the caller might modify it
+  std::lock_guard<std::mutex> lock(_mutex_pyramid);
+  PyramidLevel &level = getPyramidLevel(factor);
+  return std::make_shared<camera::Pinhole>(*getPyramidCamera(level, factor));
 }
 
 // SETTER
@@ -262,6 +331,7 @@ void Frame::setVisualPose(const cv::Mat &pose)
   {
     std::lock_guard<std::mutex> lock(_mutex_cam);
     _camera_model->setPose(pose);
+    invalidatePyramidCameras();
   }
 
   setPoseAccurate(true);
@@ -273,6 +343,7 @@ void Frame::setGeographicPose(const cv::Mat &pose)
   {
     std::lock_guard<std::mutex> lock(_mutex_cam);
     _camera_model->setPose(pose);
+    invalidatePyramidCameras();
     _motion_c2g = pose;
     setPoseAccurate(true);
   }
@@ -319,6 +390,18 @@ void Frame::setPoseAccurate(bool flag)
   _has_accurate_pose = flag;
 }
 
+void Frame::setTraceContext(const tracing::TraceContext &context)
+{
+  std::lock_guard<std::mutex> lock(_mutex_trace_context);
+  _trace_context = context;
+}
+
+void Frame::addTraceSpan(const tracing::Span &span)
+{
+  std::lock_guard<std::mutex> lock(_mutex_trace_context);
+  _trace_context.spans.push_back(span);
+}
+
 void Frame::setSurfaceAssumption(SurfaceAssumption assumption)
 {
   std::lock_guard<std::mutex> lock(_mutex_flags);
@@ -327,15 +410,21 @@ void Frame::setSurfaceAssumption(SurfaceAssumption assumption)
 
 void Frame::setImageResizeFactor(const double &value)
 {
+  // Only the default level is selected, images are computed lazily by the getters
   std::lock_guard<std::mutex> lock(_mutex_img_resized);
   _img_resize_factor = value;
-  cv::resize(_img, _img_resized, cv::Size(), _img_resize_factor, _img_resize_factor);
   _is_img_resizing_set = true;
 }
 
 
 // FUNCTIONALITY
 
+void Frame::releaseCache()
+{
+  std::lock_guard<std::mutex> lock(_mutex_pyramid);
+  _pyramid.clear();
+}
+
 void Frame::initGeoreference(const cv::Mat &T)
 {
   assert(!T.empty());
@@ -461,15 +550,18 @@ void Frame::applyTransformationToSurfacePoints(const cv::Mat &T)
 {
   if (_surface_points.rows > 0)
   {
+    // Surface points might be shared with previous getter calls, therefore the transformation is applied to a copy
     _mutex_surface_pts.lock();
-    for (uint32_t i = 0; i < _surface_points.rows; ++i)
+    cv::Mat surface_points = _surface_points.clone();
+    for (uint32_t i = 0; i < surface_points.rows; ++i)
     {
-      cv::Mat pt = _surface_points.row(i).colRange(0, 3).t();
+      cv::Mat pt = surface_points.row(i).colRange(0, 3).t();
       pt.push_back(1.0);
       cv::Mat pt_hom = T * pt;
       pt_hom.pop_back();
-      _surface_points.row(i) = pt_hom.t();
+      surface_points.row(i) = pt_hom.t();
     }
+    _surface_points = surface_points;
     _mutex_surface_pts.unlock();
   }
 }
@@ -529,4 +621,39 @@ cv::Mat Frame::computeGeoreferenceDifference(const cv::Mat &T_old, const cv::Mat
   return T_diff;
 }
 
+Frame::PyramidLevel& Frame::getPyramidLevel(double factor) const
+{
+  if (factor <= 0.0)
+    throw(std::invalid_argument("Error: Image resize factor must be positive!"));
+
+  PyramidLevel &level = _pyramid[factor];
+  if (level.img_raw.empty())
+  {
+    if (fabs(factor - 1.0) < std::numeric_limits<double>::epsilon())
+      level.img_raw = _img;
+    else
+      cv::resize(_img, level.img_raw, cv::Size(), factor, factor);
+  }
+  return level;
+}
+
+camera::Pinhole::Ptr Frame::getPyramidCamera(PyramidLevel &level, double factor) const
+{
+  if (level.camera == nullptr)
+  {
+    if (fabs(factor - 1.0) < std::numeric_limits<double>::epsilon())
+      level.camera = std::make_shared<camera::Pinhole>(*_camera_model);
+    else
+      level.camera = std::make_shared<camera::Pinhole>(_camera_model->resize(factor));
+  }
+  return level.camera;
+}
+
+void Frame::invalidatePyramidCameras()
+{
+  std::lock_guard<std::mutex> lock(_mutex_pyramid);
+  for (auto &level : _pyramid)
+    level.second.camera = nullptr;
+}
+
 } // namespace realm
\ No newline at end of file
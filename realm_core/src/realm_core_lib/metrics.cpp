@@ -0,0 +1,230 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <sstream>
+
+#include <realm_core/metrics.h>
+
+using namespace realm;
+
+constexpr int metrics::Histogram::kSubBuckets;
+constexpr int metrics::Histogram::kNumBuckets;
+
+metrics::Counter::Counter()
+: _value(0)
+{
+}
+
+void metrics::Counter::increment(uint64_t n)
+{
+  _value.fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t metrics::Counter::value() const
+{
+  return _value.load(std::memory_order_relaxed);
+}
+
+metrics::Gauge::Gauge()
+: _value(0)
+{
+}
+
+void metrics::Gauge::set(int64_t value)
+{
+  _value.store(value, std::memory_order_relaxed);
+}
+
+void metrics::Gauge::add(int64_t n)
+{
+  _value.fetch_add(n, std::memory_order_relaxed);
+}
+
+int64_t metrics::Gauge::value() const
+{
+  return _value.load(std::memory_order_relaxed);
+}
+
+metrics::Histogram::Histogram()
+: _count(0),
+  _sum_us(0),
+  _max_us(0)
+{
+  for (auto &bucket : _buckets)
+    bucket.store(0, std::memory_order_relaxed);
+}
+
+void metrics::Histogram::record(double ms)
+{
+  const uint64_t us = (ms > 0.0 ? static_cast<uint64_t>(ms*1000.0 + 0.5) : 0);
+
+  _buckets[toBucket(us)].fetch_add(1, std::memory_order_relaxed);
+  _count.fetch_add(1, std::memory_order_relaxed);
+  _sum_us.fetch_add(us, std::memory_order_relaxed);
+
+  uint64_t max_us = _max_us.load(std::memory_order_relaxed);
+  while (us > max_us && !_max_us.compare_exchange_weak(max_us, us, std::memory_order_relaxed))
+    ;
+}
+
+metrics::Histogram::Snapshot metrics::Histogram::snapshot() const
+{
+  Snapshot snapshot;
+  snapshot.count = _count.load(std::memory_order_relaxed);
+  snapshot.sum_ms = static_cast<double>(_sum_us.load(std::memory_order_relaxed)) / 1000.0;
+  snapshot.max_ms = static_cast<double>(_max_us.load(std::memory_order_relaxed)) / 1000.0;
+  snapshot.p50_ms = percentile(0.5);
+  snapshot.p95_ms = percentile(0.95);
+  snapshot.p99_ms = percentile(0.99);
+  return snapshot;
+}
+
+double metrics::Histogram::percentile(double p) const
+{
+  // Counts are copied first, so the rank and the bucket search are based on the same data
+  uint64_t counts[kNumBuckets];
+  uint64_t total = 0;
+  for (int i = 0; i < kNumBuckets; ++i)
+  {
+    counts[i] = _buckets[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0)
+    return 0.0;
+
+  p = std::min(std::max(p, 0.0), 1.0);
+  const auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p*static_cast<double>(total))));
+
+  const double max_us = static_cast<double>(_max_us.load(std::memory_order_relaxed));
+  uint64_t cumulated = 0;
+  for (int i = 0; i < kNumBuckets; ++i)
+  {
+    cumulated += counts[i];
+    if (cumulated >= rank)
+      return std::min(toUpperBound(i), max_us) / 1000.0;
+  }
+  return max_us / 1000.0;
+}
+
+void metrics::Histogram::reset()
+{
+  for (auto &bucket : _buckets)
+    bucket.store(0, std::memory_order_relaxed);
+  _count.store(0, std::memory_order_relaxed);
+  _sum_us.store(0, std::memory_order_relaxed);
+  _max_us.store(0, std::memory_order_relaxed);
+}
+
+int metrics::Histogram::toBucket(uint64_t us)
+{
+  if (us < 1)
+    return 0;
+  const auto bucket = 1 + static_cast<int>(std::log2(static_cast<double>(us))*kSubBuckets);
+  return std::min(bucket, kNumBuckets - 1);
+}
+
+double metrics::Histogram::toUpperBound(int bucket)
+{
+  if (bucket == 0)
+    return 1.0;
+  return std::exp2(static_cast<double>(bucket) / kSubBuckets);
+}
+
+metrics::Registry& metrics::Registry::instance()
+{
+  static Registry registry;
+  return registry;
+}
+
+metrics::Counter::Ptr metrics::Registry::counter(const std::string &name)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  Counter::Ptr &counter = _counters[name];
+  if (!counter)
+    counter = std::make_shared<Counter>();
+  return counter;
+}
+
+metrics::Gauge::Ptr metrics::Registry::gauge(const std::string &name)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  Gauge::Ptr &gauge = _gauges[name];
+  if (!gauge)
+    gauge = std::make_shared<Gauge>();
+  return gauge;
+}
+
+metrics::Histogram::Ptr metrics::Registry::histogram(const std::string &name)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  Histogram::Ptr &histogram = _histograms[name];
+  if (!histogram)
+    histogram = std::make_shared<Histogram>();
+  return histogram;
+}
+
+std::string metrics::Registry::toText()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  std::ostringstream text;
+  for (const auto &counter : _counters)
+  {
+    text << "# TYPE " << counter.first << " counter\n";
+    text << counter.first << " " << counter.second->value() << "\n";
+  }
+  for (const auto &gauge : _gauges)
+  {
+    text << "# TYPE " << gauge.first << " gauge\n";
+    text << gauge.first << " " << gauge.second->value() << "\n";
+  }
+  for (const auto &histogram : _histograms)
+  {
+    const std::string &name = histogram.first;
+    Histogram::Snapshot snapshot = histogram.second->snapshot();
+    text << "# TYPE " << name << " summary\n";
+    text << name << "{quantile=\"0.5\"} " << snapshot.p50_ms << "\n";
+    text << name << "{quantile=\"0.95\"} " << snapshot.p95_ms << "\n";
+    text << name << "{quantile=\"0.99\"} " << snapshot.p99_ms << "\n";
+    text << name << "_sum " << snapshot.sum_ms << "\n";
+    text << name << "_count " << snapshot.count << "\n";
+    text << "# TYPE " << name << "_max gauge\n";
+    text << name << "_max " << snapshot.max_ms << "\n";
+  }
+  return text.str();
+}
+
+std::string metrics::toMetricName(const std::string &name)
+{
+  std::string metric_name;
+  for (char c : name)
+  {
+    if (std::isalnum(static_cast<unsigned char>(c)))
+      metric_name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    else if (!metric_name.empty() && metric_name.back() != '_')
+      metric_name += '_';
+  }
+  if (!metric_name.empty() && metric_name.back() == '_')
+    metric_name.pop_back();
+  return metric_name;
+}
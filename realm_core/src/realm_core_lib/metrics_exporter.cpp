@@ -0,0 +1,162 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <realm_core/loguru.h>
+#include <realm_core/metrics_exporter.h>
+
+using namespace realm;
+
+metrics::Exporter::Exporter(Registry &registry)
+: _registry(registry),
+  _socket(-1),
+  _is_endpoint_running(false)
+{
+}
+
+metrics::Exporter::~Exporter()
+{
+  _timer_file_export = nullptr;
+
+  if (_is_endpoint_running)
+  {
+    _is_endpoint_running = false;
+    if (_thread_endpoint.joinable())
+      _thread_endpoint.join();
+    close(_socket);
+  }
+}
+
+void metrics::Exporter::startFileExport(const std::string &filename, int period)
+{
+  if (period <= 0)
+    throw(std::invalid_argument("Error: Period of metrics file export must be positive!"));
+
+  // Old timer must be stopped before the filename is changed
+  _timer_file_export = nullptr;
+  _filename = filename;
+  _timer_file_export = std::make_shared<Timer>(std::chrono::seconds(period), std::bind(&Exporter::writeFile, this));
+}
+
+bool metrics::Exporter::startEndpoint(int port)
+{
+  if (_is_endpoint_running)
+    return false;
+
+  _socket = socket(AF_INET, SOCK_STREAM, 0);
+  if (_socket < 0)
+  {
+    LOG_F(WARNING, "Metrics endpoint could not create socket.");
+    return false;
+  }
+
+  int reuse = 1;
+  setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(static_cast<uint16_t>(port));
+
+  if (bind(_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(_socket, 4) < 0)
+  {
+    LOG_F(WARNING, "Metrics endpoint could not listen on port %i.", port);
+    close(_socket);
+    _socket = -1;
+    return false;
+  }
+
+  LOG_F(INFO, "Metrics endpoint listening on 127.0.0.1:%i", port);
+  _is_endpoint_running = true;
+  _thread_endpoint = std::thread(std::bind(&Exporter::runEndpoint, this));
+  return true;
+}
+
+void metrics::Exporter::writeFile()
+{
+  if (_filename.empty())
+    return;
+
+  std::string filename_tmp = _filename + ".tmp";
+  {
+    std::ofstream file(filename_tmp, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+    {
+      LOG_F(WARNING, "Metrics could not be written to '%s'.", filename_tmp.c_str());
+      return;
+    }
+    file << _registry.toText();
+  }
+  std::rename(filename_tmp.c_str(), _filename.c_str());
+}
+
+void metrics::Exporter::runEndpoint()
+{
+  pollfd fd{};
+  fd.fd = _socket;
+  fd.events = POLLIN;
+
+  while (_is_endpoint_running)
+  {
+    if (poll(&fd, 1, 200) <= 0 || !(fd.revents & POLLIN))
+      continue;
+
+    int connection = accept(_socket, nullptr, nullptr);
+    if (connection < 0)
+      continue;
+    answer(connection);
+    close(connection);
+  }
+}
+
+void metrics::Exporter::answer(int connection)
+{
+  // Request is read briefly, but its content does not matter. Every request is answered with all metrics.
+  pollfd fd{};
+  fd.fd = connection;
+  fd.events = POLLIN;
+  char request[1024];
+  if (poll(&fd, 1, 100) > 0)
+    recv(connection, request, sizeof(request), 0);
+
+  std::string body = _registry.toText();
+  std::string response = "HTTP/1.0 200 OK\r\n"
+                         "Content-Type: text/plain; version=0.0.4\r\n"
+                         "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                         "Connection: close\r\n\r\n" + body;
+
+  size_t sent = 0;
+  while (sent < response.size())
+  {
+    ssize_t n = send(connection, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0)
+      break;
+    sent += static_cast<size_t>(n);
+  }
+}
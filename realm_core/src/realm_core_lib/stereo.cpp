@@ -18,11 +18,197 @@
 * along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include <opencv2/calib3d.hpp>
 #include <opencv2/imgproc/imgproc_c.h>
 
 #include <realm_core/stereo.h>
 
+namespace realm
+{
+namespace stereo
+{
+namespace internal
+{
+
+/*!
+ * @brief Row parallel sweep over a depth map, that computes the 3d world points and/or the surface normals in one go.
+ * Depth and output rows are accessed through raw row pointers, the inner loops are branch free.
+ * Normals are computed from the central differences of the depth with n = (-dz/dx, -dz/dy, 1) / |n|. Elements at the
+ * border of the depth map take the normal of their inner neighbour, which is the same as a reflected border.
+ */
+class DepthMapInvoker : public cv::ParallelLoopBody
+{
+  public:
+    DepthMapInvoker(const cv::Mat &depth, cv::Mat* img3d, cv::Mat* normals)
+    : _depth(depth),
+      _img3d(img3d),
+      _normals(normals),
+      _fx(0.0), _fy(0.0), _cx(0.0), _cy(0.0)
+    {
+    }
+
+    void setCamera(double fx, double fy, double cx, double cy, const cv::Mat &R_c2w, const cv::Mat &t_c2w)
+    {
+      _fx = fx;
+      _fy = fy;
+      _cx = cx;
+      _cy = cy;
+      for (int r = 0; r < 3; ++r)
+      {
+        for (int c = 0; c < 3; ++c)
+          _R[r][c] = R_c2w.at<double>(r, c);
+        _t[r] = t_c2w.at<double>(r);
+      }
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      const int cols = _depth.cols;
+      const int rows = _depth.rows;
+
+      for (int r = range.start; r < range.end; ++r)
+      {
+        const float* depth = _depth.ptr<float>(r);
+
+        if (_img3d != nullptr)
+        {
+          cv::Vec3d* pts = _img3d->ptr<cv::Vec3d>(r);
+          const double v_factor = (r - _cy) / _fy;
+          for (int c = 0; c < cols; ++c)
+          {
+            // Invalid depth results in a point at (0, 0, 0) as before
+            const double d = (depth[c] > 0.0f ? static_cast<double>(depth[c]) : 0.0);
+            const double valid = (depth[c] > 0.0f ? 1.0 : 0.0);
+            const double u = (c - _cx)*d/_fx;
+            const double v = v_factor*d;
+            pts[c][0] = (_R[0][0]*u + _R[0][1]*v + _R[0][2]*d + _t[0])*valid;
+            pts[c][1] = (_R[1][0]*u + _R[1][1]*v + _R[1][2]*d + _t[1])*valid;
+            pts[c][2] = (_R[2][0]*u + _R[2][1]*v + _R[2][2]*d + _t[2])*valid;
+          }
+        }
+
+        if (_normals != nullptr)
+        {
+          // Border rows take the normals of their inner neighbour row
+          const int rc = std::min(std::max(r, 1), rows - 2);
+          const float* depth_c = _depth.ptr<float>(rc);
+          const float* depth_u = _depth.ptr<float>(rc - 1);
+          const float* depth_d = _depth.ptr<float>(rc + 1);
+          cv::Vec3f* normals = _normals->ptr<cv::Vec3f>(r);
+          for (int c = 1; c < cols - 1; ++c)
+          {
+            const float dzdx = (depth_c[c+1] - depth_c[c-1])*0.5f;
+            const float dzdy = (depth_d[c] - depth_u[c])*0.5f;
+            const float inv_norm = 1.0f / std::sqrt(dzdx*dzdx + dzdy*dzdy + 1.0f);
+            normals[c] = cv::Vec3f(-dzdx*inv_norm, -dzdy*inv_norm, inv_norm);
+          }
+          normals[0] = normals[1];
+          normals[cols - 1] = normals[cols - 2];
+        }
+      }
+    }
+
+  private:
+    const cv::Mat &_depth;
+    cv::Mat* _img3d;
+    cv::Mat* _normals;
+
+    double _fx, _fy, _cx, _cy;
+    double _R[3][3];
+    double _t[3];
+};
+
+/*!
+ * @brief Pixel and depth of a projected point. Pixel is (-1, -1) if the point is behind the camera or outside the image.
+ */
+struct ProjectedPoint
+{
+    int u;
+    int v;
+    float depth;
+};
+
+/*!
+ * @brief Parallel projection of a point cloud into the image plane with x = P * X. Points are read through raw row
+ * pointers, every point writes only its own result, so no synchronisation is needed.
+ */
+class PointProjectionInvoker : public cv::ParallelLoopBody
+{
+  public:
+    PointProjectionInvoker(const camera::Pinhole::Ptr &cam, const cv::Mat &points, std::vector<ProjectedPoint> &projected)
+    : _points(points),
+      _projected(projected),
+      _width(static_cast<int>(cam->width())),
+      _height(static_cast<int>(cam->height()))
+    {
+      cv::Mat P = cam->P();
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 4; ++c)
+          _P[r][c] = P.at<double>(r, c);
+
+      // Depth is the z-coordinate in the camera frame
+      cv::Mat T_w2c = cam->Tw2c();
+      for (int c = 0; c < 4; ++c)
+        _T_z[c] = T_w2c.at<double>(2, c);
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      for (int i = range.start; i < range.end; ++i)
+      {
+        const double* X = _points.ptr<double>(i);
+        const double depth = _T_z[0]*X[0] + _T_z[1]*X[1] + _T_z[2]*X[2] + _T_z[3];
+        const double w = _P[2][0]*X[0] + _P[2][1]*X[1] + _P[2][2]*X[2] + _P[2][3];
+        const auto u = static_cast<int>((_P[0][0]*X[0] + _P[0][1]*X[1] + _P[0][2]*X[2] + _P[0][3])/w);
+        const auto v = static_cast<int>((_P[1][0]*X[0] + _P[1][1]*X[1] + _P[1][2]*X[2] + _P[1][3])/w);
+
+        ProjectedPoint &result = _projected[i];
+        if (depth > 0.0 && u >= 0 && u < _width && v >= 0 && v < _height)
+        {
+          result.u = u;
+          result.v = v;
+          result.depth = static_cast<float>(depth);
+        }
+        else
+        {
+          result.u = -1;
+          result.v = -1;
+          result.depth = -1.0f;
+        }
+      }
+    }
+
+  private:
+    const cv::Mat &_points;
+    std::vector<ProjectedPoint> &_projected;
+    int _width;
+    int _height;
+    double _P[3][4];
+    double _T_z[4];
+};
+
+} // namespace internal
+
+/*!
+ * @brief Allocates the normal map for a depth map
+ * @throws invalid_argument if the depth map is too small for the central differences or has the wrong type
+ */
+static void createNormalMap(const cv::Mat &depth, cv::Mat &normals)
+{
+  if (depth.type() != CV_32F)
+    throw(std::invalid_argument("Error: Computing normals failed. Depth map is expected to have type CV_32F."));
+  if (depth.rows < 3 || depth.cols < 3)
+    throw(std::invalid_argument("Error: Computing normals failed. Depth map must be at least 3x3."));
+  normals.create(depth.rows, depth.cols, CV_32FC3);
+}
+
+} // namespace stereo
+} // namespace realm
+
 void realm::stereo::computeRectification(const Frame::Ptr &frame_left,
                                          const Frame::Ptr &frame_right,
                                          cv::Mat &R1,
@@ -66,15 +252,26 @@ void realm::stereo::remap(const Frame::Ptr &frame,
   // remapping
   cv::Mat map11, map12;
   initUndistortRectifyMap(K, D, R, P, frame->getResizedImageSize(), CV_16SC2, map11, map12);
-  // Get image and convert to grayscale
-  cv::Mat img = frame->getResizedImageUndistorted();
-  cvtColor(img, img, CV_BGR2GRAY);
+  // Get memoized grayscale image
+  cv::Mat img = frame->getResizedImageUndistortedGray();
   // Compute remapping
   cv::remap(img, img_remapped, map11, map12, cv::INTER_LINEAR);
 }
 
 cv::Mat realm::stereo::reprojectDepthMap(const camera::Pinhole::Ptr &cam,
                                          const cv::Mat &depthmap)
+{
+  cv::Mat img3d;
+  cv::Mat normals;
+  reprojectDepthMap(cam, depthmap, img3d, normals, false);
+  return img3d;
+}
+
+void realm::stereo::reprojectDepthMap(const camera::Pinhole::Ptr &cam,
+                                      const cv::Mat &depthmap,
+                                      cv::Mat &img3d,
+                                      cv::Mat &normals,
+                                      bool compute_normals)
 {
   // Chosen formula for reprojection follows the linear projection model:
   // x = K*(R|t)*X
@@ -87,52 +284,35 @@ cv::Mat realm::stereo::reprojectDepthMap(const camera::Pinhole::Ptr &cam,
   if (depthmap.type() != CV_32F)
     throw(std::invalid_argument("Error: Reprojecting depth map failed. Matrix has wrong type. It is expected to have type CV_32F."));
 
-  // Implementation is chosen to be raw array, because it saves round about 30% computation time
   double fx = cam->fx();
   double fy = cam->fy();
   double cx = cam->cx();
   double cy = cam->cy();
-  cv::Mat R_c2w = cam->R();
-  cv::Mat t_c2w = cam->t();
 
   if (fabs(fx) < 10e-6 || fabs(fy) < 10-6 || fabs(cx) < 10e-6 || fabs(cy) < 10e-6)
     throw(std::invalid_argument("Error: Reprojecting depth map failed. Camera model invalid!"));
 
-  // Array preparation
-  double ar_R_c2w[3][3];
-  for (uint8_t r = 0; r < 3; ++r)
-    for (uint8_t c = 0; c < 3; ++c)
-      ar_R_c2w[r][c] = R_c2w.at<double>(r, c);
-
-  double ar_t_c2w[3];
-  for (uint8_t r = 0; r < 3; ++r)
-      ar_t_c2w[r] = t_c2w.at<double>(r);
-
-  // Iteration
-  cv::Mat img3d(depthmap.rows, depthmap.cols, CV_64FC3);
-  for (int r = 0; r < depthmap.rows; ++r)
-    for (int c = 0; c < depthmap.cols; ++c)
-    {
-      cv::Vec3d pt(0, 0, 0);
-
-      auto depth = static_cast<double>(depthmap.at<float>(r, c));
+  img3d.create(depthmap.rows, depthmap.cols, CV_64FC3);
+  if (compute_normals)
+    createNormalMap(depthmap, normals);
 
-      if (depth > 0)
-      {
-        // K^-1*(dc,dr,d)
-        double u = (c - cx)*depth/fx;
-        double v = (r - cy)*depth/fy;
-
-        pt[0] = ar_R_c2w[0][0]*u + ar_R_c2w[0][1]*v + ar_R_c2w[0][2]*depth + ar_t_c2w[0];
-        pt[1] = ar_R_c2w[1][0]*u + ar_R_c2w[1][1]*v + ar_R_c2w[1][2]*depth + ar_t_c2w[1];
-        pt[2] = ar_R_c2w[2][0]*u + ar_R_c2w[2][1]*v + ar_R_c2w[2][2]*depth + ar_t_c2w[2];
-      }
-      img3d.at<cv::Vec3d>(r, c) = pt;
-    }
-  return img3d;
+  internal::DepthMapInvoker invoker(depthmap, &img3d, (compute_normals ? &normals : nullptr));
+  invoker.setCamera(fx, fy, cx, cy, cam->R(), cam->t());
+  cv::parallel_for_(cv::Range(0, depthmap.rows), invoker);
 }
 
 cv::Mat realm::stereo::computeDepthMapFromPointCloud(const camera::Pinhole::Ptr &cam, const cv::Mat &points)
+{
+  cv::Mat depth_map;
+  cv::Mat index_map;
+  projectPointCloud(cam, points, depth_map, index_map);
+  return depth_map;
+}
+
+void realm::stereo::projectPointCloud(const camera::Pinhole::Ptr &cam,
+                                      const cv::Mat &points,
+                                      cv::Mat &depth_map,
+                                      cv::Mat &index_map)
 {
   /*
    * Depth computation according to [Hartley2004] "Multiple View Geometry in Computer Vision", S.162 for normalized
@@ -141,64 +321,42 @@ cv::Mat realm::stereo::computeDepthMapFromPointCloud(const camera::Pinhole::Ptr
 
   if (points.type() != CV_64F)
     throw(std::invalid_argument("Error: Computing depth map from point cloud failed. Point matrix type should be CV_64F!"));
-
-  // Prepare depthmap dimensions
-  uint32_t width = cam->width();
-  uint32_t height = cam->height();
+  if (!points.empty() && points.cols < 3)
+    throw(std::invalid_argument("Error: Computing depth map from point cloud failed. Points need x, y, z columns!"));
 
   // Prepare output data
-  cv::Mat depth_map = cv::Mat(height, width, CV_32F, -1.0);
-
-  // Prepare extrinsics
-  cv::Mat T_w2c = cam->Tw2c();
-  cv::Mat Rwc2 = T_w2c.row(2).colRange(0, 3).t();
-  double zwc = T_w2c.at<double>(2, 3);
+  depth_map.create(cam->height(), cam->width(), CV_32F);
+  depth_map.setTo(-1.0f);
+  index_map.create(cam->height(), cam->width(), CV_32S);
+  index_map.setTo(-1);
 
-  // Prepare projection
-  cv::Mat P_cv = cam->P();
-  double P[3][4]{P_cv.at<double>(0, 0), P_cv.at<double>(0, 1), P_cv.at<double>(0, 2), P_cv.at<double>(0, 3),
-                 P_cv.at<double>(1, 0), P_cv.at<double>(1, 1), P_cv.at<double>(1, 2), P_cv.at<double>(1, 3),
-                 P_cv.at<double>(2, 0), P_cv.at<double>(2, 1), P_cv.at<double>(2, 2), P_cv.at<double>(2, 3)};
+  // 1) Transform and project the whole cloud in one parallel pass
+  std::vector<internal::ProjectedPoint> projected((size_t)points.rows);
+  cv::parallel_for_(cv::Range(0, points.rows), internal::PointProjectionInvoker(cam, points, projected));
 
+  // 2) Scatter into the z-buffer. Closest point wins, which makes the result independent of the point order.
   for (int i = 0; i < points.rows; ++i)
   {
-    cv::Mat pt = points.row(i).t();
-
-    // Depth calculation
-    double depth = Rwc2.dot(pt) + zwc;
-
-    // Projection to image with x = P * X
-    double w = P[2][0]*pt.at<double>(0) + P[2][1]*pt.at<double>(1) + P[2][2]*pt.at<double>(2) + P[2][3]*1.0;
-    auto u = (int)((P[0][0]*pt.at<double>(0) + P[0][1]*pt.at<double>(1) + P[0][2]*pt.at<double>(2) + P[0][3]*1.0)/w);
-    auto v = (int)((P[1][0]*pt.at<double>(0) + P[1][1]*pt.at<double>(1) + P[1][2]*pt.at<double>(2) + P[1][3]*1.0)/w);
+    const internal::ProjectedPoint &pt = projected[i];
+    if (pt.u < 0)
+      continue;
 
-    if (u >= 0 && u < width && v >= 0 && v < height)
+    float* depth = &depth_map.ptr<float>(pt.v)[pt.u];
+    if (*depth < 0.0f || pt.depth < *depth)
     {
-      if (depth > 0)
-        depth_map.at<float>(v, u) = static_cast<float>(depth);
-      else
-        depth_map.at<float>(v, u) = -1.0f;
+      *depth = pt.depth;
+      index_map.ptr<int>(pt.v)[pt.u] = i;
     }
   }
-  //depth_map = cam.undistort(depth_map, CV_INTER_NN);
-  return depth_map;
 }
 
 cv::Mat realm::stereo::computeNormalsFromDepthMap(const cv::Mat& depth)
 {
-  // We have to shrink the normal mat by two, because otherwise we would run into border issues as the Kernel as size 3x3
-  cv::Mat normals(depth.rows-2, depth.cols-2, CV_32FC3);
-
-  for(int r = 1; r < depth.rows-1; ++r)
-    for(int c = 1; c < depth.cols-1; ++c)
-    {
-      float dzdx = (depth.at<float>(r, c+1) - depth.at<float>(r, c-1)) / 2.0f;
-      float dzdy = (depth.at<float>(r+1, c) - depth.at<float>(r-1, c)) / 2.0f;
+  cv::Mat normals;
+  createNormalMap(depth, normals);
 
-      cv::Vec3f d(-dzdx, -dzdy, 1.0f);
-      normals.at<cv::Vec3f>(r-1, c-1) = d / cv::norm(d);
-    }
-  cv::copyMakeBorder(normals, normals, 1, 1, 1, 1, cv::BORDER_REFLECT);
+  internal::DepthMapInvoker invoker(depth, nullptr, &normals);
+  cv::parallel_for_(cv::Range(0, depth.rows), invoker);
   return normals;
 }
 
@@ -0,0 +1,275 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#include <unistd.h>
+
+#include <realm_core/tracing.h>
+
+using namespace realm;
+
+constexpr size_t tracing::Tracer::kBufferSize;
+constexpr size_t tracing::Tracer::kMaxFrames;
+
+namespace
+{
+
+std::string escapeJson(const std::string &text)
+{
+  std::string escaped;
+  for (char c : text)
+  {
+    if (c == '"' || c == '\\')
+      escaped += '\\';
+    if (static_cast<unsigned char>(c) >= 0x20)
+      escaped += c;
+  }
+  return escaped;
+}
+
+bool isEarlier(const tracing::Span &lhs, const tracing::Span &rhs)
+{
+  if (lhs.t_start != rhs.t_start)
+    return lhs.t_start < rhs.t_start;
+  if (lhs.pid != rhs.pid)
+    return lhs.pid < rhs.pid;
+  if (lhs.tid != rhs.tid)
+    return lhs.tid < rhs.tid;
+  if (lhs.frame_id != rhs.frame_id)
+    return lhs.frame_id < rhs.frame_id;
+  return lhs.name < rhs.name;
+}
+
+bool isSame(const tracing::Span &lhs, const tracing::Span &rhs)
+{
+  return lhs.t_start == rhs.t_start && lhs.pid == rhs.pid && lhs.tid == rhs.tid && lhs.frame_id == rhs.frame_id
+         && lhs.name == rhs.name;
+}
+
+void writeEvent(std::ofstream &file, bool &is_first, const std::string &event)
+{
+  file << (is_first ? "\n" : ",\n") << event;
+  is_first = false;
+}
+
+} // namespace
+
+tracing::Tracer::Tracer()
+: _is_enabled(false)
+{
+}
+
+tracing::Tracer& tracing::Tracer::instance()
+{
+  static Tracer tracer;
+  return tracer;
+}
+
+int64_t tracing::Tracer::now()
+{
+  using namespace std::chrono;
+  return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+void tracing::Tracer::setEnabled(bool flag)
+{
+  _is_enabled.store(flag, std::memory_order_relaxed);
+}
+
+void tracing::Tracer::record(Span &span)
+{
+  if (!isEnabled())
+    return;
+
+  ThreadBuffer* buffer = getThreadBuffer();
+  span.pid = static_cast<uint32_t>(getpid());
+  span.tid = buffer->tid;
+
+  // Only the owning thread writes, the lock is uncontended except while collecting
+  std::unique_lock<std::mutex> lock(buffer->mutex);
+  if (buffer->spans.size() < kBufferSize)
+    buffer->spans.push_back(span);
+  else
+    buffer->spans[buffer->next] = span;
+  buffer->next = (buffer->next + 1) % kBufferSize;
+}
+
+void tracing::Tracer::recordFrame(uint32_t frame_id, const TraceContext &context)
+{
+  if (!isEnabled())
+    return;
+
+  std::unique_lock<std::mutex> lock(_mutex_frames);
+  auto it = _frames.find(frame_id);
+  if (it == _frames.end())
+  {
+    _frame_order.push_back(frame_id);
+    if (_frame_order.size() > kMaxFrames)
+    {
+      _frames.erase(_frame_order.front());
+      _frame_order.pop_front();
+    }
+  }
+  _frames[frame_id] = context;
+}
+
+std::vector<tracing::Span> tracing::Tracer::collect()
+{
+  std::vector<Span> spans;
+  {
+    std::unique_lock<std::mutex> lock(_mutex_buffers);
+    for (const auto &buffer : _buffers)
+    {
+      std::unique_lock<std::mutex> lock_buffer(buffer->mutex);
+      spans.insert(spans.end(), buffer->spans.begin(), buffer->spans.end());
+    }
+  }
+  {
+    std::unique_lock<std::mutex> lock(_mutex_frames);
+    for (const auto &frame : _frames)
+      spans.insert(spans.end(), frame.second.spans.begin(), frame.second.spans.end());
+  }
+
+  // Spans of the own process are contained in the thread buffers and the frame contexts
+  std::sort(spans.begin(), spans.end(), isEarlier);
+  spans.erase(std::unique(spans.begin(), spans.end(), isSame), spans.end());
+  return spans;
+}
+
+void tracing::Tracer::clear()
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex_buffers);
+    for (const auto &buffer : _buffers)
+    {
+      std::unique_lock<std::mutex> lock_buffer(buffer->mutex);
+      buffer->spans.clear();
+      buffer->next = 0;
+    }
+  }
+  std::unique_lock<std::mutex> lock(_mutex_frames);
+  _frames.clear();
+  _frame_order.clear();
+}
+
+bool tracing::Tracer::writeChromeTrace(const std::string &filename)
+{
+  std::vector<Span> spans = collect();
+
+  std::map<uint32_t, TraceContext> frames;
+  {
+    std::unique_lock<std::mutex> lock(_mutex_frames);
+    frames = _frames;
+  }
+
+  std::ofstream file(filename, std::ios::out | std::ios::trunc);
+  if (!file.is_open())
+    return false;
+
+  bool is_first = true;
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  // Work of all threads as complete events
+  std::map<uint32_t, std::vector<const Span*>> spans_per_frame;
+  for (const auto &span : spans)
+  {
+    writeEvent(file, is_first, "{\"name\":\"" + escapeJson(span.name) + "\",\"cat\":\"realm\",\"ph\":\"X\""
+                               ",\"ts\":" + std::to_string(span.t_start)
+                               + ",\"dur\":" + std::to_string(std::max<int64_t>(span.t_end - span.t_start, 0))
+                               + ",\"pid\":" + std::to_string(span.pid) + ",\"tid\":" + std::to_string(span.tid)
+                               + ",\"args\":{\"frame_id\":" + std::to_string(span.frame_id) + "}}");
+    spans_per_frame[span.frame_id].push_back(&span);
+  }
+
+  // Path of every frame through the stages as flow events, bound to the spans they start in
+  for (const auto &frame : spans_per_frame)
+  {
+    const std::vector<const Span*> &path = frame.second;
+    if (path.size() < 2)
+      continue;
+    for (size_t i = 0; i < path.size(); ++i)
+    {
+      std::string phase = (i == 0 ? "s" : (i + 1 == path.size() ? "f\",\"bp\":\"e" : "t"));
+      writeEvent(file, is_first, "{\"name\":\"frame\",\"cat\":\"frame\",\"ph\":\"" + phase + "\""
+                                 ",\"id\":" + std::to_string(frame.first)
+                                 + ",\"ts\":" + std::to_string(path[i]->t_start)
+                                 + ",\"pid\":" + std::to_string(path[i]->pid)
+                                 + ",\"tid\":" + std::to_string(path[i]->tid) + "}");
+    }
+  }
+
+  // Overall latency of every frame from acquisition until its last span as async events in a separate track
+  writeEvent(file, is_first, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Frames\"}}");
+  for (const auto &frame : frames)
+  {
+    const TraceContext &context = frame.second;
+    if (context.spans.empty())
+      continue;
+
+    int64_t t_end = context.t_acquisition;
+    for (const auto &span : context.spans)
+      t_end = std::max(t_end, span.t_end);
+
+    std::string common = "{\"name\":\"frame #" + std::to_string(frame.first) + "\",\"cat\":\"frame\""
+                         ",\"id\":" + std::to_string(frame.first) + ",\"pid\":0,\"tid\":0";
+    writeEvent(file, is_first, common + ",\"ph\":\"b\",\"ts\":" + std::to_string(context.t_acquisition) + "}");
+    writeEvent(file, is_first, common + ",\"ph\":\"e\",\"ts\":" + std::to_string(t_end) + "}");
+  }
+
+  file << "\n]}\n";
+  return file.good();
+}
+
+tracing::Tracer::ThreadBuffer* tracing::Tracer::getThreadBuffer()
+{
+  static thread_local ThreadBuffer* buffer = nullptr;
+  if (buffer)
+    return buffer;
+
+  std::unique_lock<std::mutex> lock(_mutex_buffers);
+  auto buffer_new = std::make_shared<ThreadBuffer>();
+  buffer_new->next = 0;
+  buffer_new->tid = static_cast<uint32_t>(_buffers.size() + 1);
+  buffer_new->spans.reserve(kBufferSize);
+  _buffers.push_back(buffer_new);
+  buffer = buffer_new.get();
+  return buffer;
+}
+
+tracing::ScopedSpan::ScopedSpan(const std::string &name, uint32_t frame_id)
+: _is_active(Tracer::instance().isEnabled())
+{
+  if (!_is_active)
+    return;
+  _span.name = name;
+  _span.frame_id = frame_id;
+  _span.t_start = Tracer::now();
+}
+
+tracing::ScopedSpan::~ScopedSpan()
+{
+  if (!_is_active)
+    return;
+  _span.t_end = Tracer::now();
+  Tracer::instance().record(_span);
+}
@@ -0,0 +1,114 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cassert>
+#include <stdexcept>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <realm_core/undistortion_map_cache.h>
+
+namespace realm
+{
+namespace camera
+{
+
+std::mutex UndistortionMapCache::_mutex;
+std::map<UndistortionMapCache::Key, UndistortionMapCache::Entry> UndistortionMapCache::_entries;
+size_t UndistortionMapCache::_capacity = 8;
+uint64_t UndistortionMapCache::_access_counter = 0;
+
+void UndistortionMapCache::get(const cv::Mat &K, const cv::Mat &dist_coeffs, const cv::Size &size, cv::Mat &map1, cv::Mat &map2)
+{
+  Key key = createKey(K, dist_coeffs, size);
+
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    auto it = _entries.find(key);
+    if (it != _entries.end())
+    {
+      it->second.last_access = ++_access_counter;
+      map1 = it->second.map1;
+      map2 = it->second.map2;
+      return;
+    }
+  }
+
+  // Computation is done without lock, so other cameras are not blocked. In the rare case of two threads computing the
+  // same maps, the first one inserted is kept.
+  cv::Mat map1_new, map2_new;
+  cv::initUndistortRectifyMap(K, dist_coeffs, cv::Mat_<double>::eye(3, 3), K, size, CV_16SC2, map1_new, map2_new);
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  auto it = _entries.insert({key, Entry{map1_new, map2_new, 0}}).first;
+  it->second.last_access = ++_access_counter;
+  map1 = it->second.map1;
+  map2 = it->second.map2;
+  shrinkToCapacity();
+}
+
+void UndistortionMapCache::setCapacity(size_t capacity)
+{
+  if (capacity == 0)
+    throw(std::invalid_argument("Error: Capacity of undistortion map cache must be positive!"));
+  std::unique_lock<std::mutex> lock(_mutex);
+  _capacity = capacity;
+  shrinkToCapacity();
+}
+
+size_t UndistortionMapCache::size()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+void UndistortionMapCache::clear()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _entries.clear();
+}
+
+UndistortionMapCache::Key UndistortionMapCache::createKey(const cv::Mat &K, const cv::Mat &dist_coeffs, const cv::Size &size)
+{
+  assert(!K.empty() && K.type() == CV_64F);
+  assert(dist_coeffs.empty() || dist_coeffs.type() == CV_64F);
+
+  Key key{K.at<double>(0, 0), K.at<double>(1, 1), K.at<double>(0, 1), K.at<double>(0, 2), K.at<double>(1, 2)};
+  for (int i = 0; i < static_cast<int>(dist_coeffs.total()); ++i)
+    key.push_back(dist_coeffs.at<double>(i));
+  key.push_back(size.width);
+  key.push_back(size.height);
+  return key;
+}
+
+void UndistortionMapCache::shrinkToCapacity()
+{
+  while (_entries.size() > _capacity)
+  {
+    auto it_oldest = _entries.begin();
+    for (auto it = _entries.begin(); it != _entries.end(); ++it)
+      if (it->second.last_access < it_oldest->second.last_access)
+        it_oldest = it;
+    _entries.erase(it_oldest);
+  }
+}
+
+} // namespace camera
+} // namespace realm
@@ -34,8 +34,16 @@ WorkerThreadBase::WorkerThreadBase(const std::string &thread_name, int64_t sleep
   _reset_requested(false),
   _stop_requested(false),
   _is_stopped(false),
-  _verbose(verbose)
+  _is_event_driven(false),
+  _has_notification(false),
+  _is_idle(false),
+  _nrof_notifications(0),
+  _verbose(verbose),
+  _metrics_prefix("realm_" + metrics::toMetricName(thread_name) + "_")
 {
+  _metric_process_calls = metrics::Registry::instance().counter(_metrics_prefix + "process_calls");
+  _metric_process_time = metrics::Registry::instance().histogram(_metrics_prefix + "process_ms");
+
   if (_sleep_time == 0)
     throw(std::runtime_error("Error: Worker thread was created with 0s sleep time."));
 }
@@ -68,7 +76,7 @@ void WorkerThreadBase::run()
           reset();
           LOG_IF_F(INFO, _verbose, "Thread '%s' reseted!", _thread_name.c_str());
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(_sleep_time));
+        waitForWork();
       }
       LOG_IF_F(INFO, _verbose, "Thread '%s' resumed to loop!", _thread_name.c_str());
     }
@@ -82,8 +90,14 @@ void WorkerThreadBase::run()
 
     // Calls to derived classes implementation of process()
     long t = getCurrentTimeMilliseconds();
-    if (process())
+    auto t_process = std::chrono::steady_clock::now();
+    uint64_t nrof_notifications = getNumberOfNotifications();
+    bool has_processed = process();
+    updateIdleState(has_processed, nrof_notifications);
+    if (has_processed)
     {
+      _metric_process_calls->increment();
+      _metric_process_time->record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_process).count());
       LOG_IF_F(INFO,
                _verbose,
                "Thread '%s' has processed data. Time elapsed: %4.2f [s]",
@@ -91,38 +105,105 @@ void WorkerThreadBase::run()
                static_cast<double>(getCurrentTimeMilliseconds() - t) / 1000);
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(_sleep_time));
+    // In event driven mode there might be more work pending, so only idle if the last call did nothing
+    if (!_is_event_driven || !has_processed)
+      waitForWork();
   }
   LOG_IF_F(INFO, _verbose, "Thread '%s' finished!", _thread_name.c_str());
 }
 
 void WorkerThreadBase::resume()
 {
-  std::unique_lock<std::mutex> lock(_mutex_is_stopped);
-  if (_is_stopped)
-    _is_stopped = false;
+  {
+    std::unique_lock<std::mutex> lock(_mutex_is_stopped);
+    if (_is_stopped)
+      _is_stopped = false;
+  }
+  notifyWorkAvailable();
 }
 
 void WorkerThreadBase::requestStop()
 {
-  std::unique_lock<std::mutex> lock(_mutex_stop_requested);
-  _stop_requested = true;
-  LOG_IF_F(INFO, _verbose, "Thread '%s' received stop request...", _thread_name.c_str());
+  {
+    std::unique_lock<std::mutex> lock(_mutex_stop_requested);
+    _stop_requested = true;
+    LOG_IF_F(INFO, _verbose, "Thread '%s' received stop request...", _thread_name.c_str());
+  }
+  notifyWorkAvailable();
 }
 
 void WorkerThreadBase::requestReset()
 {
-  std::unique_lock<std::mutex> lock(_mutex_reset_requested);
-  _reset_requested = true;
-  LOG_IF_F(INFO, _verbose, "Thread '%s' received reset request...", _thread_name.c_str());
+  {
+    std::unique_lock<std::mutex> lock(_mutex_reset_requested);
+    _reset_requested = true;
+    LOG_IF_F(INFO, _verbose, "Thread '%s' received reset request...", _thread_name.c_str());
+  }
+  notifyWorkAvailable();
 }
 
 void WorkerThreadBase::requestFinish()
 {
-  std::unique_lock<std::mutex> lock(_mutex_finish_requested);
-  _finish_requested = true;
-  LOG_IF_F(INFO, _verbose, "Thread '%s' received finish request...", _thread_name.c_str());
-  finishCallback();
+  {
+    std::unique_lock<std::mutex> lock(_mutex_finish_requested);
+    _finish_requested = true;
+    LOG_IF_F(INFO, _verbose, "Thread '%s' received finish request...", _thread_name.c_str());
+    finishCallback();
+  }
+  notifyWorkAvailable();
+}
+
+void WorkerThreadBase::setEventDriven(bool flag)
+{
+  std::unique_lock<std::mutex> lock(_mutex_notification);
+  _is_event_driven = flag;
+}
+
+bool WorkerThreadBase::isIdle()
+{
+  std::unique_lock<std::mutex> lock(_mutex_notification);
+  return _is_idle;
+}
+
+void WorkerThreadBase::notifyWorkAvailable()
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex_notification);
+    _nrof_notifications++;
+    _is_idle = false;
+    if (!_is_event_driven)
+      return;
+    _has_notification = true;
+  }
+  _condition_notification.notify_one();
+}
+
+uint64_t WorkerThreadBase::getNumberOfNotifications()
+{
+  std::unique_lock<std::mutex> lock(_mutex_notification);
+  return _nrof_notifications;
+}
+
+void WorkerThreadBase::updateIdleState(bool has_processed, uint64_t nrof_notifications)
+{
+  // Work notified during process() might not have been seen by it, so the thread is only idle if nothing happened
+  std::unique_lock<std::mutex> lock(_mutex_notification);
+  _is_idle = (!has_processed && nrof_notifications == _nrof_notifications);
+}
+
+void WorkerThreadBase::waitForWork()
+{
+  std::unique_lock<std::mutex> lock(_mutex_notification);
+  if (!_is_event_driven)
+  {
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(_sleep_time));
+    return;
+  }
+
+  // Notifications received while processing are not lost, because the flag is only cleared here
+  _condition_notification.wait_for(lock, std::chrono::milliseconds(_sleep_time), [this](){ return _has_notification; });
+  _has_notification = false;
 }
 
 bool WorkerThreadBase::isStopRequested()
@@ -273,4 +273,106 @@ TEST(CvGridMap, Overlap)
   EXPECT_DOUBLE_EQ(roi1.height, roi2.height);
   EXPECT_DOUBLE_EQ(size1.width, size2.width);
   EXPECT_DOUBLE_EQ(size1.height, size2.height);
-}
\ No newline at end of file
+}
+
+TEST(CvGridMap, OverlapView)
+{
+  // Overlaps can also be extracted without copying the data. In that case the returned maps reference the data of
+  // the original maps, so writing into the overlap must change the original maps.
+  CvGridMap map1(cv::Rect2d(0, 0, 20, 30), 1.0);
+  map1.add("layer_double", cv::Mat(map1.size(), CV_64F, 3.1415));
+
+  CvGridMap map2(cv::Rect2d(10, 15, 20, 30), 1.0);
+  map2.add("layer_double", cv::Mat(map2.size(), CV_64F, 6.1415));
+
+  CvGridMap::Overlap overlap_copy = map1.getOverlap(map2);
+  (*overlap_copy.first)["layer_double"].setTo(1.0);
+
+  EXPECT_DOUBLE_EQ(map1["layer_double"].at<double>(0, 20), 3.1415);
+
+  CvGridMap::Overlap overlap_view = map1.getOverlap(map2, false);
+  (*overlap_view.first)["layer_double"].setTo(1.0);
+  (*overlap_view.second)["layer_double"].setTo(2.0);
+
+  // Upper right corner of map1 is inside the overlap, lower left corner is not
+  EXPECT_DOUBLE_EQ(map1["layer_double"].at<double>(0, 20), 1.0);
+  EXPECT_DOUBLE_EQ(map1["layer_double"].at<double>(30, 0), 3.1415);
+
+  // Lower left corner of map2 is inside the overlap, upper right corner is not
+  EXPECT_DOUBLE_EQ(map2["layer_double"].at<double>(30, 0), 2.0);
+  EXPECT_DOUBLE_EQ(map2["layer_double"].at<double>(0, 20), 6.1415);
+}
+
+TEST(CvGridMap, SubmapView)
+{
+  // Same as for the overlap, submaps of a region of interest can be extracted as view. Also only the requested layers
+  // should be part of the submap.
+  CvGridMap map(cv::Rect2d(0, 0, 20, 30), 1.0);
+  map.add("layer_double", cv::Mat(map.size(), CV_64F, 3.1415));
+  map.add("layer_char", cv::Mat(map.size(), CV_8UC1, 125));
+
+  CvGridMap submap = map.getSubmap({"layer_char"}, cv::Rect2d(5, 5, 10, 10), false);
+
+  EXPECT_FALSE(submap.exists("layer_double"));
+  EXPECT_EQ(submap.size().width, 11);
+  EXPECT_EQ(submap.size().height, 11);
+
+  submap["layer_char"].setTo(250);
+  cv::Point2i idx = map.atIndex(cv::Point2d(10.0, 10.0));
+  EXPECT_EQ(map["layer_char"].at<uchar>(idx), 250);
+  EXPECT_EQ(map["layer_char"].at<uchar>(0, 0), 125);
+
+  EXPECT_THROW(map.getSubmap({"layer_char"}, cv::Rect2d(100, 100, 10, 10)), std::out_of_range);
+}
+
+TEST(CvGridMap, LayerHandle)
+{
+  // Layer handles are resolved once by name and then give direct typed access to the layer data. Writes through the
+  // handle must be visible in the map, resolving a handle with the wrong type or for a non existing layer must throw.
+  CvGridMap map(cv::Rect2d(0, 0, 20, 30), 1.0);
+  map.add("layer_float", cv::Mat(map.size(), CV_32F, 3.1415f));
+  map.add("layer_rgb", cv::Mat(map.size(), CV_8UC4, cv::Scalar(1, 2, 3, 4)));
+
+  LayerHandle<float> handle_float = map.getHandle<float>("layer_float");
+  LayerHandle<cv::Vec4b> handle_rgb = map.getHandle<cv::Vec4b>("layer_rgb");
+
+  EXPECT_EQ(handle_float.rows(), map.size().height);
+  EXPECT_EQ(handle_float.cols(), map.size().width);
+  EXPECT_FLOAT_EQ(handle_float(5, 7), 3.1415f);
+  EXPECT_EQ(handle_rgb(5, 7)[2], 3);
+
+  handle_float(5, 7) = 1.0f;
+  handle_rgb.ptr(6)[8] = cv::Vec4b(9, 9, 9, 9);
+  EXPECT_FLOAT_EQ(map["layer_float"].at<float>(5, 7), 1.0f);
+  EXPECT_EQ(map["layer_rgb"].at<cv::Vec4b>(6, 8)[0], 9);
+
+  // Handles of a const map are read only, but share the same data
+  const CvGridMap &map_const = map;
+  LayerHandle<const float> handle_const = map_const.getHandle<float>("layer_float");
+  EXPECT_FLOAT_EQ(handle_const(5, 7), 1.0f);
+
+  EXPECT_THROW(map.getHandle<double>("layer_float"), std::invalid_argument);
+  EXPECT_THROW(map.getHandle<float>("layer_unknown"), std::out_of_range);
+}
+
+TEST(CvGridMap, LayerLookup)
+{
+  // Layers are looked up by name through a hash table. Replacing data of an existing layer must not create a new layer
+  // and the lookup must stay valid for copies of the map.
+  CvGridMap map(cv::Rect2d(0, 0, 20, 30), 1.0);
+  map.add("layer_a", cv::Mat(map.size(), CV_32F, 1.0f));
+  map.add("layer_b", cv::Mat(map.size(), CV_32F, 2.0f));
+  map.add("layer_a", cv::Mat(map.size(), CV_32F, 3.0f));
+
+  EXPECT_EQ(map.getAllLayerNames().size(), 2u);
+  EXPECT_TRUE(map.exists("layer_a"));
+  EXPECT_FALSE(map.exists("layer_c"));
+  EXPECT_FLOAT_EQ(map["layer_a"].at<float>(0, 0), 3.0f);
+
+  CvGridMap map_copy = map;
+  map_copy.add("layer_c", cv::Mat(map.size(), CV_32F, 4.0f));
+  EXPECT_FLOAT_EQ(map_copy["layer_b"].at<float>(0, 0), 2.0f);
+  EXPECT_FLOAT_EQ(map_copy["layer_c"].at<float>(0, 0), 4.0f);
+  EXPECT_FALSE(map.exists("layer_c"));
+  EXPECT_THROW(map["layer_c"], std::out_of_range);
+}
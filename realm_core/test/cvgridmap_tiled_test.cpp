@@ -0,0 +1,119 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <realm_core/cv_grid_map.h>
+#include <realm_core/cv_grid_map_tiled.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+TEST(CvGridMapTiled, LazyTileAllocation)
+{
+  // A sparse, L-shaped survey should only allocate the tiles that were actually touched by the submaps, not the whole
+  // bounding box. With a tile size of 10 cells and a resolution of 1.0 every 10x10 m^2 patch is one tile.
+  CvGridMapTiled map(1.0, 10);
+  EXPECT_TRUE(map.empty());
+
+  CvGridMap submap1(cv::Rect2d(0, 0, 9, 9), 1.0);
+  submap1.add("layer_float", cv::Mat(submap1.size(), CV_32F, 1.0f));
+  map.add(submap1, REALM_OVERWRITE_ALL);
+  EXPECT_EQ(map.getNumberOfTiles(), 1u);
+
+  CvGridMap submap2(cv::Rect2d(90, 0, 9, 9), 1.0);
+  submap2.add("layer_float", cv::Mat(submap2.size(), CV_32F, 2.0f));
+  map.add(submap2, REALM_OVERWRITE_ALL);
+  EXPECT_EQ(map.getNumberOfTiles(), 2u);
+
+  CvGridMap submap3(cv::Rect2d(90, 90, 9, 9), 1.0);
+  submap3.add("layer_float", cv::Mat(submap3.size(), CV_32F, 3.0f));
+  map.add(submap3, REALM_OVERWRITE_ALL);
+  EXPECT_EQ(map.getNumberOfTiles(), 3u);
+
+  // Bounding box of all data is still reported correctly
+  EXPECT_DOUBLE_EQ(map.roi().x, 0.0);
+  EXPECT_DOUBLE_EQ(map.roi().y, 0.0);
+  EXPECT_DOUBLE_EQ(map.roi().width, 99.0);
+  EXPECT_DOUBLE_EQ(map.roi().height, 99.0);
+}
+
+TEST(CvGridMapTiled, AddAcrossTileBorders)
+{
+  // Adding a submap across tile borders must result in the same data as the dense CvGridMap. We therefore compare the
+  // result of the tiled map with the dense map for both overlap handles.
+  CvGridMap map_dense(cv::Rect2d(3, 7, 20, 28), 1.0);
+  map_dense.add("layer_float", cv::Mat(map_dense.size(), CV_32F, std::numeric_limits<float>::quiet_NaN()));
+  map_dense.add("layer_char", cv::Mat(map_dense.size(), CV_8UC1, cv::Scalar(0)));
+  map_dense["layer_float"](cv::Rect2i(0, 0, 10, 10)).setTo(1.0f);
+  map_dense["layer_char"](cv::Rect2i(0, 0, 10, 10)).setTo(100);
+
+  CvGridMapTiled map_tiled(1.0, 8);
+  map_tiled.add(map_dense, REALM_OVERWRITE_ALL);
+
+  CvGridMap submap(cv::Rect2d(8, 12, 10, 14), 1.0);
+  submap.add("layer_float", cv::Mat(submap.size(), CV_32F, 2.0f));
+  submap.add("layer_char", cv::Mat(submap.size(), CV_8UC1, 200));
+
+  map_dense.add(submap, REALM_OVERWRITE_ZERO, false);
+  map_tiled.add(submap, REALM_OVERWRITE_ZERO);
+
+  CvGridMap map_result = map_tiled.getSubmap({"layer_float", "layer_char"}, map_dense.roi());
+  ASSERT_EQ(map_result.size().width, map_dense.size().width);
+  ASSERT_EQ(map_result.size().height, map_dense.size().height);
+
+  cv::Mat float_dense = map_dense["layer_float"];
+  cv::Mat float_tiled = map_result["layer_float"];
+  cv::Mat char_dense = map_dense["layer_char"];
+  cv::Mat char_tiled = map_result["layer_char"];
+  for (int r = 0; r < float_dense.rows; ++r)
+    for (int c = 0; c < float_dense.cols; ++c)
+    {
+      if (std::isnan(float_dense.at<float>(r, c)))
+        EXPECT_TRUE(std::isnan(float_tiled.at<float>(r, c)));
+      else
+        EXPECT_FLOAT_EQ(float_tiled.at<float>(r, c), float_dense.at<float>(r, c));
+      EXPECT_EQ(char_tiled.at<uchar>(r, c), char_dense.at<uchar>(r, c));
+    }
+}
+
+TEST(CvGridMapTiled, GetSubmapDefaults)
+{
+  // Regions not covered by any tile are expected to be filled with the same default values as CvGridMap layers, which
+  // is NaN for floating point and zero for all other types.
+  CvGridMapTiled map(0.5, 16);
+
+  CvGridMap submap(cv::Rect2d(100, 200, 5, 5), 0.5);
+  submap.add("layer_double", cv::Mat(submap.size(), CV_64F, 3.1415));
+  submap.add("layer_char", cv::Mat(submap.size(), CV_8UC1, 125));
+  map.add(submap, REALM_OVERWRITE_ALL);
+
+  CvGridMap result = map.getSubmap({"layer_double", "layer_char"}, cv::Rect2d(90, 190, 30, 30));
+  cv::Point2i idx_inside = result.atIndex(cv::Point2d(102.0, 202.0));
+  cv::Point2i idx_outside = result.atIndex(cv::Point2d(92.0, 192.0));
+
+  EXPECT_DOUBLE_EQ(result["layer_double"].at<double>(idx_inside), 3.1415);
+  EXPECT_EQ(result["layer_char"].at<uchar>(idx_inside), 125);
+  EXPECT_TRUE(std::isnan(result["layer_double"].at<double>(idx_outside)));
+  EXPECT_EQ(result["layer_char"].at<uchar>(idx_outside), 0);
+
+  EXPECT_THROW(map.getSubmap({"layer_unknown"}, cv::Rect2d(90, 190, 30, 30)), std::out_of_range);
+}
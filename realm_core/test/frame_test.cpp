@@ -181,4 +181,87 @@ TEST(Frame, UpdateGeoreference)
   EXPECT_NEAR(frame->getMinSceneDepth(), 50, 10e-3);
   EXPECT_NEAR(frame->getMaxSceneDepth(), 200, 10e-3);
   EXPECT_NEAR(frame->getMedianSceneDepth(), 100, 10e-3);
-}
\ No newline at end of file
+}
+
+TEST(Frame, MemoizedDerivatives)
+{
+  // Derived images are computed once and shared afterwards. Changing the resize factor must invalidate them.
+  Frame::Ptr frame = createDummyFrame();
+
+  cv::Mat img1 = frame->getResizedImageUndistorted();
+  cv::Mat img2 = frame->getResizedImageUndistorted();
+  EXPECT_EQ(img1.data, img2.data);
+  EXPECT_EQ(img1.cols, 600);
+
+  cv::Mat img_gray = frame->getResizedImageUndistortedGray();
+  EXPECT_EQ(img_gray.type(), CV_8UC1);
+  EXPECT_EQ(img_gray.data, frame->getResizedImageUndistortedGray().data);
+
+  frame->setImageResizeFactor(0.25);
+  cv::Mat img3 = frame->getResizedImageUndistorted();
+  EXPECT_NE(img1.data, img3.data);
+  EXPECT_EQ(img3.cols, 300);
+  EXPECT_EQ(frame->getResizedImageUndistortedGray().cols, 300);
+  EXPECT_EQ(frame->getResizedCamera()->width(), 300.0);
+
+  // Previously handed out images stay untouched
+  EXPECT_EQ(img1.cols, 600);
+
+  // Handed out surface points are not affected by later transformations of the frame
+  frame->setVisualPose(createDummyPose());
+  frame->setSurfacePoints((cv::Mat_<double>(3, 3) << 0, 32, 0, 15, 50, -130, 2, 2, 50));
+  cv::Mat surface_points = frame->getSurfacePoints();
+  cv::Mat T = cv::Mat::eye(4, 4, CV_64F);
+  T.at<double>(0, 3) = 10.0;
+  frame->initGeoreference(T);
+  EXPECT_EQ(surface_points.at<double>(0, 0), 0.0);
+}
+
+TEST(Frame, ImagePyramid)
+{
+  // Consumers requesting different scales must not evict each other
+  Frame::Ptr frame = createDummyFrame();
+
+  cv::Mat img_half = frame->getResizedImageRaw(0.5);
+  cv::Mat img_quarter = frame->getResizedImageRaw(0.25);
+  EXPECT_EQ(img_half.cols, 600);
+  EXPECT_EQ(img_quarter.cols, 300);
+  EXPECT_EQ(img_half.data, frame->getResizedImageRaw(0.5).data);
+  EXPECT_EQ(img_quarter.data, frame->getResizedImageRaw(0.25).data);
+
+  cv::Mat img_undist_quarter = frame->getResizedImageUndistorted(0.25);
+  EXPECT_EQ(img_undist_quarter.data, frame->getResizedImageUndistorted(0.25).data);
+  EXPECT_EQ(frame->getResizedCamera(0.25)->width(), 300.0);
+  EXPECT_EQ(frame->getResizedCamera(0.5)->width(), 600.0);
+  EXPECT_EQ(frame->getResizedImageSize(0.25), cv::Size(300, 250));
+
+  // Default scale is not affected by explicit requests
+  EXPECT_EQ(frame->getImageResizeFactor(), 0.5);
+  EXPECT_EQ(frame->getResizedImageRaw().data, img_half.data);
+
+  // Full resolution is level 1.0
+  EXPECT_EQ(frame->getImageUndistorted().cols, 1200);
+
+  EXPECT_THROW(frame->getResizedImageRaw(0.0), std::invalid_argument);
+}
+
+TEST(Frame, ReleaseCache)
+{
+  // Released images are computed again on the next access, images handed out before stay valid
+  Frame::Ptr frame = createDummyFrame();
+
+  cv::Mat img_gray = frame->getResizedImageUndistortedGray();
+  cv::Mat img_quarter = frame->getResizedImageRaw(0.25);
+  frame->releaseCache();
+
+  // Resized levels of the pyramid are released as well
+  cv::Mat img_quarter_new = frame->getResizedImageRaw(0.25);
+  EXPECT_NE(img_quarter.data, img_quarter_new.data);
+  EXPECT_EQ(img_quarter_new.cols, 300);
+  EXPECT_EQ(frame->getResizedCamera(0.25)->width(), 300.0);
+
+  cv::Mat img_gray_new = frame->getResizedImageUndistortedGray();
+  EXPECT_NE(img_gray.data, img_gray_new.data);
+  EXPECT_EQ(img_gray.size(), img_gray_new.size());
+  EXPECT_EQ(cv::norm(img_gray, img_gray_new, cv::NORM_INF), 0.0);
+}
@@ -0,0 +1,117 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <realm_core/metrics.h>
+#include <realm_core/metrics_exporter.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+TEST(Metrics, CounterAndGauge)
+{
+  metrics::Counter counter;
+  counter.increment();
+  counter.increment(4);
+  EXPECT_EQ(counter.value(), 5);
+
+  metrics::Gauge gauge;
+  gauge.set(10);
+  gauge.add(-3);
+  EXPECT_EQ(gauge.value(), 7);
+}
+
+TEST(Metrics, HistogramPercentiles)
+{
+  // Durations 1 ... 100 ms, so the percentiles are known. Buckets have a relative error of less than 10%.
+  metrics::Histogram histogram;
+  for (int i = 1; i <= 100; ++i)
+    histogram.record(static_cast<double>(i));
+
+  metrics::Histogram::Snapshot snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 100);
+  EXPECT_NEAR(snapshot.sum_ms, 5050.0, 1e-6);
+  EXPECT_NEAR(snapshot.max_ms, 100.0, 1e-6);
+  EXPECT_NEAR(snapshot.p50_ms, 50.0, 5.0);
+  EXPECT_NEAR(snapshot.p95_ms, 95.0, 9.5);
+  EXPECT_NEAR(snapshot.p99_ms, 99.0, 1.0); // capped at the maximum
+  EXPECT_GE(snapshot.p50_ms, 50.0);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.snapshot().count, 0);
+  EXPECT_EQ(histogram.percentile(0.5), 0.0);
+}
+
+TEST(Metrics, HistogramConcurrentRecording)
+{
+  // Recording is lock-free, no value should get lost with several writers
+  metrics::Histogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+    threads.emplace_back([&histogram]()
+    {
+      for (int i = 0; i < 10000; ++i)
+        histogram.record(0.5);
+    });
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(histogram.snapshot().count, 40000);
+}
+
+TEST(Metrics, Registry)
+{
+  metrics::Registry &registry = metrics::Registry::instance();
+  metrics::Counter::Ptr counter1 = registry.counter("realm_test_registry_counter");
+  metrics::Counter::Ptr counter2 = registry.counter("realm_test_registry_counter");
+  EXPECT_EQ(counter1, counter2);
+
+  counter1->increment(3);
+  registry.histogram("realm_test_registry_ms")->record(2.0);
+
+  std::string text = registry.toText();
+  EXPECT_NE(text.find("realm_test_registry_counter 3"), std::string::npos);
+  EXPECT_NE(text.find("realm_test_registry_ms_count 1"), std::string::npos);
+  EXPECT_NE(text.find("realm_test_registry_ms{quantile=\"0.99\"}"), std::string::npos);
+
+  EXPECT_EQ(metrics::toMetricName("Stage [densification]"), "stage_densification");
+  EXPECT_EQ(metrics::toMetricName("Publisher [pose_estimation]"), "publisher_pose_estimation");
+}
+
+TEST(Metrics, FileExport)
+{
+  metrics::Registry registry;
+  registry.gauge("realm_test_export_gauge")->set(42);
+
+  metrics::Exporter exporter(registry);
+  exporter.startFileExport("/tmp/realm_metrics_test.txt", 1);
+  exporter.writeFile();
+
+  std::ifstream file("/tmp/realm_metrics_test.txt");
+  std::stringstream text;
+  text << file.rdbuf();
+  EXPECT_NE(text.str().find("realm_test_export_gauge 42"), std::string::npos);
+}
@@ -20,6 +20,9 @@
 
 #include <iostream>
 #include <realm_core/camera.h>
+#include <realm_core/undistortion_map_cache.h>
+
+#include <opencv2/imgproc.hpp>
 
 #include "test_helper.h"
 
@@ -182,4 +185,40 @@ TEST(Pinhole, Projections)
   EXPECT_NEAR(p1.at<double>(0), 0.0, 10e-6);
   EXPECT_NEAR(p1.at<double>(1), 0.0, 10e-6);
   EXPECT_NEAR(p1.at<double>(2), 0.0, 10e-6);
-}
\ No newline at end of file
+}
+
+TEST(Pinhole, UndistortionMapCache)
+{
+  // Undistortion maps should only be computed once per combination of intrinsics, distortion and image size. All
+  // camera models with the same parameters share them, which we check by the number of cached maps and the results.
+  UndistortionMapCache::clear();
+
+  Pinhole cam = createDummyPinhole();
+  EXPECT_EQ(UndistortionMapCache::size(), 1u);
+
+  // Resizing twice with the same factor must not add another map
+  Pinhole cam_resized1 = cam.resize(0.5);
+  Pinhole cam_resized2 = cam.resize(0.5);
+  EXPECT_EQ(UndistortionMapCache::size(), 2u);
+
+  cv::Mat img(cam_resized1.height(), cam_resized1.width(), CV_8UC3);
+  cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(255));
+  cv::Mat diff = cam_resized1.undistort(img, cv::INTER_LINEAR) != cam_resized2.undistort(img, cv::INTER_LINEAR);
+  EXPECT_EQ(cv::countNonZero(diff.reshape(1)), 0);
+
+  // Intrinsics only differing in skew must not share their maps
+  cv::Mat K_skew = cam.K().clone();
+  K_skew.at<double>(0, 1) = 0.5;
+  cv::Mat map1, map2;
+  UndistortionMapCache::get(K_skew, cam.distCoeffs(), cv::Size(cam.width(), cam.height()), map1, map2);
+  EXPECT_EQ(UndistortionMapCache::size(), 3u);
+
+  // Least recently used maps are dropped if capacity is reached, camera models keep their maps nevertheless
+  UndistortionMapCache::setCapacity(1);
+  EXPECT_EQ(UndistortionMapCache::size(), 1u);
+  cv::Mat img_undistorted = cam_resized1.undistort(img, cv::INTER_LINEAR);
+  EXPECT_EQ(img_undistorted.size(), img.size());
+
+  UndistortionMapCache::setCapacity(8);
+  UndistortionMapCache::clear();
+}
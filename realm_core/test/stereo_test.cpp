@@ -92,6 +92,38 @@ TEST(Stereo, DepthMapFromPointCloud)
   EXPECT_FLOAT_EQ(depthmap.at<float>(depthmap.rows-1, 0), 1800.0);
 }
 
+TEST(Stereo, ProjectPointCloudZBuffer)
+{
+  // Several points fall onto the principal point of the camera. The closest one in front of the camera must win,
+  // independent of the order of the points.
+  auto cam = std::make_shared<Pinhole>(createDummyPinhole());
+  cam->setPose(createDummyPose());
+  auto cam_resized = std::make_shared<Pinhole>(cam->resize(0.1));
+
+  cv::Mat points = (cv::Mat_<double>(4, 3) <<
+          500.0, 600.0, 0.0,
+          500.0, 600.0, 600.0,
+          500.0, 600.0, 1500.0,  // behind the camera
+          500.0, 600.0, 300.0);
+
+  cv::Mat depthmap, indices;
+  stereo::projectPointCloud(cam_resized, points, depthmap, indices);
+
+  EXPECT_EQ(depthmap.type(), CV_32F);
+  EXPECT_EQ(indices.type(), CV_32S);
+  EXPECT_FLOAT_EQ(depthmap.at<float>(50, 60), 600.0);
+  EXPECT_EQ(indices.at<int>(50, 60), 1);
+  EXPECT_EQ(cv::countNonZero(depthmap > 0), 1);
+  EXPECT_EQ(cv::countNonZero(indices >= 0), 1);
+
+  // Reversed order gives the same depth
+  cv::Mat points_reversed;
+  cv::flip(points, points_reversed, 0);
+  stereo::projectPointCloud(cam_resized, points_reversed, depthmap, indices);
+  EXPECT_FLOAT_EQ(depthmap.at<float>(50, 60), 600.0);
+  EXPECT_EQ(indices.at<int>(50, 60), 2);
+}
+
 TEST(Stereo, NormalsFromDepthMap)
 {
   // For this test we create an artificial camera and depthmap and compute the normals for all pixels
@@ -121,6 +153,37 @@ TEST(Stereo, NormalsFromDepthMap)
   EXPECT_NEAR(fabs(acos(llc[2]/cv::norm(llc))*180/3.1415), 45.0, 10e-2);
 }
 
+TEST(Stereo, ReprojectDepthMapWithNormals)
+{
+  // The fused reprojection must produce the same results as the two separate passes
+  auto cam = std::make_shared<Pinhole>(createDummyPinhole());
+  cam->setPose(createDummyPose());
+
+  cv::Mat depthmap(cam->height(), cam->width(), CV_32F);
+  for (int r = 0; r < depthmap.rows; ++r)
+    for (int c = 0; c < depthmap.cols; ++c)
+      depthmap.at<float>(r, c) = 1200.0f + 600.0f - static_cast<float>(c) + 0.1f*static_cast<float>(r);
+
+  // Invalid depth is reprojected to the origin
+  depthmap.at<float>(10, 10) = -1.0f;
+
+  cv::Mat img3d, normals;
+  stereo::reprojectDepthMap(cam, depthmap, img3d, normals);
+
+  cv::Mat img3d_expected = stereo::reprojectDepthMap(cam, depthmap);
+  cv::Mat normals_expected = stereo::computeNormalsFromDepthMap(depthmap);
+
+  EXPECT_EQ(img3d.type(), CV_64FC3);
+  EXPECT_EQ(normals.type(), CV_32FC3);
+  EXPECT_EQ(cv::norm(img3d, img3d_expected, cv::NORM_INF), 0.0);
+  EXPECT_EQ(cv::norm(normals, normals_expected, cv::NORM_INF), 0.0);
+  EXPECT_EQ(img3d.at<cv::Vec3d>(10, 10), cv::Vec3d(0.0, 0.0, 0.0));
+
+  // Border normals are the ones of the inner neighbours
+  EXPECT_EQ(normals.at<cv::Vec3f>(0, 0), normals.at<cv::Vec3f>(1, 1));
+  EXPECT_EQ(normals.at<cv::Vec3f>(normals.rows-1, 5), normals.at<cv::Vec3f>(normals.rows-2, 5));
+}
+
 TEST(Stereo, BaselineFromPose)
 {
   cv::Mat p1 = cv::Mat::eye(3, 4, CV_64F);
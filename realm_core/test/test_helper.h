@@ -55,6 +55,39 @@ namespace realm {
     volatile int counter;
   };
 
+  class DummyEventWorker : public WorkerThreadBase
+  {
+  public:
+    DummyEventWorker() : WorkerThreadBase("dummy_event_worker", 1000, false), counter(0), jobs(0) { setEventDriven(true); }
+    void addJob()
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobs++;
+      }
+      notifyWorkAvailable();
+    }
+    bool process() override
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (jobs == 0)
+        return false;
+      jobs--;
+      counter++;
+      return true;
+    };
+    void reset() override
+    {
+      std::unique_lock<std::mutex> lock(_mutex_reset_requested);
+      counter = 0;
+      _reset_requested = false;
+    };
+
+    std::mutex mutex;
+    int jobs;
+    volatile int counter;
+  };
+
 } // namespace realm
 
 
@@ -0,0 +1,91 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <fstream>
+#include <sstream>
+
+#include <realm_core/tracing.h>
+
+#include "test_helper.h"
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+TEST(Tracing, ScopedSpan)
+{
+  tracing::Tracer &tracer = tracing::Tracer::instance();
+  tracer.clear();
+
+  // Disabled tracer does not record anything
+  tracer.setEnabled(false);
+  {
+    tracing::ScopedSpan span("test/disabled", 1);
+  }
+  EXPECT_TRUE(tracer.collect().empty());
+
+  tracer.setEnabled(true);
+  {
+    tracing::ScopedSpan span("test/enabled", 2);
+  }
+  std::vector<tracing::Span> spans = tracer.collect();
+  ASSERT_EQ(spans.size(), 1);
+  EXPECT_EQ(spans[0].name, "test/enabled");
+  EXPECT_EQ(spans[0].frame_id, 2);
+  EXPECT_GE(spans[0].t_end, spans[0].t_start);
+
+  tracer.setEnabled(false);
+  tracer.clear();
+}
+
+TEST(Tracing, FrameContextAndChromeTrace)
+{
+  tracing::Tracer &tracer = tracing::Tracer::instance();
+  tracer.clear();
+  tracer.setEnabled(true);
+
+  // Frame carries its spans, spans recorded in the thread buffers and in the frame context are only exported once
+  Frame::Ptr frame = createDummyFrame();
+  int64_t t = tracing::Tracer::now();
+  tracing::Span span1{"stage_a/process", frame->getFrameId(), t, t + 100, 0, 0};
+  tracing::Span span2{"stage_b/process", frame->getFrameId(), t + 200, t + 300, 0, 0};
+  tracer.record(span1);
+  tracer.record(span2);
+  frame->addTraceSpan(span1);
+  frame->addTraceSpan(span2);
+  tracer.recordFrame(frame->getFrameId(), frame->getTraceContext());
+
+  EXPECT_EQ(frame->getTraceContext().spans.size(), 2);
+  EXPECT_LE(frame->getTraceContext().t_acquisition, t);
+  EXPECT_EQ(tracer.collect().size(), 2);
+
+  ASSERT_TRUE(tracer.writeChromeTrace("/tmp/realm_tracing_test.json"));
+  std::ifstream file("/tmp/realm_tracing_test.json");
+  std::stringstream text;
+  text << file.rdbuf();
+  EXPECT_NE(text.str().find("\"name\":\"stage_a/process\""), std::string::npos);
+  EXPECT_NE(text.str().find("\"ph\":\"s\""), std::string::npos);
+  EXPECT_NE(text.str().find("\"ph\":\"f\""), std::string::npos);
+  EXPECT_NE(text.str().find("\"name\":\"frame #123456\""), std::string::npos);
+
+  tracer.setEnabled(false);
+  tracer.clear();
+}
@@ -56,4 +56,44 @@ TEST(WorkerThread, Basics)
 
   worker->requestFinish();
   worker->join();
-}
\ No newline at end of file
+}
+
+TEST(WorkerThread, EventDriven)
+{
+  // Event driven worker has a very long sleep time of 1s. All reactions below must therefore be triggered by the
+  // notifications, not by the timeout.
+  auto worker = std::make_shared<DummyEventWorker>();
+  worker->start();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(worker->counter, 0);
+
+  // All pending jobs are processed immediately and without sleeping in between
+  worker->addJob();
+  worker->addJob();
+  worker->addJob();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(worker->counter, 3);
+
+  // Stopped worker must not process, even if notified
+  worker->requestStop();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  worker->addJob();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(worker->counter, 3);
+
+  // Resets are processed while stopped
+  worker->requestReset();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(worker->counter, 0);
+
+  // The job added while stopped is processed after resume
+  worker->resume();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(worker->counter, 1);
+
+  // Finish request wakes the thread up as well, so joining returns before the sleep time elapsed
+  auto t = std::chrono::steady_clock::now();
+  worker->requestFinish();
+  worker->join();
+  EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t).count(), 500);
+}
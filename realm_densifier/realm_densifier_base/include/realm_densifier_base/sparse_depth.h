@@ -21,6 +21,8 @@
 #ifndef PROJECT_SPARSE_DISPARITY_H
 #define PROJECT_SPARSE_DISPARITY_H
 
+#include <string>
+
 #include <opencv2/core.hpp>
 
 #include <realm_core/camera.h>
@@ -32,6 +34,26 @@ namespace realm
 namespace densifier
 {
 
+/*!
+ * @brief Method to interpolate the regions in between the projected sparse points
+ * INPAINT: Navier-Stokes inpainting followed by a median filter to reduce its artifacts
+ * PULL_PUSH: Multi-scale pull-push interpolation. Sparse depth is averaged down an image pyramid and the coarse levels
+ *            fill the holes of the finer ones. Cost is linear in the number of pixels, no post filter is needed.
+ */
+enum class SparseInterpolation
+{
+    INPAINT,
+    PULL_PUSH
+};
+
+/*!
+ * @brief Converts the name of an interpolation method, e.g. from settings files, into the enum
+ * @param name "inpaint" or "pull_push". Empty name defaults to "inpaint"
+ * @return interpolation method
+ * @throws invalid_argument if name is unknown
+ */
+SparseInterpolation toSparseInterpolation(const std::string &name);
+
 /*!
  * @brief Function to compute dense depth map from a sparse point cloud. Uses inpainting to interpolate the regions
  *        in between the back projected sparse points.
@@ -43,7 +65,8 @@ namespace densifier
 void computeDepthMapFromSparseCloud(const cv::Mat &sparse_cloud,
                                     const camera::Pinhole::Ptr &cam,
                                     cv::OutputArray out_depth,
-                                    cv::OutputArray out_thumbnail = cv::Mat());
+                                    cv::OutputArray out_thumbnail = cv::Mat(),
+                                    SparseInterpolation method = SparseInterpolation::INPAINT);
 
 /*!
  * @brief Function to compute a mask from a sparse cloud. Points are reprojected into the image plane and afterwards
@@ -56,6 +79,25 @@ void computeSparseMask(const cv::Mat &sparse_cloud,
                        const camera::Pinhole::Ptr &cam,
                        cv::OutputArray out_mask);
 
+/*!
+ * @brief Function to compute dense depth map from a sparse depth map, e.g. computed with stereo::projectPointCloud.
+ *        Allows to project the sparse cloud once and reuse it for depth map and mask computation.
+ * @param depth_sparse Sparse depth map of type CV_32F, negative where no point was projected
+ * @param out_depth Dense output depth map
+ * @param method Interpolation method for the regions in between the sparse points
+ */
+void computeDepthMapFromSparseDepth(const cv::Mat &depth_sparse,
+                                    cv::OutputArray out_depth,
+                                    SparseInterpolation method = SparseInterpolation::INPAINT);
+
+/*!
+ * @brief Function to compute a mask from a sparse depth map, e.g. computed with stereo::projectPointCloud. A bounding
+ *        polygon around all valid pixels is created.
+ * @param depth_sparse Sparse depth map of type CV_32F, negative where no point was projected
+ * @param out_mask Output mask
+ */
+void computeSparseMaskFromSparseDepth(const cv::Mat &depth_sparse, cv::OutputArray out_mask);
+
 namespace internal
 {
 
@@ -66,6 +108,16 @@ namespace internal
  */
 cv::Mat computeBoundingPolygon(const cv::Mat &map);
 
+/*!
+ * @brief Function for multi-scale pull-push interpolation of a sparse depth map. In the pull phase depth and weight are
+ *        averaged into a pyramid of half resolution levels, where the weight of a coarse pixel is the sum of its fine
+ *        weights clamped to 1. In the push phase every level is completed from bottom to top by blending its own depth
+ *        with the bilinearly upsampled coarser level according to its weight. Valid sparse depths are kept exactly.
+ * @param depth_sparse Sparse depth map of type CV_32F, values <= 0 are treated as holes
+ * @return Dense depth map of type CV_32F. If no valid depth exists at all, a copy of the input is returned.
+ */
+cv::Mat interpolatePullPush(const cv::Mat &depth_sparse);
+
 }
 
 } // namespace densifier
@@ -78,16 +78,16 @@ cv::Mat PlaneSweep::densify(const std::deque<Frame::Ptr> &frames, uint8_t ref_id
   for (uint32_t i = 0; i < frames.size(); ++i)
   {
     // Get frame from container and prepare
+    // Scale of the densifier is requested explicitly, so other consumers of the frame are not affected
     Frame::Ptr frame = frames[i];
-    frame->setImageResizeFactor(_resizing);
 
     // Use resized image grayscale
-    cv::Mat img = frame->getResizedImageUndistorted();
+    cv::Mat img = frame->getResizedImageUndistorted(_resizing);
     cv::Mat img_valid = fixImageType(img);
     //cv::cvtColor(img, img, CV_BGR2GRAY);
 
     // Convert to PSL style camera
-    PSL::CameraMatrix<double> cam = convertToPslCamera(frames[i]->getResizedCamera());
+    PSL::CameraMatrix<double> cam = convertToPslCamera(frames[i]->getResizedCamera(_resizing));
 
     // Feed image to plane sweep handle and safe id
     int id = cps.addImage(img_valid, cam);
@@ -22,22 +22,59 @@
 
 using namespace realm;
 
+densifier::SparseInterpolation densifier::toSparseInterpolation(const std::string &name)
+{
+  if (name.empty() || name == "inpaint")
+    return SparseInterpolation::INPAINT;
+  if (name == "pull_push")
+    return SparseInterpolation::PULL_PUSH;
+  throw(std::invalid_argument("Error: Unknown sparse interpolation '" + name + "'."));
+}
+
 void densifier::computeDepthMapFromSparseCloud(const cv::Mat &sparse_cloud,
                                                const camera::Pinhole::Ptr &cam,
                                                cv::OutputArray out_depth,
-                                               cv::OutputArray out_thumbnail)
+                                               cv::OutputArray out_thumbnail,
+                                               SparseInterpolation method)
 {
-  // Neighbourhood radius is set to 1% of the input image but at least to 3
-  double radius = 0.01* static_cast<double>(cam->width());
-  if (radius < 3.0)
-    radius = 3.0;
-
   cv::Mat depth_sparse = stereo::computeDepthMapFromPointCloud(cam, sparse_cloud);
 
   // Optional output thumbnail:
   if (out_thumbnail.needed())
     out_thumbnail.assign(depth_sparse.clone());
 
+  computeDepthMapFromSparseDepth(depth_sparse, out_depth, method);
+}
+
+void densifier::computeSparseMask(const cv::Mat &sparse_cloud,
+                                  const camera::Pinhole::Ptr &cam,
+                                  cv::OutputArray out_mask)
+{
+  cv::Mat depth_sparse = stereo::computeDepthMapFromPointCloud(cam, sparse_cloud);
+  computeSparseMaskFromSparseDepth(depth_sparse, out_mask);
+}
+
+void densifier::computeDepthMapFromSparseDepth(const cv::Mat &depth_sparse_in,
+                                               cv::OutputArray out_depth,
+                                               SparseInterpolation method)
+{
+  if (depth_sparse_in.type() != CV_32F)
+    throw(std::invalid_argument("Error: Computing depth map from sparse depth failed. Type should be CV_32F!"));
+
+  if (method == SparseInterpolation::PULL_PUSH)
+  {
+    out_depth.assign(internal::interpolatePullPush(depth_sparse_in));
+    return;
+  }
+
+  // Neighbourhood radius is set to 1% of the input image but at least to 3
+  double radius = 0.01* static_cast<double>(depth_sparse_in.cols);
+  if (radius < 3.0)
+    radius = 3.0;
+
+  // Input is kept untouched, so it can still be used for e.g. the sparse mask afterwards
+  cv::Mat depth_sparse = depth_sparse_in.clone();
+
   cv::Mat mask_inpaint = (depth_sparse < 0);
   realm::inpaint(depth_sparse, mask_inpaint, depth_sparse, radius, INPAINT_NS);
 
@@ -50,12 +87,8 @@ void densifier::computeDepthMapFromSparseCloud(const cv::Mat &sparse_cloud,
   out_depth.assign(depth_sparse);
 }
 
-void densifier::computeSparseMask(const cv::Mat &sparse_cloud,
-                                  const camera::Pinhole::Ptr &cam,
-                                  cv::OutputArray out_mask)
+void densifier::computeSparseMaskFromSparseDepth(const cv::Mat &depth_sparse, cv::OutputArray out_mask)
 {
-  cv::Mat depth_sparse = stereo::computeDepthMapFromPointCloud(cam, sparse_cloud);
-
   cv::Mat mask_valid = densifier::internal::computeBoundingPolygon(depth_sparse);
 
   out_mask.assign(mask_valid);
@@ -68,10 +101,7 @@ cv::Mat densifier::internal::computeBoundingPolygon(const cv::Mat &map)
   // Therefore first compute the minimum bounding rectangle from all points with disparity
   cv::Mat mask_nonzero = (map > 0);
   std::vector<cv::Point2i> points;
-  for (int r = 0; r < mask_nonzero.rows; ++r)
-    for (int c = 0; c < mask_nonzero.cols; ++c)
-      if (mask_nonzero.at<uchar>(r, c) == 255)
-        points.emplace_back(cv::Point2i(c, r));
+  cv::findNonZero(mask_nonzero, points);
   cv::RotatedRect roi = cv::minAreaRect(points);
 
   // Then use this rotated rectangle to create a mask with convex filling of polygon
@@ -84,4 +114,56 @@ cv::Mat densifier::internal::computeBoundingPolygon(const cv::Mat &map)
   }
   cv::fillConvexPoly(mask, vertices, 4, cv::Scalar(255, 0, 0));
   return mask;
-}
\ No newline at end of file
+}
+
+cv::Mat densifier::internal::interpolatePullPush(const cv::Mat &depth_sparse)
+{
+  // Level 0: Weight is 1 for all valid sparse depths, 0 for holes. Holes are set to zero depth.
+  cv::Mat mask_valid = (depth_sparse > 0);
+  if (cv::countNonZero(mask_valid) == 0)
+    return depth_sparse.clone();
+
+  cv::Mat depth0 = cv::Mat::zeros(depth_sparse.size(), CV_32F);
+  cv::Mat weight0 = cv::Mat::zeros(depth_sparse.size(), CV_32F);
+  depth_sparse.copyTo(depth0, mask_valid);
+  weight0.setTo(1.0f, mask_valid);
+
+  std::vector<cv::Mat> depths{depth0};
+  std::vector<cv::Mat> weights{weight0};
+
+  // Pull: Weighted averages are computed as area average of (weight * depth) divided by area average of weight, so
+  // every coarse level contains the mean of all valid depths it covers. Stop once a level has no holes left.
+  while (depths.back().cols > 1 || depths.back().rows > 1)
+  {
+    const cv::Mat &depth = depths.back();
+    const cv::Mat &weight = weights.back();
+    if (cv::countNonZero(weight < 1.0f) == 0)
+      break;
+
+    cv::Size2i size_coarse((depth.cols + 1)/2, (depth.rows + 1)/2);
+    cv::Mat weighted_coarse, weight_coarse, depth_coarse;
+    cv::resize(depth.mul(weight), weighted_coarse, size_coarse, 0, 0, cv::INTER_AREA);
+    cv::resize(weight, weight_coarse, size_coarse, 0, 0, cv::INTER_AREA);
+
+    // Pixels without any valid depth get zero depth, their weight is zero as well
+    cv::divide(weighted_coarse, weight_coarse, depth_coarse);
+    depth_coarse.setTo(0.0f, weight_coarse <= 0.0f);
+
+    // Area average is the mean of about four fine weights, coarse weight is their clamped sum
+    weight_coarse = cv::min(weight_coarse*4.0f, 1.0f);
+
+    depths.push_back(depth_coarse);
+    weights.push_back(weight_coarse);
+  }
+
+  // Push: Fill every level from the coarser one. Fully weighted pixels, e.g. the sparse input, are kept untouched.
+  for (int l = static_cast<int>(depths.size()) - 2; l >= 0; --l)
+  {
+    cv::Mat upsampled;
+    cv::resize(depths[l+1], upsampled, depths[l].size(), 0, 0, cv::INTER_LINEAR);
+
+    cv::Mat weight_inv = 1.0f - weights[l];
+    depths[l] = depths[l].mul(weights[l]) + upsampled.mul(weight_inv);
+  }
+  return depths[0];
+}
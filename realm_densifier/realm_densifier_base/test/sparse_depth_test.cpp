@@ -0,0 +1,72 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <realm_densifier_base/sparse_depth.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+TEST(SparseDepth, PullPushPlane)
+{
+  // A tilted plane sampled on a regular grid of every 8th pixel is densified. Holes are filled within 1% of the depth,
+  // the sparse samples themselves are kept exactly.
+  cv::Mat depth_dense(120, 160, CV_32F);
+  for (int r = 0; r < depth_dense.rows; ++r)
+    for (int c = 0; c < depth_dense.cols; ++c)
+      depth_dense.at<float>(r, c) = 50.0f + 0.02f*c + 0.01f*r;
+
+  cv::Mat depth_sparse(depth_dense.size(), CV_32F, -1.0f);
+  for (int r = 3; r < depth_dense.rows; r += 8)
+    for (int c = 3; c < depth_dense.cols; c += 8)
+      depth_sparse.at<float>(r, c) = depth_dense.at<float>(r, c);
+
+  cv::Mat depth;
+  densifier::computeDepthMapFromSparseDepth(depth_sparse, depth, densifier::SparseInterpolation::PULL_PUSH);
+
+  ASSERT_EQ(depth.type(), CV_32F);
+  ASSERT_EQ(depth.size(), depth_dense.size());
+  EXPECT_EQ(cv::countNonZero(depth > 0.0f), depth.rows*depth.cols);
+  EXPECT_LT(cv::norm(depth, depth_dense, cv::NORM_INF), 0.5);
+
+  for (int r = 3; r < depth_dense.rows; r += 8)
+    for (int c = 3; c < depth_dense.cols; c += 8)
+      EXPECT_FLOAT_EQ(depth.at<float>(r, c), depth_dense.at<float>(r, c));
+}
+
+TEST(SparseDepth, PullPushEmpty)
+{
+  // Without any valid depth there is nothing to interpolate from, the input is returned unchanged
+  cv::Mat depth_sparse(60, 80, CV_32F, -1.0f);
+
+  cv::Mat depth = densifier::internal::interpolatePullPush(depth_sparse);
+  ASSERT_EQ(depth.type(), CV_32F);
+  ASSERT_EQ(depth.size(), depth_sparse.size());
+  EXPECT_EQ(cv::norm(depth, depth_sparse, cv::NORM_INF), 0.0);
+  EXPECT_NE(depth.data, depth_sparse.data);
+
+  cv::Mat depth_zero = densifier::internal::interpolatePullPush(cv::Mat::zeros(60, 80, CV_32F));
+  EXPECT_EQ(cv::countNonZero(depth_zero), 0);
+
+  EXPECT_THROW(densifier::computeDepthMapFromSparseDepth(cv::Mat(60, 80, CV_64F, -1.0), depth,
+                                                         densifier::SparseInterpolation::PULL_PUSH),
+               std::invalid_argument);
+}
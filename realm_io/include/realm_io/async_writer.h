@@ -0,0 +1,188 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_ASYNC_WRITER_H
+#define PROJECT_ASYNC_WRITER_H
+
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+
+#include <realm_core/metrics.h>
+
+namespace realm
+{
+namespace io
+{
+
+/*!
+ * @brief Writer to take disk and encoding latency out of the processing threads. Save jobs are queued in a bounded
+ * queue and executed by a small pool of worker threads. The caller is responsible for handing over data that is not
+ * modified anymore after the job was queued, e.g. freshly computed cv::Mat or deep copies (snapshots) of shared data.
+ * As cv::Mat is reference counted, capturing it by value in the job keeps the data alive until it was written.
+ * Jobs should therefore never capture pointers or references to members of the caller.
+ */
+class AsyncWriter
+{
+  public:
+    using Ptr = std::shared_ptr<AsyncWriter>;
+    using ConstPtr = std::shared_ptr<const AsyncWriter>;
+
+    using Job = std::function<void()>;
+
+    /*!
+     * @brief Behaviour if a job is queued while the queue is full
+     * BLOCK: Caller waits until a worker picked up a job (backpressure, nothing is lost)
+     * DROP_NEWEST: The new job is discarded
+     * DROP_OLDEST: The oldest queued job is discarded to make room for the new one
+     * Jobs queued as not droppable are never discarded. If there is no droppable job to make room for them, the caller
+     * waits as for BLOCK.
+     */
+    enum class OverflowPolicy
+    {
+        BLOCK,
+        DROP_NEWEST,
+        DROP_OLDEST
+    };
+
+    /*!
+     * @brief Statistics of the writer since the last reset. Latency is measured from queueing until the write finished,
+     * therefore includes the time waiting in the queue.
+     */
+    struct Statistics
+    {
+        size_t queue_depth;
+        size_t queue_depth_max;
+        uint64_t num_written;
+        uint64_t num_dropped;
+        uint64_t num_failed;
+        double latency_avg_ms;
+        double latency_max_ms;
+    };
+
+  public:
+    /*!
+     * @brief Constructor, starts the worker threads
+     * @param num_threads Number of worker threads, must be positive
+     * @param queue_size Maximum number of queued jobs, must be positive
+     * @param policy Behaviour if the queue is full
+     * @throws invalid_argument if number of threads or queue size are not positive
+     */
+    AsyncWriter(int num_threads, int queue_size, OverflowPolicy policy);
+
+    /*!
+     * @brief Destructor, writes all remaining jobs and joins the worker threads
+     */
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter &other) = delete;
+    AsyncWriter& operator=(const AsyncWriter &other) = delete;
+
+    /*!
+     * @brief Queues a job for writing. Depending on the overflow policy this might block or drop a job.
+     * @param description Short description of the job for logging, e.g. the output filename
+     * @param job Callable doing the actual write
+     * @param is_droppable Flag if the job may be discarded by the overflow policy. Should be false for jobs, that
+     *        are part of a sequence of updates, e.g. of the same file, where a lost job can not be recovered later.
+     * @return true if the job was queued, false if it was dropped
+     */
+    bool enqueue(const std::string &description, const Job &job, bool is_droppable = true);
+
+    /*!
+     * @brief Blocks until all queued jobs were written
+     */
+    void flush();
+
+    /*!
+     * @brief Sets metrics, that are updated live by the writer. Either of them might be nullptr.
+     * @param queue_depth Gauge set to the number of queued jobs whenever a job is queued or taken from the queue
+     * @param latency Histogram of the time from queueing until the write finished, recorded for every written job
+     */
+    void setMetrics(const metrics::Gauge::Ptr &queue_depth, const metrics::Histogram::Ptr &latency);
+
+    /*!
+     * @brief Getter for the statistics since the last reset
+     * @param reset Flag if the statistics should be reset afterwards (except the current queue depth)
+     * @return statistics of the writer
+     */
+    Statistics getStatistics(bool reset = false);
+
+    /*!
+     * @brief Converts the name of an overflow policy, e.g. from settings files, into the enum
+     * @param name "block", "drop_newest" or "drop_oldest". Empty name defaults to "block"
+     * @return overflow policy
+     * @throws invalid_argument if name is unknown
+     */
+    static OverflowPolicy toOverflowPolicy(const std::string &name);
+
+  private:
+
+    struct Task
+    {
+        std::string description;
+        Job job;
+        std::chrono::steady_clock::time_point t_queued;
+        bool is_droppable;
+    };
+
+    //! Behaviour if queue is full
+    OverflowPolicy _policy;
+
+    //! Maximum number of queued jobs
+    size_t _queue_size;
+
+    //! Flag to signal the workers to finish, after the queue was emptied
+    bool _is_finished;
+
+    //! Number of jobs currently executed by the workers
+    int _num_active;
+
+    std::deque<Task> _queue;
+    std::vector<std::thread> _workers;
+
+    //! Mutex for queue, flags and statistics
+    std::mutex _mutex;
+
+    //! Signals workers that a job was queued or the writer finished
+    std::condition_variable _condition_job;
+
+    //! Signals waiting callers that a job was taken from the queue or finished
+    std::condition_variable _condition_space;
+
+    Statistics _statistics;
+    double _latency_sum_ms;
+
+    //! Optional metrics, see setMetrics(...)
+    metrics::Gauge::Ptr _metric_queue_depth;
+    metrics::Histogram::Ptr _metric_latency;
+
+    void run();
+};
+
+} // namespace io
+} // namespace realm
+
+#endif //PROJECT_ASYNC_WRITER_H
@@ -23,6 +23,7 @@
 
 #include <iostream>
 #include <vector>
+#include <string>
 
 #include <opencv2/core.hpp>
 
@@ -39,6 +40,26 @@ namespace realm
 namespace io
 {
 
+/*!
+ * @brief Layout settings of written GeoTIFFs. Default is a tiled, DEFLATE compressed GeoTIFF with internal overviews
+ * stored in front of the full resolution data, which is the layout of a Cloud Optimized GeoTIFF (COG).
+ * @var compression GDAL compression, e.g. "NONE", "DEFLATE", "LZW" or "ZSTD" (needs GDAL >= 2.3)
+ * @var block_size Edge length of the internal tiles in pixels, must be a multiple of 16
+ * @var use_overviews Flag if internal overviews (2x, 4x, ... downsampled) should be generated
+ */
+struct GeoTIFFSettings
+{
+    GeoTIFFSettings()
+    : compression("DEFLATE"),
+      block_size(256),
+      use_overviews(true)
+    {}
+
+    std::string compression;
+    int block_size;
+    bool use_overviews;
+};
+
 /*!
  * @brief Save function for GeoTIFFs interfaced through a CvGridMap.
  * @param map Observed scene that should be saved as GeoTIFF
@@ -82,10 +103,31 @@ void saveGeoTIFF(const CvGridMap &map,
 void saveGeoTIFF(const CvGridMap &map,
                  const std::string &color_layer_name,
                  const uint8_t &zone,
-                 const std::string &filename);
+                 const std::string &filename,
+                 const GeoTIFFSettings &settings = GeoTIFFSettings());
 
 /*!
- * @brief Save function for GeoTIFFs interfaced through raw minimum input.
+ * @brief Updates a region of an existing GeoTIFF, which was previously written by saveGeoTIFF for a map with the given
+ * extent. Only the dirty region has to be passed, so the caller never needs the dense full map. The tiles overlapping
+ * it and the corresponding parts of the overviews are rewritten, missing data for complete tiles is read back from the
+ * file. The cost is therefore proportional to the changed area instead of the full map.
+ * Note: Rewritten compressed tiles are appended to the file, so it remains a valid tiled GeoTIFF, but looses the cloud
+ * optimized ordering until the next complete write.
+ * @param map_dirty Region of the map that has changed since the last write, with the same resolution and alignment
+ * @param color_layer_name Name of the layer to be saved in the grid map
+ * @param roi_map Extent of the full map the file was written for in world coordinates
+ * @param filename Absolute filename of the GeoTIFF
+ * @return false without writing anything, if the file does not exist or its geometry, number of bands or data type
+ *         does not match (e.g. because the map grew). The file has to be written completely by saveGeoTIFF then.
+ */
+bool updateGeoTIFF(const CvGridMap &map_dirty,
+                   const std::string &color_layer_name,
+                   const cv::Rect2d &roi_map,
+                   const std::string &filename);
+
+/*!
+ * @brief Save function for GeoTIFFs interfaced through raw minimum input. The image is handed to GDAL without copying
+ * or splitting into bands, layout of the file is defined by the settings.
  * @param img Image data of the observed scene
  * @param filename Filename of the output file including directory
  * @param geoinfo 6x1 raw array of geo informations organized as:
@@ -96,12 +138,15 @@ void saveGeoTIFF(const CvGridMap &map,
  *  0.0,
  *  -ground sampling distance)
  * @param zone UTM zone of the passed position
- * @return
+ * @param settings Layout of the file, e.g. compression and overviews
+ * @throws invalid_argument if the image type is not supported
+ * @throws runtime_error if GDAL fails to write the file
  */
 void saveGeoTIFF(const cv::Mat &img,
                  const char *filename,
                  double *geoinfo,
-                 const uint8_t &zone);
+                 const uint8_t &zone,
+                 const GeoTIFFSettings &settings = GeoTIFFSettings());
 
 } // namespace io
 } // namespace realm
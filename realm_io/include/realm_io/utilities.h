@@ -96,6 +96,13 @@ uint32_t extractFrameIdFromFilepath(const std::string &filepath);
  */
 std::vector<std::string> split(const char *str, char c = ' ');
 
+/*!
+ * @brief Function to list all files inside a directory and its subdirectories
+ * @param directory Directory to be searched
+ * @return Sorted vector of absolute file paths, empty if directory is empty string
+ */
+std::vector<std::string> getFileList(const std::string &directory);
+
 }
 }
 
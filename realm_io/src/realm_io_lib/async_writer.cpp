@@ -0,0 +1,196 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <realm_core/loguru.h>
+#include <realm_io/async_writer.h>
+
+using namespace realm;
+
+io::AsyncWriter::AsyncWriter(int num_threads, int queue_size, OverflowPolicy policy)
+: _policy(policy),
+  _queue_size(static_cast<size_t>(std::max(queue_size, 0))),
+  _is_finished(false),
+  _num_active(0),
+  _statistics{0, 0, 0, 0, 0, 0.0, 0.0},
+  _latency_sum_ms(0.0)
+{
+  if (num_threads <= 0)
+    throw(std::invalid_argument("Error: Number of writer threads must be positive!"));
+  if (queue_size <= 0)
+    throw(std::invalid_argument("Error: Queue size of writer must be positive!"));
+
+  for (int i = 0; i < num_threads; ++i)
+    _workers.emplace_back(std::thread(&AsyncWriter::run, this));
+}
+
+io::AsyncWriter::~AsyncWriter()
+{
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _is_finished = true;
+  }
+  _condition_job.notify_all();
+  _condition_space.notify_all();
+  for (auto &worker : _workers)
+    worker.join();
+}
+
+bool io::AsyncWriter::enqueue(const std::string &description, const Job &job, bool is_droppable)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  // Workers might have stopped already, a job queued now would never be written
+  if (_is_finished)
+  {
+    LOG_F(WARNING, "Writer finished. Dropping '%s'.", description.c_str());
+    _statistics.num_dropped++;
+    return false;
+  }
+
+  if (_queue.size() >= _queue_size)
+  {
+    auto it_oldest = std::find_if(_queue.begin(), _queue.end(), [](const Task &task){ return task.is_droppable; });
+    if (_policy == OverflowPolicy::DROP_NEWEST && is_droppable)
+    {
+      LOG_F(WARNING, "Write queue full. Dropping '%s'.", description.c_str());
+      _statistics.num_dropped++;
+      return false;
+    }
+    else if (_policy == OverflowPolicy::DROP_OLDEST && it_oldest != _queue.end())
+    {
+      LOG_F(WARNING, "Write queue full. Dropping '%s'.", it_oldest->description.c_str());
+      _queue.erase(it_oldest);
+      _statistics.num_dropped++;
+    }
+    else
+    {
+      // BLOCK, or nothing may be dropped to make room
+      _condition_space.wait(lock, [this](){ return _queue.size() < _queue_size || _is_finished; });
+      if (_is_finished)
+      {
+        LOG_F(WARNING, "Writer finished. Dropping '%s'.", description.c_str());
+        _statistics.num_dropped++;
+        return false;
+      }
+    }
+  }
+
+  _queue.push_back(Task{description, job, std::chrono::steady_clock::now(), is_droppable});
+  _statistics.queue_depth_max = std::max(_statistics.queue_depth_max, _queue.size());
+  if (_metric_queue_depth)
+    _metric_queue_depth->set(static_cast<int64_t>(_queue.size()));
+  lock.unlock();
+
+  _condition_job.notify_one();
+  return true;
+}
+
+void io::AsyncWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _condition_space.wait(lock, [this](){ return _queue.empty() && _num_active == 0; });
+}
+
+void io::AsyncWriter::setMetrics(const metrics::Gauge::Ptr &queue_depth, const metrics::Histogram::Ptr &latency)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _metric_queue_depth = queue_depth;
+  _metric_latency = latency;
+}
+
+io::AsyncWriter::Statistics io::AsyncWriter::getStatistics(bool reset)
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  Statistics statistics = _statistics;
+  statistics.queue_depth = _queue.size();
+  statistics.latency_avg_ms = (_statistics.num_written > 0 ? _latency_sum_ms / _statistics.num_written : 0.0);
+
+  if (reset)
+  {
+    _statistics = Statistics{0, _queue.size(), 0, 0, 0, 0.0, 0.0};
+    _latency_sum_ms = 0.0;
+  }
+  return statistics;
+}
+
+io::AsyncWriter::OverflowPolicy io::AsyncWriter::toOverflowPolicy(const std::string &name)
+{
+  if (name.empty() || name == "block")
+    return OverflowPolicy::BLOCK;
+  if (name == "drop_newest")
+    return OverflowPolicy::DROP_NEWEST;
+  if (name == "drop_oldest")
+    return OverflowPolicy::DROP_OLDEST;
+  throw(std::invalid_argument("Error: Unknown overflow policy '" + name + "' for writer."));
+}
+
+void io::AsyncWriter::run()
+{
+  while (true)
+  {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition_job.wait(lock, [this](){ return !_queue.empty() || _is_finished; });
+
+      // Remaining jobs are always written before finishing
+      if (_queue.empty())
+        return;
+
+      task = std::move(_queue.front());
+      _queue.pop_front();
+      _num_active++;
+      if (_metric_queue_depth)
+        _metric_queue_depth->set(static_cast<int64_t>(_queue.size()));
+    }
+    _condition_space.notify_all();
+
+    bool success = true;
+    try
+    {
+      task.job();
+    }
+    catch (std::exception &e)
+    {
+      LOG_F(ERROR, "Writing '%s' failed: %s", task.description.c_str(), e.what());
+      success = false;
+    }
+
+    double latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - task.t_queued).count();
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _num_active--;
+      if (success)
+      {
+        _statistics.num_written++;
+        _latency_sum_ms += latency;
+        _statistics.latency_max_ms = std::max(_statistics.latency_max_ms, latency);
+        if (_metric_latency)
+          _metric_latency->record(latency);
+      }
+      else
+        _statistics.num_failed++;
+    }
+    _condition_space.notify_all();
+  }
+}
@@ -18,10 +18,191 @@
 * along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <mutex>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include <opencv2/imgproc.hpp>
+
+#include <realm_core/loguru.h>
 #include <realm_io/gis_export.h>
 
 using namespace realm;
 
+namespace
+{
+
+/*!
+ * @brief Registration of GDAL drivers is expensive and only has to be done once per process
+ */
+void registerGdalDrivers()
+{
+  static std::once_flag flag;
+  std::call_once(flag, [](){ GDALAllRegister(); });
+}
+
+GDALDataType toGdalDataType(int type)
+{
+  switch (CV_MAT_DEPTH(type))
+  {
+    case CV_8U:
+      return GDT_Byte;
+    case CV_16U:
+      return GDT_UInt16;
+    case CV_32F:
+      return GDT_Float32;
+    case CV_64F:
+      return GDT_Float64;
+    default:
+      throw(std::invalid_argument("Error saving GTiff: Image format not recognized!"));
+  }
+}
+
+void computeGeoTransform(const cv::Rect2d &roi, double resolution, double geoinfo[6])
+{
+  geoinfo[0] = roi.x;
+  geoinfo[1] = resolution;
+  geoinfo[2] = 0;
+  geoinfo[3] = roi.y+roi.height;
+  geoinfo[4] = 0;
+  geoinfo[5] = -resolution;
+}
+
+void computeGeoTransform(const CvGridMap &map, double geoinfo[6])
+{
+  computeGeoTransform(map.roi(), map.resolution(), geoinfo);
+}
+
+void setBandMetadata(GDALRasterBand *band, int idx, int bands, int type)
+{
+  if (CV_MAT_DEPTH(type) == CV_32F)
+    band->SetNoDataValue(std::numeric_limits<float>::quiet_NaN());
+  else if (CV_MAT_DEPTH(type) == CV_64F)
+    band->SetNoDataValue(std::numeric_limits<double>::quiet_NaN());
+  else
+    band->SetNoDataValue(0);
+
+  if (bands == 1)
+    band->SetColorInterpretation(GCI_GrayIndex);
+  else
+  {
+    switch (idx)
+    {
+      case 1:
+        band->SetColorInterpretation(GCI_BlueBand);
+        break;
+      case 2:
+        band->SetColorInterpretation(GCI_GreenBand);
+        break;
+      case 3:
+        band->SetColorInterpretation(GCI_RedBand);
+        break;
+      case 4:
+        band->SetColorInterpretation(GCI_AlphaBand);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/*!
+ * @brief Overview levels 2, 4, 8, ... until the smallest overview fits into one tile
+ */
+std::vector<int> computeOverviewLevels(int cols, int rows, int block_size)
+{
+  std::vector<int> levels;
+  for (int level = 2; cols / (level / 2) > block_size || rows / (level / 2) > block_size; level *= 2)
+    levels.push_back(level);
+  return levels;
+}
+
+int greatestCommonDivisor(int a, int b)
+{
+  while (b != 0)
+  {
+    int tmp = a % b;
+    a = b;
+    b = tmp;
+  }
+  return a;
+}
+
+/*!
+ * @brief Color data is averaged for overviews, all other data (e.g. elevation, observation counts) is subsampled to
+ * not mix in invalid values
+ */
+bool useAveragingForOverviews(int type)
+{
+  return CV_MAT_DEPTH(type) == CV_8U;
+}
+
+/*!
+ * @brief Writes the image into the dataset at given offset. Data is passed pixel interleaved as in the cv::Mat, GDAL
+ * handles the reordering into bands.
+ */
+CPLErr writeRegion(GDALDataset *dataset, const cv::Mat &img, int x, int y)
+{
+  return dataset->RasterIO(GF_Write, x, y, img.cols, img.rows, (void*)img.data, img.cols, img.rows,
+                           toGdalDataType(img.type()), img.channels(), nullptr,
+                           static_cast<GSpacing>(img.elemSize()), static_cast<GSpacing>(img.step[0]),
+                           static_cast<GSpacing>(img.elemSize1()), nullptr);
+}
+
+/*!
+ * @brief Counterpart of writeRegion, reads a region of the full resolution data into the preallocated image
+ */
+CPLErr readRegion(GDALDataset *dataset, cv::Mat &img, int x, int y)
+{
+  return dataset->RasterIO(GF_Read, x, y, img.cols, img.rows, (void*)img.data, img.cols, img.rows,
+                           toGdalDataType(img.type()), img.channels(), nullptr,
+                           static_cast<GSpacing>(img.elemSize()), static_cast<GSpacing>(img.step[0]),
+                           static_cast<GSpacing>(img.elemSize1()), nullptr);
+}
+
+/*!
+ * @brief Same as writeRegion, but for one overview level. Overviews are handled per band by GDAL.
+ */
+CPLErr writeOverviewRegion(GDALDataset *dataset, int overview, const cv::Mat &img, int x, int y)
+{
+  GDALDataType pix_type = toGdalDataType(img.type());
+  for (int i = 1; i <= img.channels(); ++i)
+  {
+    GDALRasterBand *band = dataset->GetRasterBand(i)->GetOverview(overview);
+    CPLErr error_code = band->RasterIO(GF_Write, x, y, img.cols, img.rows, (void*)(img.data + (i - 1)*img.elemSize1()),
+                                       img.cols, img.rows, pix_type,
+                                       static_cast<GSpacing>(img.elemSize()), static_cast<GSpacing>(img.step[0]), nullptr);
+    if (error_code != CE_None)
+      return error_code;
+  }
+  return CE_None;
+}
+
+/*!
+ * @brief Checks if an existing dataset can be updated with image data of given size and type, i.e. it has identical
+ * geometry and data layout
+ */
+bool isCompatible(GDALDataset *dataset, const cv::Size &size, int type, const double geoinfo[6])
+{
+  if (dataset->GetRasterXSize() != size.width || dataset->GetRasterYSize() != size.height)
+    return false;
+  if (dataset->GetRasterCount() != CV_MAT_CN(type))
+    return false;
+  if (dataset->GetRasterBand(1)->GetRasterDataType() != toGdalDataType(type))
+    return false;
+
+  double geoinfo_file[6];
+  if (dataset->GetGeoTransform(geoinfo_file) != CE_None)
+    return false;
+  for (int i = 0; i < 6; ++i)
+    if (fabs(geoinfo_file[i] - geoinfo[i]) > 10e-6)
+      return false;
+  return true;
+}
+
+} // namespace
+
 void io::saveGeoTIFF(const CvGridMap &map,
                      const std::string &color_layer_name,
                      const uint8_t &zone,
@@ -48,112 +229,192 @@ void io::saveGeoTIFF(const CvGridMap &map,
 void io::saveGeoTIFF(const CvGridMap &map,
                  const std::string &color_layer_name,
                  const uint8_t &zone,
-                 const std::string &filename)
+                 const std::string &filename,
+                 const GeoTIFFSettings &settings)
 {
-  // Get relevant data from container class
-  double GSD = map.resolution();
-  cv::Rect2d roi = map.roi();
-  cv::Mat color_layer = map[color_layer_name];
-
   // Creating geo informations for GDAL
   double geoproj[6];
-  geoproj[0] = roi.x;
-  geoproj[1] = GSD;
-  geoproj[2] = 0;
-  geoproj[3] = roi.y+roi.height;
-  geoproj[4] = 0;
-  geoproj[5] = -GSD;
+  computeGeoTransform(map, geoproj);
 
   // Call to minimal saving function
-  io::saveGeoTIFF(color_layer, filename.c_str(), geoproj, zone);
+  io::saveGeoTIFF(map[color_layer_name], filename.c_str(), geoproj, zone, settings);
+}
+
+bool io::updateGeoTIFF(const CvGridMap &map_dirty,
+                       const std::string &color_layer_name,
+                       const cv::Rect2d &roi_map,
+                       const std::string &filename)
+{
+  registerGdalDrivers();
+
+  cv::Mat img_dirty = map_dirty[color_layer_name];
+  double GSD = map_dirty.resolution();
+  cv::Size size(static_cast<int>(std::round(roi_map.width/GSD)) + 1, static_cast<int>(std::round(roi_map.height/GSD)) + 1);
+  double geoproj[6];
+  computeGeoTransform(roi_map, GSD, geoproj);
+
+  GDALDataset *dataset = nullptr;
+  if (io::fileExists(filename))
+    dataset = (GDALDataset*) GDALOpen(filename.c_str(), GA_Update);
+
+  if (dataset == nullptr || !isCompatible(dataset, size, img_dirty.type(), geoproj))
+  {
+    if (dataset != nullptr)
+      GDALClose((GDALDatasetH) dataset);
+    return false;
+  }
+
+  // Dirty region in pixel coordinates of the file, clipped to its extent
+  cv::Rect2d roi_dirty = map_dirty.roi();
+  cv::Rect2i rect_dirty(static_cast<int>(std::round((roi_dirty.x - roi_map.x) / GSD)),
+                        static_cast<int>(std::round((roi_map.y + roi_map.height - roi_dirty.y - roi_dirty.height) / GSD)),
+                        img_dirty.cols, img_dirty.rows);
+  cv::Rect2i rect_clipped = rect_dirty & cv::Rect2i(0, 0, size.width, size.height);
+  if (rect_clipped.area() == 0)
+  {
+    GDALClose((GDALDatasetH) dataset);
+    return true;
+  }
+
+  // Bounds are aligned to the tiles of the file and to the largest overview factor, so that every touched tile and
+  // every touched overview pixel is rewritten completely
+  int factor_max = 1;
+  GDALRasterBand *band = dataset->GetRasterBand(1);
+  for (int i = 0; i < band->GetOverviewCount(); ++i)
+    factor_max = std::max(factor_max, (int)std::lround((double)size.width / band->GetOverview(i)->GetXSize()));
+
+  int block_x, block_y;
+  band->GetBlockSize(&block_x, &block_y);
+  int align_x = block_x / greatestCommonDivisor(block_x, factor_max) * factor_max;
+  int align_y = block_y / greatestCommonDivisor(block_y, factor_max) * factor_max;
+
+  int x0 = rect_clipped.x / align_x * align_x;
+  int y0 = rect_clipped.y / align_y * align_y;
+  int x1 = std::min(size.width, (rect_clipped.x + rect_clipped.width + align_x - 1) / align_x * align_x);
+  int y1 = std::min(size.height, (rect_clipped.y + rect_clipped.height + align_y - 1) / align_y * align_y);
+
+  // Aligned region is read back from the file and the dirty data is pasted into it
+  cv::Mat img_region(y1 - y0, x1 - x0, img_dirty.type());
+  if (readRegion(dataset, img_region, x0, y0) != CE_None)
+  {
+    GDALClose((GDALDatasetH) dataset);
+    throw(std::runtime_error("Error updating GeoTIFF: Reading region around the dirty region failed."));
+  }
+  img_dirty(rect_clipped - rect_dirty.tl()).copyTo(img_region(rect_clipped - cv::Point2i(x0, y0)));
+
+  if (writeRegion(dataset, img_region, x0, y0) != CE_None)
+  {
+    GDALClose((GDALDatasetH) dataset);
+    throw(std::runtime_error("Error updating GeoTIFF: Writing dirty region failed."));
+  }
+
+  // Overviews of the dirty region are downsampled from the full resolution data of the same region
+  int interpolation = (useAveragingForOverviews(img_dirty.type()) ? cv::INTER_AREA : cv::INTER_NEAREST);
+  for (int i = 0; i < band->GetOverviewCount(); ++i)
+  {
+    GDALRasterBand *overview = band->GetOverview(i);
+    int factor = (int)std::lround((double)size.width / overview->GetXSize());
+    int ox0 = x0 / factor;
+    int oy0 = y0 / factor;
+    int ox1 = std::min(overview->GetXSize(), (x1 + factor - 1) / factor);
+    int oy1 = std::min(overview->GetYSize(), (y1 + factor - 1) / factor);
+    if (ox1 <= ox0 || oy1 <= oy0)
+      continue;
+
+    cv::Mat img_overview;
+    cv::resize(img_region, img_overview, cv::Size(ox1 - ox0, oy1 - oy0), 0, 0, interpolation);
+    if (writeOverviewRegion(dataset, i, img_overview, ox0, oy0) != CE_None)
+    {
+      GDALClose((GDALDatasetH) dataset);
+      throw(std::runtime_error("Error updating GeoTIFF: Writing overview failed."));
+    }
+  }
+
+  GDALClose((GDALDatasetH) dataset);
+  return true;
 }
 
 void io::saveGeoTIFF(const cv::Mat &img,
                      const char *filename,
                      double *geoinfo,
-                     const uint8_t &zone)
+                     const uint8_t &zone,
+                     const GeoTIFFSettings &settings)
 {
-  const char *format = "GTiff";
-  char **options = nullptr;
-
-  auto bands = static_cast<uint8_t>(img.channels());
-  auto rows = static_cast<uint32_t>(img.rows);
-  auto cols = static_cast<uint32_t>(img.cols);
+  registerGdalDrivers();
 
-  GDALDataset *dataset;
-  GDALDriver *driver;
-  OGRSpatialReference oSRS;
+  GDALDataType pix_type = toGdalDataType(img.type());
+  int bands = img.channels();
+  int rows = img.rows;
+  int cols = img.cols;
 
-  GDALAllRegister();
+  // Image data is wrapped as in-memory dataset without copying. Each band points to its first channel within the
+  // pixel interleaved data of the cv::Mat.
+  GDALDriver *driver_mem = GetGDALDriverManager()->GetDriverByName("MEM");
+  GDALDataset *dataset_mem = driver_mem->Create("", cols, rows, 0, pix_type, nullptr);
+  if (dataset_mem == nullptr)
+    throw(std::runtime_error("Error saving GeoTIFF: Creating in-memory dataset failed."));
 
-  driver = GetGDALDriverManager()->GetDriverByName(format);
+  for (int i = 1; i <= bands; ++i)
+  {
+    char data_pointer[64];
+    int n = CPLPrintPointer(data_pointer, (void*)(img.data + (i - 1)*img.elemSize1()), sizeof(data_pointer));
+    data_pointer[n] = '\0';
 
-  GDALDataType pix_type;
-  if (img.type() == CV_8UC1 || img.type() == CV_8UC3 || img.type() == CV_8UC4)
-    pix_type = GDT_Byte;
-  else if (img.type() == CV_16UC1)
-    pix_type = GDT_Int16;
-  else if (img.type() == CV_32F)
-    pix_type = GDT_Float32;
-  else if (img.type() == CV_64F)
-    pix_type = GDT_Float64;
-  else
-    throw(std::invalid_argument("Error saving GTiff: Image format not recognized!"));
+    char **options_band = nullptr;
+    options_band = CSLSetNameValue(options_band, "DATAPOINTER", data_pointer);
+    options_band = CSLSetNameValue(options_band, "PIXELOFFSET", std::to_string(img.elemSize()).c_str());
+    options_band = CSLSetNameValue(options_band, "LINEOFFSET", std::to_string(img.step[0]).c_str());
+    dataset_mem->AddBand(pix_type, options_band);
+    CSLDestroy(options_band);
 
-  dataset = driver->Create(filename, cols, rows, bands, pix_type, options);
+    setBandMetadata(dataset_mem->GetRasterBand(i), i, bands, img.type());
+  }
 
   char *pszSRS_WKT = nullptr;
-
-  dataset->SetGeoTransform(geoinfo);
+  OGRSpatialReference oSRS;
+  dataset_mem->SetGeoTransform(geoinfo);
   oSRS.SetUTM(zone, TRUE);
   oSRS.SetWellKnownGeogCS("WGS84");
   oSRS.exportToWkt(&pszSRS_WKT);
-  dataset->SetProjection(pszSRS_WKT);
+  dataset_mem->SetProjection(pszSRS_WKT);
   CPLFree(pszSRS_WKT);
 
-  cv::Mat img_bands[bands];
-  cv::split(img, img_bands);
-
-  for (uint8_t i = 1; i <= bands; i++)
+  // Overviews are computed in memory and copied in front of the full resolution data
+  bool has_overviews = false;
+  if (settings.use_overviews)
   {
-    GDALRasterBand *band = dataset->GetRasterBand(i);
-    CPLErr error_code = band->RasterIO(GF_Write, 0, 0, cols, rows, img_bands[i - 1].data, cols, rows, pix_type, 0, 0);
-
-    if (error_code != CE_None)
-      throw(std::runtime_error("Error saving GeoTIFF: Unhandled error code."));
-
-    if (img.type() == CV_8UC1 || img.type() == CV_8UC2 || img.type() == CV_8UC1 || img.type() == CV_8UC4)
-      band->SetNoDataValue(0);
-    else if (img.type() == CV_16UC1)
-      band->SetNoDataValue(0);
-    else if (img.type() == CV_32F)
-      band->SetNoDataValue(std::numeric_limits<float>::quiet_NaN());
-    else if (img.type() == CV_64F)
-      band->SetNoDataValue(std::numeric_limits<double>::quiet_NaN());
-
-    if (bands == 1)
-      band->SetColorInterpretation(GCI_GrayIndex);
-    else
+    std::vector<int> levels = computeOverviewLevels(cols, rows, settings.block_size);
+    if (!levels.empty())
     {
-      switch (i)
-      {
-        case 1:
-          band->SetColorInterpretation(GCI_BlueBand);
-          break;
-        case 2:
-          band->SetColorInterpretation(GCI_GreenBand);
-          break;
-        case 3:
-          band->SetColorInterpretation(GCI_RedBand);
-          break;
-        case 4:
-          band->SetColorInterpretation(GCI_AlphaBand);
-          break;
-        default:
-          break;
-      }
+      const char *resampling = (useAveragingForOverviews(img.type()) ? "AVERAGE" : "NEAREST");
+      if (dataset_mem->BuildOverviews(resampling, (int)levels.size(), levels.data(), 0, nullptr, nullptr, nullptr) == CE_None)
+        has_overviews = true;
+      else
+        LOG_F(WARNING, "Building overviews for '%s' failed. Saving without overviews.", filename);
     }
   }
 
+  char **options = nullptr;
+  options = CSLSetNameValue(options, "TILED", "YES");
+  options = CSLSetNameValue(options, "BLOCKXSIZE", std::to_string(settings.block_size).c_str());
+  options = CSLSetNameValue(options, "BLOCKYSIZE", std::to_string(settings.block_size).c_str());
+  options = CSLSetNameValue(options, "INTERLEAVE", "PIXEL");
+  options = CSLSetNameValue(options, "BIGTIFF", "IF_SAFER");
+  if (settings.compression != "NONE")
+  {
+    options = CSLSetNameValue(options, "COMPRESS", settings.compression.c_str());
+    options = CSLSetNameValue(options, "PREDICTOR", (pix_type == GDT_Float32 || pix_type == GDT_Float64) ? "3" : "2");
+  }
+  if (has_overviews)
+    options = CSLSetNameValue(options, "COPY_SRC_OVERVIEWS", "YES");
+
+  GDALDriver *driver = GetGDALDriverManager()->GetDriverByName("GTiff");
+  GDALDataset *dataset = driver->CreateCopy(filename, dataset_mem, FALSE, options, nullptr, nullptr);
+  CSLDestroy(options);
+  GDALClose((GDALDatasetH) dataset_mem);
+
+  if (dataset == nullptr)
+    throw(std::runtime_error("Error saving GeoTIFF: Writing '" + std::string(filename) + "' failed."));
+
   GDALClose((GDALDatasetH) dataset);
-}
\ No newline at end of file
+}
@@ -32,6 +32,24 @@ namespace realm
 namespace io
 {
 
+namespace
+{
+
+/*!
+ * @brief Elevation layer as single precision data. Float layers are shared, double layers are converted once.
+ */
+cv::Mat getElevationAsFloat(const CvGridMap &map, const std::string &ele_layer_name)
+{
+  const cv::Mat &elevation = map[ele_layer_name];
+  if (elevation.type() == CV_32F)
+    return elevation;
+  cv::Mat elevation_float;
+  elevation.convertTo(elevation_float, CV_32F);
+  return elevation_float;
+}
+
+} // namespace
+
 void saveElevationPointsToPLY(const CvGridMap &map,
                               const std::string &ele_layer_name,
                               const std::string &normals_layer_name,
@@ -76,7 +94,9 @@ void saveElevationPointsRGB(const CvGridMap &map,
   cv::Size2i size = map.size();
   auto n = static_cast<uint32_t>(size.width*size.height);
 
-  cv::Mat elevation = map[ele_layer_name];
+  LayerHandle<const float> elevation(getElevationAsFloat(map, ele_layer_name));
+  cv::Rect2d roi = map.roi();
+  double resolution = map.resolution();
   cv::Mat mask = map[mask_layer_name];
   cv::Mat color = map[color_layer_name];
   if (color.type() == CV_8UC4)
@@ -96,7 +116,9 @@ void saveElevationPointsRGB(const CvGridMap &map,
       if (mask.at<uchar>(r, c) == 0)
         continue;
 
-      cv::Point3d pt = map.atPosition3d(r, c, "elevation");
+      cv::Point3d pt(roi.x + static_cast<double>(c)*resolution,
+                     roi.y + roi.height - static_cast<double>(r)*resolution,
+                     static_cast<double>(elevation(r, c)));
       cv::Vec3b bgr = color.at<cv::Vec3b>(r, c);
 
       pcl::PointXYZRGB pt_rgb;
@@ -131,7 +153,9 @@ void saveElevationPointsRGBNormal(const CvGridMap &map,
   cv::Size2i size = map.size();
   auto n = static_cast<uint32_t>(size.width*size.height);
 
-  cv::Mat elevation = map[ele_layer_name];
+  LayerHandle<const float> elevation(getElevationAsFloat(map, ele_layer_name));
+  cv::Rect2d roi = map.roi();
+  double resolution = map.resolution();
   cv::Mat elevation_normals = map[normals_layer_name];
   cv::Mat mask = map[mask_layer_name];
   cv::Mat color = map[color_layer_name];
@@ -152,7 +176,9 @@ void saveElevationPointsRGBNormal(const CvGridMap &map,
       if (mask.at<uchar>(r, c) == 0)
         continue;
 
-      cv::Point3d pt = map.atPosition3d(r, c, "elevation");
+      cv::Point3d pt(roi.x + static_cast<double>(c)*resolution,
+                     roi.y + roi.height - static_cast<double>(r)*resolution,
+                     static_cast<double>(elevation(r, c)));
       cv::Vec3f normal = elevation_normals.at<cv::Vec3f>(r, c);
       cv::Vec3b bgr = color.at<cv::Vec3b>(r, c);
 
@@ -204,7 +230,9 @@ void saveElevationMeshToPLY(const CvGridMap &map,
   cv::Size2i size = map.size();
   auto n = static_cast<uint32_t>(size.width*size.height);
 
-  cv::Mat elevation = map[ele_layer_name];
+  LayerHandle<const float> elevation(getElevationAsFloat(map, ele_layer_name));
+  cv::Rect2d roi = map.roi();
+  double resolution = map.resolution();
   cv::Mat elevation_normals = map[normal_layer_name];
   cv::Mat mask = map[mask_layer_name];
   cv::Mat color = map[color_layer_name];
@@ -226,7 +254,9 @@ void saveElevationMeshToPLY(const CvGridMap &map,
       if (mask.at<uchar>(r, c) == 0)
         continue;
 
-      cv::Point3d pt = map.atPosition3d(r, c, "elevation");
+      cv::Point3d pt(roi.x + static_cast<double>(c)*resolution,
+                     roi.y + roi.height - static_cast<double>(r)*resolution,
+                     static_cast<double>(elevation(r, c)));
       cv::Vec3f normal = elevation_normals.at<cv::Vec3f>(r, c);
       cv::Vec3b bgr = color.at<cv::Vec3b>(r, c);
 
@@ -18,6 +18,8 @@
 * along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+
 #include <realm_io/utilities.h>
 
 using namespace realm;
@@ -103,4 +105,22 @@ std::vector<std::string> io::split(const char *str, char c)
   while (0 != *str++);
 
   return result;
+}
+
+std::vector<std::string> io::getFileList(const std::string &directory)
+{
+  std::vector<std::string> file_names;
+  if (!directory.empty())
+  {
+    boost::filesystem::path apk_path(directory);
+    boost::filesystem::recursive_directory_iterator end;
+
+    for (boost::filesystem::recursive_directory_iterator it(apk_path); it != end; ++it)
+    {
+      const boost::filesystem::path cp = (*it);
+      file_names.push_back(cp.string());
+    }
+  }
+  std::sort(file_names.begin(), file_names.end());
+  return file_names;
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <realm_io/async_writer.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+namespace
+{
+
+/*!
+ * @brief Occupies the only worker of a writer until released, so the following jobs stay in the queue
+ */
+class WorkerGate
+{
+  public:
+    explicit WorkerGate(io::AsyncWriter &writer)
+    {
+      std::shared_future<void> released = _released.get_future().share();
+      auto started = std::make_shared<std::promise<void>>();
+      std::future<void> is_started = started->get_future();
+      writer.enqueue("gate", [=](){ started->set_value(); released.wait(); });
+      is_started.wait();
+    }
+    void release() { _released.set_value(); }
+
+  private:
+    std::promise<void> _released;
+};
+
+} // namespace
+
+TEST(AsyncWriter, Ordering)
+{
+  // With a single worker jobs are written in the order they were queued. Latency of every job is recorded.
+  metrics::Histogram::Ptr latency = metrics::Registry::instance().histogram("async_writer_test_latency_ms");
+  metrics::Gauge::Ptr queue_depth = metrics::Registry::instance().gauge("async_writer_test_queue_depth");
+  latency->reset();
+
+  io::AsyncWriter writer(1, 100, io::AsyncWriter::OverflowPolicy::BLOCK);
+  writer.setMetrics(queue_depth, latency);
+
+  std::vector<int> written;
+  for (int i = 0; i < 50; ++i)
+    EXPECT_TRUE(writer.enqueue("job", [i, &written](){ written.push_back(i); }));
+  writer.flush();
+
+  ASSERT_EQ(written.size(), 50u);
+  for (int i = 0; i < 50; ++i)
+    EXPECT_EQ(written[i], i);
+
+  io::AsyncWriter::Statistics stats = writer.getStatistics();
+  EXPECT_EQ(stats.num_written, 50u);
+  EXPECT_EQ(stats.num_dropped, 0u);
+  EXPECT_EQ(stats.queue_depth, 0u);
+  EXPECT_EQ(latency->snapshot().count, 50u);
+  EXPECT_EQ(queue_depth->value(), 0);
+}
+
+TEST(AsyncWriter, QueueFullDrop)
+{
+  // Worker is blocked, so the queue of size two is full after two jobs. The third job is either discarded itself or
+  // replaces the oldest queued job.
+  for (auto policy : {io::AsyncWriter::OverflowPolicy::DROP_NEWEST, io::AsyncWriter::OverflowPolicy::DROP_OLDEST})
+  {
+    io::AsyncWriter writer(1, 2, policy);
+    WorkerGate gate(writer);
+
+    std::vector<int> written;
+    EXPECT_TRUE(writer.enqueue("job_0", [&written](){ written.push_back(0); }));
+    EXPECT_TRUE(writer.enqueue("job_1", [&written](){ written.push_back(1); }));
+    bool is_queued = writer.enqueue("job_2", [&written](){ written.push_back(2); });
+
+    gate.release();
+    writer.flush();
+
+    if (policy == io::AsyncWriter::OverflowPolicy::DROP_NEWEST)
+    {
+      EXPECT_FALSE(is_queued);
+      EXPECT_EQ(written, std::vector<int>({0, 1}));
+    }
+    else
+    {
+      EXPECT_TRUE(is_queued);
+      EXPECT_EQ(written, std::vector<int>({1, 2}));
+    }
+    EXPECT_EQ(writer.getStatistics().num_dropped, 1u);
+  }
+}
+
+TEST(AsyncWriter, QueueFullBlock)
+{
+  // Caller is blocked while the queue is full and continues as soon as the worker takes the next job. Nothing is lost.
+  io::AsyncWriter writer(1, 2, io::AsyncWriter::OverflowPolicy::BLOCK);
+  WorkerGate gate(writer);
+
+  std::vector<int> written;
+  writer.enqueue("job_0", [&written](){ written.push_back(0); });
+  writer.enqueue("job_1", [&written](){ written.push_back(1); });
+  std::future<bool> is_queued = std::async(std::launch::async, [&writer, &written]()
+  {
+    return writer.enqueue("job_2", [&written](){ written.push_back(2); });
+  });
+
+  EXPECT_EQ(is_queued.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+  gate.release();
+  EXPECT_TRUE(is_queued.get());
+  writer.flush();
+
+  EXPECT_EQ(written, std::vector<int>({0, 1, 2}));
+  EXPECT_EQ(writer.getStatistics().num_dropped, 0u);
+}
+
+TEST(AsyncWriter, DestructionFlushes)
+{
+  // Jobs still queued when the writer is destroyed are written before the workers are joined
+  std::atomic<int> counter(0);
+  {
+    io::AsyncWriter writer(2, 20, io::AsyncWriter::OverflowPolicy::BLOCK);
+    for (int i = 0; i < 20; ++i)
+      writer.enqueue("job", [&counter](){ std::this_thread::sleep_for(std::chrono::milliseconds(5)); counter++; });
+  }
+  EXPECT_EQ(counter.load(), 20);
+}
+
+TEST(AsyncWriter, NotDroppable)
+{
+  // Jobs queued as not droppable are skipped by DROP_OLDEST and block instead of being dropped by DROP_NEWEST
+  {
+    io::AsyncWriter writer(1, 2, io::AsyncWriter::OverflowPolicy::DROP_OLDEST);
+    WorkerGate gate(writer);
+
+    std::vector<int> written;
+    writer.enqueue("job_0", [&written](){ written.push_back(0); }, false);
+    writer.enqueue("job_1", [&written](){ written.push_back(1); });
+    EXPECT_TRUE(writer.enqueue("job_2", [&written](){ written.push_back(2); }));
+
+    gate.release();
+    writer.flush();
+    EXPECT_EQ(written, std::vector<int>({0, 2}));
+  }
+  {
+    io::AsyncWriter writer(1, 2, io::AsyncWriter::OverflowPolicy::DROP_NEWEST);
+    WorkerGate gate(writer);
+
+    std::vector<int> written;
+    writer.enqueue("job_0", [&written](){ written.push_back(0); });
+    writer.enqueue("job_1", [&written](){ written.push_back(1); });
+    std::future<bool> is_queued = std::async(std::launch::async, [&writer, &written]()
+    {
+      return writer.enqueue("job_2", [&written](){ written.push_back(2); }, false);
+    });
+
+    EXPECT_EQ(is_queued.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+    gate.release();
+    EXPECT_TRUE(is_queued.get());
+    writer.flush();
+    EXPECT_EQ(written, std::vector<int>({0, 1, 2}));
+    EXPECT_EQ(writer.getStatistics().num_dropped, 0u);
+  }
+}
@@ -0,0 +1,116 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+
+#include <realm_core/cv_grid_map.h>
+#include <realm_io/gis_export.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+namespace
+{
+
+/*!
+ * @brief Reads the full resolution data of a GeoTIFF pixel interleaved into a cv::Mat of given type
+ */
+cv::Mat readGeoTIFF(const std::string &filename, int type)
+{
+  auto dataset = (GDALDataset*) GDALOpen(filename.c_str(), GA_ReadOnly);
+  if (dataset == nullptr)
+    return cv::Mat();
+
+  cv::Mat img(dataset->GetRasterYSize(), dataset->GetRasterXSize(), type);
+  CPLErr error_code = dataset->RasterIO(GF_Read, 0, 0, img.cols, img.rows, (void*)img.data, img.cols, img.rows, GDT_Byte,
+                                        img.channels(), nullptr, static_cast<GSpacing>(img.elemSize()),
+                                        static_cast<GSpacing>(img.step[0]), static_cast<GSpacing>(img.elemSize1()),
+                                        nullptr);
+  GDALClose((GDALDatasetH) dataset);
+  return (error_code == CE_None ? img : cv::Mat());
+}
+
+bool isIdentical(const cv::Mat &img1, const cv::Mat &img2)
+{
+  if (img1.size() != img2.size() || img1.type() != img2.type())
+    return false;
+  cv::Mat diff;
+  cv::absdiff(img1, img2, diff);
+  return cv::countNonZero(diff.reshape(1)) == 0;
+}
+
+} // namespace
+
+TEST(GisExport, UpdateGeoTIFF)
+{
+  // Only the dirty region is passed and the tiles around it are rewritten, the file must nevertheless be identical to
+  // the map afterwards. If the geometry of the map changed, the file is not touched and has to be written completely.
+  const std::string filename = "/tmp/realm_gis_export_test.tif";
+  std::remove(filename.c_str());
+
+  cv::RNG rng(42);
+  CvGridMap map(cv::Rect2d(1000.0, 2000.0, 599.0, 399.0), 1.0);
+  cv::Mat color(map.size(), CV_8UC4);
+  rng.fill(color, cv::RNG::UNIFORM, 0, 256);
+  map.add("color_rgb", color);
+
+  io::GeoTIFFSettings settings;
+  settings.block_size = 128;
+
+  // Update requires an existing file
+  EXPECT_FALSE(io::updateGeoTIFF(map, "color_rgb", map.roi(), filename));
+  io::saveGeoTIFF(map, "color_rgb", 32, filename, settings);
+  EXPECT_TRUE(isIdentical(readGeoTIFF(filename, CV_8UC4), color));
+
+  // Dirty region in the center, not aligned to the tiles
+  cv::Rect2d roi_dirty(1000.0 + 201.5, 2000.0 + 103.0, 150.0, 90.0);
+  CvGridMap region = map.getSubmap({"color_rgb"}, roi_dirty, false);
+  region["color_rgb"].setTo(cv::Scalar(10, 20, 30, 255));
+
+  EXPECT_TRUE(io::updateGeoTIFF(region, "color_rgb", map.roi(), filename));
+  cv::Mat color_file = readGeoTIFF(filename, CV_8UC4);
+  EXPECT_TRUE(isIdentical(color_file, color));
+
+  // Overviews of the dirty region must have been updated as well
+  auto dataset = (GDALDataset*) GDALOpen(filename.c_str(), GA_ReadOnly);
+  ASSERT_TRUE(dataset != nullptr);
+  GDALRasterBand *band = dataset->GetRasterBand(1);
+  ASSERT_GT(band->GetOverviewCount(), 0);
+  GDALRasterBand *overview = band->GetOverview(0);
+  int factor = color.cols / overview->GetXSize();
+  cv::Point2i center = map.atIndex(cv::Point2d(roi_dirty.x + roi_dirty.width/2, roi_dirty.y + roi_dirty.height/2));
+  uchar value = 0;
+  ASSERT_EQ(overview->RasterIO(GF_Read, center.x / factor, center.y / factor, 1, 1, &value, 1, 1, GDT_Byte, 0, 0), CE_None);
+  EXPECT_EQ(value, 10);
+  GDALClose((GDALDatasetH) dataset);
+
+  // Grown map can not be updated inplace, file is left untouched
+  CvGridMap map_grown(cv::Rect2d(1000.0, 2000.0, 699.0, 399.0), 1.0);
+  cv::Mat color_grown(map_grown.size(), CV_8UC4);
+  rng.fill(color_grown, cv::RNG::UNIFORM, 0, 256);
+  map_grown.add("color_rgb", color_grown);
+
+  EXPECT_FALSE(io::updateGeoTIFF(map_grown.getSubmap({"color_rgb"}, roi_dirty), "color_rgb", map_grown.roi(), filename));
+  EXPECT_TRUE(isIdentical(readGeoTIFF(filename, CV_8UC4), color));
+
+  std::remove(filename.c_str());
+}
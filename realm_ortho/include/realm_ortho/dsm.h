@@ -61,8 +61,9 @@ class DigitalSurfaceModel
      * @param roi Region of interest of the observed surface, usually utm coordinates and width/height in [m]
      * @param elevation A fixed elevation can be set. This is especially useful, if the altitude of  the UAV is not measured
      * above ground.
+     * @param resolution Resolution of the surface grid in [m/cell]. Should be the resolution it is consumed at.
      */
-    explicit DigitalSurfaceModel(const cv::Rect2d &roi, double elevation = 0.0);
+    explicit DigitalSurfaceModel(const cv::Rect2d &roi, double elevation = 0.0, double resolution = 1.0);
 
     /*!
      * @brief Constructor for elevated surfaces, prior informations about the surface must have been computed.
@@ -70,8 +71,12 @@ class DigitalSurfaceModel
      * @param roi Region of interest of the observed surface, usually utm coordinates and width/height in [m]
      * @param points Cloud of observed surface points as Mat structured rowise: x, y, z
      * @param knn_radius_factor Factor for initial knn-search is GSD * knn_radius_factor
+     * @param resolution Resolution of the surface grid in [m/cell]. Elevation is then interpolated once at the
+     *        resolution it is consumed at. If zero, the resolution is estimated from the point cloud. The neighbour
+     *        search is always based on the point cloud GSD, so a finer grid does not create holes.
      */
-    DigitalSurfaceModel(const cv::Rect2d &roi, const cv::Mat &points, SurfaceNormalMode mode, double knn_radius_factor);
+    DigitalSurfaceModel(const cv::Rect2d &roi, const cv::Mat &points, SurfaceNormalMode mode, double knn_radius_factor,
+                        double resolution = 0.0);
 
     CvGridMap::Ptr getSurfaceGrid();
 
@@ -86,6 +91,9 @@ class DigitalSurfaceModel
     //! Radius for nearest neighbour search
     double _knn_radius_factor;
 
+    //! Estimated ground sampling distance of the input point cloud, base of the neighbour search radius
+    double _point_cloud_GSD;
+
     //! Assumption of the DSM. Either planar or elevation
     SurfaceAssumption _assumption;
 
@@ -104,6 +112,9 @@ class DigitalSurfaceModel
     //! Binary k-d tree for NN search. Only in xy-direction (only for elevation surface)
     std::unique_ptr<KdTree_t> _kd_tree;
 
+    //! Row parallel elevation interpolation of the surface grid, see computeElevation(...)
+    class ElevationInvoker;
+
     /*!
      * @brief Initializes a k-d tree from the input point cloud. Important: k-d tree has 2 dimensions due to search in
      *        x- and y-direction only.
@@ -128,8 +139,9 @@ class DigitalSurfaceModel
     cv::Mat filterPointCloud(const cv::Mat &points);
 
     /*!
-     * @brief Main function to compute elevation grid map from an input point cloud. K-d tree must have been initialized
-     *        beforhand.
+     * @brief Main function to compute elevation grid map from an input point cloud. Points are binned once into a
+     *        PointBucketGrid, which is then used for the radius search of all grid elements. Rows of the grid are
+     *        processed in parallel.
      * @param point_cloud Point cloud structured as OpenCV mat type with row(i) = (x,y,z,r,g,b,nx,ny,nz)
      */
     void computeElevation(const cv::Mat &point_cloud);
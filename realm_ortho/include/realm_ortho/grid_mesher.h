@@ -0,0 +1,106 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_GRID_MESHER_H
+#define PROJECT_GRID_MESHER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <realm_core/cv_grid_map.h>
+
+namespace realm
+{
+
+/*!
+ * @brief Mesher for regular grids. Every quad of 2x2 valid grid elements is split into two triangles, so the mesh is
+ * created directly from the valid mask in one row parallel pass without any triangulation. Optionally:
+ * - Borders, where valid elements are not part of a complete quad (isolated elements, diagonal steps, one element
+ *   wide strips), are bridged with a Delaunay triangulation of the border elements only.
+ * - Planar regions are decimated with a quadtree. Blocks of up to max_block_size x max_block_size quads are replaced
+ *   by two triangles, if the elevation inside deviates less than a threshold from the bilinear surface spanned by the
+ *   block corners. Neighbouring blocks of different size are not stitched, gaps at these T-junctions are therefore
+ *   bounded by the threshold.
+ * Output is the same as for Delaunay2D: vertex ids as (col, row) of the grid, three ids form one triangle with counter
+ * clockwise order in the world frame.
+ */
+class GridMesher
+{
+  public:
+    using Ptr = std::shared_ptr<GridMesher>;
+    using ConstPtr = std::shared_ptr<const GridMesher>;
+
+    /*!
+     * @brief Settings of the grid mesher
+     * @var fill_borders Flag if valid elements not covered by a complete quad should be bridged by Delaunay triangles
+     * @var max_bridge_length Maximum edge length of bridging triangles in [grid cells], longer ones are discarded
+     * @var th_planarity Maximum elevation deviation in [m] for decimation of a block, zero disables decimation
+     * @var max_block_size Maximum edge length of decimated blocks in [grid cells], must be a power of two
+     */
+    struct Settings
+    {
+        bool fill_borders;
+        double max_bridge_length;
+        double th_planarity;
+        int max_block_size;
+    };
+
+  public:
+    /*!
+     * @brief Constructor
+     * @param settings Settings of the mesher
+     * @throws invalid_argument if max_block_size is not a positive power of two
+     */
+    explicit GridMesher(const Settings &settings);
+
+    /*!
+     * @brief Creates the triangles of the grid
+     * @param grid Grid map to be meshed
+     * @param mask Name of the mask layer (CV_8UC1) for valid elements, all elements are used if empty
+     * @param layer_elevation Name of the elevation layer (CV_32F), only needed for decimation
+     * @return Vertex ids as (col, row) of the grid, three ids always form one triangle
+     * @throws invalid_argument if decimation is enabled and the elevation layer does not exist or is not CV_32F
+     */
+    std::vector<cv::Point2i> buildMesh(const CvGridMap &grid,
+                                       const std::string &mask = "",
+                                       const std::string &layer_elevation = "elevation") const;
+
+  private:
+    Settings _settings;
+
+    /*!
+     * @brief Triangulates the borders, see class description
+     * @param grid Grid map to be meshed
+     * @param valid Binary mask of valid grid elements
+     * @param quads Binary mask of all quads with four valid corners, indexed by their upper left element
+     * @param vertex_ids Output; bridging triangles are appended
+     */
+    void bridgeBorders(const CvGridMap &grid,
+                       const cv::Mat &valid,
+                       const cv::Mat &quads,
+                       std::vector<cv::Point2i> &vertex_ids) const;
+};
+
+} // namespace realm
+
+#endif //PROJECT_GRID_MESHER_H
@@ -0,0 +1,107 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_POINT_BUCKET_GRID_H
+#define PROJECT_POINT_BUCKET_GRID_H
+
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include <opencv2/core.hpp>
+
+namespace realm
+{
+
+/*!
+ * @brief Uniform bucket grid as spatial index for the xy-coordinates of a point cloud. Points are binned once into
+ * square buckets with counting sort, all point coordinates of one bucket are stored contiguously. A radius search then
+ * only visits the buckets overlapping the search circle, which for a bucket size close to the search radius are at
+ * most 3x3 buckets. Compared to a k-d tree no traversal is necessary and no memory is allocated during the search, as
+ * long as the result container has enough capacity. Searches are const and can be run from multiple threads.
+ * Points with non-finite xy-coordinates are not indexed.
+ */
+class PointBucketGrid
+{
+  public:
+    using Ptr = std::shared_ptr<PointBucketGrid>;
+    using ConstPtr = std::shared_ptr<const PointBucketGrid>;
+
+    //! Result of a search as (row index of the point, squared xy-distance to the query)
+    using Neighbour = std::pair<int, double>;
+
+  public:
+    /*!
+     * @brief Constructor, bins all points into the buckets
+     * @param points Point cloud as OpenCV mat of type CV_64F structured rowise: x, y, ... Only x and y are used.
+     * @param bucket_size Edge length of one bucket in [m], ideally the typical search radius
+     * @throws invalid_argument if points are not of type CV_64F with at least two columns or bucket size is not positive
+     */
+    PointBucketGrid(const cv::Mat &points, double bucket_size);
+
+    /*!
+     * @brief Finds all points with a squared xy-distance to the query position below the squared radius. Criterion is
+     * identical to nanoflann's RadiusResultSet with L2 metric. Order of the result is not specified.
+     * @param x Query position x
+     * @param y Query position y
+     * @param radius_sq Squared search radius
+     * @param result Output; cleared and filled with all neighbours found
+     */
+    void radiusSearch(double x, double y, double radius_sq, std::vector<Neighbour> &result) const;
+
+    /*!
+     * @brief Getter for the number of points indexed by the grid
+     * @return number of points
+     */
+    size_t getNumberOfPoints() const;
+
+    /*!
+     * @brief Getter for the edge length of the buckets. Might be larger than requested, if the extent of the point
+     * cloud would result in excessive numbers of empty buckets
+     * @return bucket size in [m]
+     */
+    double getBucketSize() const;
+
+  private:
+
+    //! Edge length of one bucket
+    double _bucket_size;
+
+    //! Lower left corner of the bucket grid, identical to the minimum xy-coordinates of the points
+    double _x_min;
+    double _y_min;
+
+    //! Number of buckets in x and y direction
+    int _cols;
+    int _rows;
+
+    //! Index of the first point of each bucket in the sorted containers, last element is the number of points
+    std::vector<int> _bucket_offsets;
+
+    //! Row index of each point in the input mat, sorted by bucket
+    std::vector<int> _indices;
+
+    //! Interleaved xy-coordinates of each point, sorted by bucket
+    std::vector<double> _xy;
+};
+
+} // namespace realm
+
+#endif //PROJECT_POINT_BUCKET_GRID_H
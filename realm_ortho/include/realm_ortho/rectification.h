@@ -25,6 +25,8 @@
 #include <string>
 #include <cmath>
 
+#include <opencv2/imgproc.hpp>
+
 #include <realm_core/structs.h>
 #include <realm_core/frame.h>
 #include <realm_core/cv_grid_map.h>
@@ -40,25 +42,24 @@ namespace ortho
  * @param surface container for the surface structure, also known as digital surface model (DSM). Current implementation
  *        needs a layer named "elevation", which is further used for backprojection from grid structure.
  * @param map_rect result is written into this parameter, it contains the layer "color_rgb" and "observation angle"
+ * @param interpolation Sampling of the image colors, either cv::INTER_NEAREST, cv::INTER_LINEAR or cv::INTER_CUBIC
  */
-void rectify(const Frame::Ptr &frame, CvGridMap &map);
+void rectify(const Frame::Ptr &frame, CvGridMap &map, int interpolation = cv::INTER_NEAREST);
 
 /*!
  * @brief Projects every element of a grid structure with its world coordinate consisting of (utm east, utm north,
- *        elevation) back int the camera and sets corresponding value in the grid with the color of the image.
+ *        elevation) back int the camera and sets corresponding value in the grid with the color of the image. Rows of
+ *        the grid are processed in parallel.
  * @param frame container for aerial measurement data. Here mainly the image and the camera model must be set.
  * @param surface container for the surface structure, also known as digital surface model (DSM). Current implementation
  *        needs a layer named "elevation", which is further used for backprojection from grid structure.
  * @param map result is written into this parameter, it contains the layer "color_rgb" and "observation angle"
+ * @param interpolation Sampling of the image colors at the projected position. cv::INTER_NEAREST takes the pixel the
+ *        position falls into, cv::INTER_LINEAR and cv::INTER_CUBIC interpolate between the neighbouring pixel centers.
+ * @throws invalid_argument if interpolation is not one of cv::INTER_NEAREST, cv::INTER_LINEAR, cv::INTER_CUBIC
  */
-void backprojectFromGrid(const Frame::Ptr &frame, CvGridMap &map_rectified);
-
-namespace internal
-{
-
-inline double computeElevationAngle(double t[3], double p[3]);
+void backprojectFromGrid(const Frame::Ptr &frame, CvGridMap &map_rectified, int interpolation = cv::INTER_NEAREST);
 
-} // namespace internal
 } // namespace ortho
 } // namespace realm
 
@@ -18,15 +18,109 @@
 * along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cmath>
+#include <algorithm>
+
+#include <realm_core/loguru.h>
 #include <realm_ortho/dsm.h>
+#include <realm_ortho/point_bucket_grid.h>
 
 #include <opencv2/imgproc.hpp>
 
 using namespace realm;
 
-DigitalSurfaceModel::DigitalSurfaceModel(const cv::Rect2d &roi, double elevation)
+/*!
+ * @brief Interpolates elevation and normal of a range of grid rows from the neighbouring points of the bucket grid.
+ * Scratch containers are allocated once per range and reused for all grid elements.
+ */
+class DigitalSurfaceModel::ElevationInvoker : public cv::ParallelLoopBody
+{
+  public:
+    ElevationInvoker(DigitalSurfaceModel &dsm, const cv::Mat &point_cloud, const PointBucketGrid &bucket_grid,
+                     double radius_sq, cv::Mat &elevation, cv::Mat &valid, cv::Mat &elevation_normal)
+    : _dsm(dsm),
+      _point_cloud(point_cloud),
+      _bucket_grid(bucket_grid),
+      _radius_sq(radius_sq),
+      _use_prior_normals((dsm._surface_normal_mode == SurfaceNormalMode::NONE) && dsm._use_prior_normals),
+      _compute_normals(dsm._surface_normal_mode != SurfaceNormalMode::NONE),
+      _elevation(elevation),
+      _valid(valid),
+      _elevation_normal(elevation_normal)
+    {
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      std::vector<PointBucketGrid::Neighbour> neighbours;
+      std::vector<double> distances;
+      std::vector<double> heights;
+      std::vector<PlaneFitter::Point> points;
+      std::vector<PlaneFitter::Normal> normals_prior;
+      neighbours.reserve(64);
+      distances.reserve(64);
+      heights.reserve(64);
+      points.reserve(64);
+      normals_prior.reserve(64);
+
+      for (int r = range.start; r < range.end; ++r)
+      {
+        auto elevation_row = _elevation.ptr<float>(r);
+        auto valid_row = _valid.ptr<uchar>(r);
+        auto normal_row = _elevation_normal.ptr<cv::Vec3f>(r);
+
+        for (int c = 0; c < _elevation.cols; ++c)
+        {
+          cv::Point2d pt = _dsm._surface->atPosition2d(r, c);
+          _bucket_grid.radiusSearch(pt.x, pt.y, _radius_sq, neighbours);
+
+          // Process only if neighbours were found
+          if (neighbours.size() < 3u)
+            continue;
+
+          distances.clear();
+          heights.clear();
+          points.clear();
+          normals_prior.clear();
+          for (const auto &s : neighbours)
+          {
+            const double* p = _point_cloud.ptr<double>(s.first);
+            distances.push_back(s.second);
+            heights.push_back(p[2]);
+            if (_compute_normals)
+              points.emplace_back(PlaneFitter::Point{p[0], p[1], p[2]});
+            if (_use_prior_normals)
+              normals_prior.emplace_back(PlaneFitter::Normal{p[6], p[7], p[8]});
+          }
+
+          elevation_row[c] = _dsm.interpolateHeight(heights, distances);
+          valid_row[c] = 255;
+
+          if (_use_prior_normals)
+            normal_row[c] = _dsm.interpolateNormal(normals_prior, distances);
+          else if (_compute_normals)
+            normal_row[c] = _dsm.computeSurfaceNormal(points, distances);
+        }
+      }
+    }
+
+  private:
+    DigitalSurfaceModel &_dsm;
+    const cv::Mat &_point_cloud;
+    const PointBucketGrid &_bucket_grid;
+    double _radius_sq;
+    bool _use_prior_normals;
+    bool _compute_normals;
+    cv::Mat &_elevation;
+    cv::Mat &_valid;
+    cv::Mat &_elevation_normal;
+};
+
+DigitalSurfaceModel::DigitalSurfaceModel(const cv::Rect2d &roi, double elevation, double resolution)
 : _is_initialized(false),
   _use_prior_normals(false),
+  _knn_radius_factor(0.0),
+  _point_cloud_GSD(0.0),
   _assumption(SurfaceAssumption::PLANAR),
   _surface_normal_mode(SurfaceNormalMode::NONE)
 {
@@ -34,8 +128,10 @@ DigitalSurfaceModel::DigitalSurfaceModel(const cv::Rect2d &roi, double elevation
   // Therefore based region of interest a grid
   // map is created and filled with zeros.
   // Resolution is assumed to be 1.0m as default
+  if (resolution < 10e-6)
+    throw(std::invalid_argument("Error: Resolution of planar surface must be positive!"));
   _surface = std::make_shared<CvGridMap>();
-  _surface->setGeometry(roi, 1.0);
+  _surface->setGeometry(roi, resolution);
   _surface->add("elevation", cv::Mat::ones(_surface->size(), CV_32FC1)*elevation);
   _surface->add("valid", cv::Mat::ones(_surface->size(), CV_8UC1)*255);
   _is_initialized = true;
@@ -44,10 +140,12 @@ DigitalSurfaceModel::DigitalSurfaceModel(const cv::Rect2d &roi, double elevation
 DigitalSurfaceModel::DigitalSurfaceModel(const cv::Rect2d &roi,
                                          const cv::Mat& points,
                                          SurfaceNormalMode mode,
-                                         double knn_radius_factor)
+                                         double knn_radius_factor,
+                                         double resolution)
     : _is_initialized(false),
       _use_prior_normals(false),
       _knn_radius_factor(knn_radius_factor),
+      _point_cloud_GSD(0.0),
       _assumption(SurfaceAssumption::ELEVATION),
       _surface_normal_mode(mode)
 {
@@ -58,7 +156,7 @@ DigitalSurfaceModel::DigitalSurfaceModel(const cv::Rect2d &roi,
   // 0) Filter input point cloud for outlier
   // 1) Create a Kd-tree of the observed point cloud
   // 2) Estimate resolution of the point cloud
-  // 3) Create a grid map based on the previously computed resolution
+  // 3) Create a grid map based on the previously computed resolution or the one requested by the consumer
 
   // Check if prior normals were computed and can be used
   if (points.cols >= 9)
@@ -80,11 +178,11 @@ DigitalSurfaceModel::DigitalSurfaceModel(const cv::Rect2d &roi,
   initKdTree(_point_cloud);
 
   // 2) Estimate resolution based on the point cloud
-  double GSD_estimated = computePointCloudGSD(_point_cloud);
+  _point_cloud_GSD = computePointCloudGSD(_point_cloud);
 
   // 3) Create grid map based on point cloud resolution and surface info
   _surface = std::make_shared<CvGridMap>();
-  _surface->setGeometry(roi, GSD_estimated);
+  _surface->setGeometry(roi, (resolution > 0.0 ? resolution : _point_cloud_GSD));
   computeElevation(points_filtered);
 
   _is_initialized = true;
@@ -157,7 +255,7 @@ double DigitalSurfaceModel::computePointCloudGSD(const PointCloud<double> &point
   std::vector<double> tmp_dists(2);
 
   // Iterate through the point cloud and compute nearest neighbour distance
-  auto n_iter = static_cast<size_t>(0.01 * n);
+  auto n_iter = std::max(static_cast<size_t>(0.01 * n), static_cast<size_t>(1));
   dists.reserve(n/n_iter+1);
   for (size_t i = 0; i < n; i+=n_iter)
   {
@@ -196,53 +294,21 @@ void DigitalSurfaceModel::computeElevation(const cv::Mat &point_cloud)
   // Optional computation according to flag
   cv::Mat elevation_normal(size, CV_32FC3, cv::Scalar(0.0, 0.0, 0.0));
 
-  for (uint32_t r = 0; r < size.height; ++r)
-    for (uint32_t c = 0; c < size.width; ++c)
-    {
-      cv::Point2d pt = _surface->atPosition2d(r, c);
-      std::vector<double> query_pt{pt.x, pt.y, 0.0};
+  // Neighbours are all points with a squared xy-distance below this threshold. Points are binned once into buckets of
+  // the search radius, so every search visits at most 3x3 buckets. Threshold depends on the density of the point cloud,
+  // not on the resolution of the grid.
+  const double radius_sq = _knn_radius_factor * _point_cloud_GSD;
 
-      // Prepare kd-search for nearest neighbors
-      double lambda = 1.0;
-      std::vector<std::pair<int, double>> indices_dists;
-      nanoflann::RadiusResultSet<double, int> result_set(lambda * _knn_radius_factor * _surface->resolution(), indices_dists);
-
-      // Process neighbor search, if no neighbors are found, extend search distance
-      do
-      {
-        _kd_tree->findNeighbors(result_set, &query_pt[0], nanoflann::SearchParams());
-        lambda *= 1.5;
-      } while (result_set.size() == 0u && (lambda * 1.0 < 3.0*1.0));
-
-      // Process only if neighbours were found
-      if (result_set.size() >= 3u)
-      {
-        std::vector<double> distances;
-        std::vector<double> heights;
-        std::vector<PlaneFitter::Point> points;
-        std::vector<PlaneFitter::Normal> normals_prior;
-        for (const auto &s : result_set.m_indices_dists)
-        {
-          distances.push_back(s.second);
-          heights.push_back(point_cloud.at<double>(s.first, 2));
-          points.emplace_back(PlaneFitter::Point{point_cloud.at<double>(s.first, 0),
-                                                 point_cloud.at<double>(s.first, 1),
-                                                 point_cloud.at<double>(s.first, 2)});
-          if (point_cloud.cols >= 9)
-            normals_prior.emplace_back(PlaneFitter::Normal{point_cloud.at<double>(s.first, 6),
-                                                           point_cloud.at<double>(s.first, 7),
-                                                           point_cloud.at<double>(s.first, 8)});
-        }
-
-        elevation.at<float>(r, c) = interpolateHeight(heights, distances);
-        valid.at<uchar>(r, c) = 255;
-
-        if ((_surface_normal_mode == SurfaceNormalMode::NONE) && _use_prior_normals)
-          elevation_normal.at<cv::Vec3f>(r, c) = interpolateNormal(normals_prior, distances);
-        else if (_surface_normal_mode != SurfaceNormalMode::NONE)
-          elevation_normal.at<cv::Vec3f>(r, c) = computeSurfaceNormal(points, distances);
-      }
-    }
+  // Degenerate clouds, e.g. a single point or duplicates only, have no point spacing and the radius is zero or NaN. No
+  // neighbours can be found then, so all grid elements stay invalid.
+  if (std::isfinite(radius_sq) && std::sqrt(radius_sq) >= 10e-6)
+  {
+    PointBucketGrid bucket_grid(point_cloud, std::sqrt(radius_sq));
+    cv::parallel_for_(cv::Range(0, size.height),
+                      ElevationInvoker(*this, point_cloud, bucket_grid, radius_sq, elevation, valid, elevation_normal));
+  }
+  else
+    LOG_F(WARNING, "Neighbour search radius of %f is degenerate. No elevation computed.", radius_sq);
 
   _surface->add("elevation", elevation);
   _surface->add("valid", valid);
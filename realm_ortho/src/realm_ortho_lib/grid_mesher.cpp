@@ -0,0 +1,322 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <stdexcept>
+
+#include <realm_ortho/grid_mesher.h>
+#include <realm_ortho/delaunay_2d.h>
+
+using namespace realm;
+
+namespace
+{
+
+/*!
+ * @brief Writes the two triangles of a block with upper left element (r, c) and edge length size into the vertex ids
+ * starting at idx. Rows grow south, so counter clockwise in the world frame is e.g. bottom left, bottom right, top right.
+ */
+inline void addBlock(int r, int c, int size, std::vector<cv::Point2i> &vertex_ids, size_t idx)
+{
+  const cv::Point2i tl(c, r), tr(c + size, r), bl(c, r + size), br(c + size, r + size);
+  vertex_ids[idx] = bl;
+  vertex_ids[idx + 1] = br;
+  vertex_ids[idx + 2] = tr;
+  vertex_ids[idx + 3] = bl;
+  vertex_ids[idx + 4] = tr;
+  vertex_ids[idx + 5] = tl;
+}
+
+/*!
+ * @brief Checks if a block of quads can be replaced by two triangles. All quads must be complete and the elevation of
+ * all elements must deviate less than th from the bilinear surface through the four corners.
+ */
+bool isPlanar(const cv::Mat &quads, const cv::Mat &elevation, int r, int c, int size, double th)
+{
+  if (cv::countNonZero(quads(cv::Rect(c, r, size, size))) != size*size)
+    return false;
+
+  const float e00 = elevation.ptr<float>(r)[c];
+  const float e01 = elevation.ptr<float>(r)[c + size];
+  const float e10 = elevation.ptr<float>(r + size)[c];
+  const float e11 = elevation.ptr<float>(r + size)[c + size];
+
+  for (int i = 0; i <= size; ++i)
+  {
+    const float* row = elevation.ptr<float>(r + i);
+    const double fy = static_cast<double>(i)/size;
+    for (int j = 0; j <= size; ++j)
+    {
+      const double fx = static_cast<double>(j)/size;
+      const double e = (1.0 - fy)*((1.0 - fx)*e00 + fx*e01) + fy*((1.0 - fx)*e10 + fx*e11);
+
+      // Negated comparison, so NaN elevations are never considered planar
+      if (!(fabs(row[c + j] - e) <= th))
+        return false;
+    }
+  }
+  return true;
+}
+
+/*!
+ * @brief Quadtree decimation of one block. Planar blocks are replaced by two triangles, all others are split until
+ * single quads remain. Blocks reaching over the border of the grid are always split.
+ */
+void decimateBlock(const cv::Mat &quads, const cv::Mat &elevation, int r, int c, int size, double th,
+                   std::vector<cv::Point2i> &vertex_ids)
+{
+  if (r >= quads.rows || c >= quads.cols)
+    return;
+
+  if (size == 1)
+  {
+    if (quads.ptr<uchar>(r)[c] > 0)
+    {
+      vertex_ids.resize(vertex_ids.size() + 6);
+      addBlock(r, c, 1, vertex_ids, vertex_ids.size() - 6);
+    }
+    return;
+  }
+
+  if (r + size <= quads.rows && c + size <= quads.cols && isPlanar(quads, elevation, r, c, size, th))
+  {
+    vertex_ids.resize(vertex_ids.size() + 6);
+    addBlock(r, c, size, vertex_ids, vertex_ids.size() - 6);
+    return;
+  }
+
+  const int half = size/2;
+  decimateBlock(quads, elevation, r, c, half, th, vertex_ids);
+  decimateBlock(quads, elevation, r, c + half, half, th, vertex_ids);
+  decimateBlock(quads, elevation, r + half, c, half, th, vertex_ids);
+  decimateBlock(quads, elevation, r + half, c + half, half, th, vertex_ids);
+}
+
+class QuadCountInvoker : public cv::ParallelLoopBody
+{
+  public:
+    QuadCountInvoker(const cv::Mat &quads, std::vector<size_t> &counts)
+    : _quads(quads),
+      _counts(counts)
+    {
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      for (int r = range.start; r < range.end; ++r)
+        _counts[r] = static_cast<size_t>(cv::countNonZero(_quads.row(r)));
+    }
+
+  private:
+    const cv::Mat &_quads;
+    std::vector<size_t> &_counts;
+};
+
+/*!
+ * @brief Writes the triangles of all complete quads. Every row starts at an offset computed by a prefix sum over the
+ * quads per row, so the order is the same as for a sequential pass.
+ */
+class QuadFillInvoker : public cv::ParallelLoopBody
+{
+  public:
+    QuadFillInvoker(const cv::Mat &quads, const std::vector<size_t> &offsets, std::vector<cv::Point2i> &vertex_ids)
+    : _quads(quads),
+      _offsets(offsets),
+      _vertex_ids(vertex_ids)
+    {
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      for (int r = range.start; r < range.end; ++r)
+      {
+        const uchar* row = _quads.ptr<uchar>(r);
+        size_t idx = _offsets[r]*6;
+        for (int c = 0; c < _quads.cols; ++c)
+          if (row[c] > 0)
+          {
+            addBlock(r, c, 1, _vertex_ids, idx);
+            idx += 6;
+          }
+      }
+    }
+
+  private:
+    const cv::Mat &_quads;
+    const std::vector<size_t> &_offsets;
+    std::vector<cv::Point2i> &_vertex_ids;
+};
+
+class DecimationInvoker : public cv::ParallelLoopBody
+{
+  public:
+    DecimationInvoker(const cv::Mat &quads, const cv::Mat &elevation, int block_size, double th,
+                      std::vector<std::vector<cv::Point2i>> &block_rows)
+    : _quads(quads),
+      _elevation(elevation),
+      _block_size(block_size),
+      _th(th),
+      _block_rows(block_rows)
+    {
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      for (int i = range.start; i < range.end; ++i)
+        for (int c = 0; c < _quads.cols; c += _block_size)
+          decimateBlock(_quads, _elevation, i*_block_size, c, _block_size, _th, _block_rows[i]);
+    }
+
+  private:
+    const cv::Mat &_quads;
+    const cv::Mat &_elevation;
+    int _block_size;
+    double _th;
+    std::vector<std::vector<cv::Point2i>> &_block_rows;
+};
+
+} // namespace
+
+GridMesher::GridMesher(const Settings &settings)
+: _settings(settings)
+{
+  if (_settings.max_block_size <= 0 || (_settings.max_block_size & (_settings.max_block_size - 1)) != 0)
+    throw(std::invalid_argument("Error: Maximum block size of the grid mesher must be a power of two!"));
+}
+
+std::vector<cv::Point2i> GridMesher::buildMesh(const CvGridMap &grid,
+                                               const std::string &mask,
+                                               const std::string &layer_elevation) const
+{
+  std::vector<cv::Point2i> vertex_ids;
+
+  cv::Size2i size = grid.size();
+  if (size.width < 2 || size.height < 2)
+    return vertex_ids;
+
+  cv::Mat valid;
+  if (mask.empty())
+    valid = cv::Mat(size, CV_8UC1, cv::Scalar(255));
+  else
+    valid = (grid[mask] > 0);
+
+  // Quad (r, c) is spanned by the elements (r, c) to (r+1, c+1) and only meshed if all four corners are valid
+  const int w = size.width - 1;
+  const int h = size.height - 1;
+  cv::Mat quads = valid(cv::Rect(0, 0, w, h)) & valid(cv::Rect(1, 0, w, h))
+                & valid(cv::Rect(0, 1, w, h)) & valid(cv::Rect(1, 1, w, h));
+
+  if (_settings.th_planarity > 0.0)
+  {
+    if (!grid.exists(layer_elevation) || grid[layer_elevation].type() != CV_32F)
+      throw(std::invalid_argument("Error: Layer '" + layer_elevation + "' does not exist or type is wrong."));
+
+    // Rows of top level blocks are decimated in parallel, then concatenated in order
+    const int block_size = _settings.max_block_size;
+    std::vector<std::vector<cv::Point2i>> block_rows(static_cast<size_t>((h + block_size - 1)/block_size));
+    cv::parallel_for_(cv::Range(0, static_cast<int>(block_rows.size())),
+                      DecimationInvoker(quads, grid[layer_elevation], block_size, _settings.th_planarity, block_rows));
+
+    size_t n = 0;
+    for (const auto &block_row : block_rows)
+      n += block_row.size();
+    vertex_ids.reserve(n);
+    for (const auto &block_row : block_rows)
+      vertex_ids.insert(vertex_ids.end(), block_row.begin(), block_row.end());
+  }
+  else
+  {
+    std::vector<size_t> counts(static_cast<size_t>(h));
+    cv::parallel_for_(cv::Range(0, h), QuadCountInvoker(quads, counts));
+
+    std::vector<size_t> offsets(static_cast<size_t>(h) + 1, 0);
+    for (int r = 0; r < h; ++r)
+      offsets[r + 1] = offsets[r] + counts[r];
+
+    vertex_ids.resize(offsets.back()*6);
+    cv::parallel_for_(cv::Range(0, h), QuadFillInvoker(quads, offsets, vertex_ids));
+  }
+
+  if (_settings.fill_borders)
+    bridgeBorders(grid, valid, quads, vertex_ids);
+
+  return vertex_ids;
+}
+
+void GridMesher::bridgeBorders(const CvGridMap &grid,
+                               const cv::Mat &valid,
+                               const cv::Mat &quads,
+                               std::vector<cv::Point2i> &vertex_ids) const
+{
+  // Cells outside the grid count as covered, there is nothing to fill
+  auto isCovered = [&quads](int r, int c) -> bool
+  {
+    if (r < 0 || c < 0 || r >= quads.rows || c >= quads.cols)
+      return true;
+    return quads.ptr<uchar>(r)[c] > 0;
+  };
+
+  // Border elements are all valid elements touching at least one cell without triangles
+  cv::Mat border = cv::Mat::zeros(valid.size(), CV_8UC1);
+  int n_border = 0;
+  for (int r = 0; r < valid.rows; ++r)
+    for (int c = 0; c < valid.cols; ++c)
+      if (valid.ptr<uchar>(r)[c] > 0
+          && !(isCovered(r - 1, c - 1) && isCovered(r - 1, c) && isCovered(r, c - 1) && isCovered(r, c)))
+      {
+        border.ptr<uchar>(r)[c] = 255;
+        n_border++;
+      }
+
+  if (n_border < 3)
+    return;
+
+  CvGridMap grid_border(grid.roi(), grid.resolution());
+  grid_border.add("border", border);
+  std::vector<cv::Point2i> vertex_ids_border = Delaunay2D().buildMesh(grid_border, "border");
+
+  // Triangles are only accepted, if they are small and lie in cells not covered by quads. Points close to the edge
+  // midpoints are checked besides the centroid, so triangles do not reach into neighbouring quads.
+  const double max_length_sq = _settings.max_bridge_length*_settings.max_bridge_length;
+  for (size_t i = 0; i + 2 < vertex_ids_border.size(); i += 3)
+  {
+    const cv::Point2d p[3]{vertex_ids_border[i], vertex_ids_border[i + 1], vertex_ids_border[i + 2]};
+    const cv::Point2d centroid = (p[0] + p[1] + p[2])*(1.0/3.0);
+
+    bool is_accepted = true;
+    for (int k = 0; k < 3 && is_accepted; ++k)
+    {
+      const cv::Point2d d = p[(k + 1) % 3] - p[k];
+      if (d.dot(d) > max_length_sq)
+        is_accepted = false;
+    }
+    for (int k = 0; k < 4 && is_accepted; ++k)
+    {
+      cv::Point2d pt = (k == 3 ? centroid : 0.8*(p[k] + p[(k + 1) % 3])*0.5 + 0.2*centroid);
+      int r = cvFloor(pt.y);
+      int c = cvFloor(pt.x);
+      if (r < 0 || c < 0 || r >= quads.rows || c >= quads.cols || isCovered(r, c))
+        is_accepted = false;
+    }
+
+    if (is_accepted)
+      vertex_ids.insert(vertex_ids.end(), vertex_ids_border.begin() + i, vertex_ids_border.begin() + i + 3);
+  }
+}
@@ -0,0 +1,154 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include <realm_ortho/point_bucket_grid.h>
+
+using namespace realm;
+
+PointBucketGrid::PointBucketGrid(const cv::Mat &points, double bucket_size)
+    : _bucket_size(bucket_size),
+      _x_min(0.0),
+      _y_min(0.0),
+      _cols(0),
+      _rows(0)
+{
+  if (!points.empty() && (points.type() != CV_64F || points.cols < 2))
+    throw(std::invalid_argument("Error: Points for bucket grid must be of type CV_64F with at least x and y column."));
+  if (_bucket_size < 10e-6)
+    throw(std::invalid_argument("Error: Bucket size must be positive!"));
+
+  const int n = points.rows;
+  _bucket_offsets.assign(1, 0);
+  if (n == 0)
+    return;
+
+  // Bounding box of the points. Points with invalid coordinates can never be found by a search and are skipped
+  int n_finite = 0;
+  double x_max = 0.0;
+  double y_max = 0.0;
+  for (int i = 0; i < n; ++i)
+  {
+    const double* pt = points.ptr<double>(i);
+    if (!std::isfinite(pt[0]) || !std::isfinite(pt[1]))
+      continue;
+    if (n_finite == 0)
+    {
+      _x_min = x_max = pt[0];
+      _y_min = y_max = pt[1];
+    }
+    _x_min = std::min(_x_min, pt[0]);
+    _y_min = std::min(_y_min, pt[1]);
+    x_max = std::max(x_max, pt[0]);
+    y_max = std::max(y_max, pt[1]);
+    n_finite++;
+  }
+  if (n_finite == 0)
+    return;
+
+  // Outliers far away from the rest of the cloud would create mostly empty buckets. Therefore the bucket size is
+  // increased until the number of buckets is in the order of the number of points. Searches remain correct, they only
+  // have to check more points per bucket.
+  const double max_buckets = 4.0*n_finite + 1024.0;
+  while ((std::floor((x_max - _x_min) / _bucket_size) + 1.0) * (std::floor((y_max - _y_min) / _bucket_size) + 1.0) > max_buckets)
+    _bucket_size *= 2.0;
+
+  _cols = static_cast<int>(std::floor((x_max - _x_min) / _bucket_size)) + 1;
+  _rows = static_cast<int>(std::floor((y_max - _y_min) / _bucket_size)) + 1;
+
+  // Counting sort of the points into the buckets. First count points per bucket, then compute the offsets through
+  // prefix sum and finally scatter the points into their bucket range
+  std::vector<int> bucket_of_point(static_cast<size_t>(n), -1);
+  _bucket_offsets.assign(static_cast<size_t>(_cols*_rows + 1), 0);
+  for (int i = 0; i < n; ++i)
+  {
+    const double* pt = points.ptr<double>(i);
+    if (!std::isfinite(pt[0]) || !std::isfinite(pt[1]))
+      continue;
+    const int bx = std::min(static_cast<int>((pt[0] - _x_min) / _bucket_size), _cols - 1);
+    const int by = std::min(static_cast<int>((pt[1] - _y_min) / _bucket_size), _rows - 1);
+    bucket_of_point[i] = by*_cols + bx;
+    _bucket_offsets[bucket_of_point[i] + 1]++;
+  }
+  for (size_t b = 1; b < _bucket_offsets.size(); ++b)
+    _bucket_offsets[b] += _bucket_offsets[b - 1];
+
+  std::vector<int> fill(_bucket_offsets.begin(), _bucket_offsets.end() - 1);
+  _indices.resize(static_cast<size_t>(n_finite));
+  _xy.resize(2*static_cast<size_t>(n_finite));
+  for (int i = 0; i < n; ++i)
+  {
+    if (bucket_of_point[i] < 0)
+      continue;
+    const double* pt = points.ptr<double>(i);
+    const int pos = fill[bucket_of_point[i]]++;
+    _indices[pos] = i;
+    _xy[2*pos] = pt[0];
+    _xy[2*pos + 1] = pt[1];
+  }
+}
+
+void PointBucketGrid::radiusSearch(double x, double y, double radius_sq, std::vector<Neighbour> &result) const
+{
+  result.clear();
+  if (_indices.empty() || radius_sq <= 0.0)
+    return;
+
+  // Range of buckets overlapping the bounding box of the search circle
+  const double radius = std::sqrt(radius_sq);
+  const double bx_lo = std::floor((x - radius - _x_min) / _bucket_size);
+  const double bx_hi = std::floor((x + radius - _x_min) / _bucket_size);
+  const double by_lo = std::floor((y - radius - _y_min) / _bucket_size);
+  const double by_hi = std::floor((y + radius - _y_min) / _bucket_size);
+  if (bx_hi < 0.0 || by_hi < 0.0 || bx_lo >= _cols || by_lo >= _rows)
+    return;
+
+  const int c_lo = std::max(static_cast<int>(bx_lo), 0);
+  const int c_hi = std::min(static_cast<int>(bx_hi), _cols - 1);
+  const int r_lo = std::max(static_cast<int>(by_lo), 0);
+  const int r_hi = std::min(static_cast<int>(by_hi), _rows - 1);
+
+  for (int r = r_lo; r <= r_hi; ++r)
+  {
+    // Buckets of one row are adjacent in memory, so the whole range is scanned at once
+    const int first = _bucket_offsets[r*_cols + c_lo];
+    const int last = _bucket_offsets[r*_cols + c_hi + 1];
+    for (int i = first; i < last; ++i)
+    {
+      const double dx = x - _xy[2*i];
+      const double dy = y - _xy[2*i + 1];
+      const double dist_sq = dx*dx + dy*dy;
+      if (dist_sq < radius_sq)
+        result.emplace_back(_indices[i], dist_sq);
+    }
+  }
+}
+
+size_t PointBucketGrid::getNumberOfPoints() const
+{
+  return _indices.size();
+}
+
+double PointBucketGrid::getBucketSize() const
+{
+  return _bucket_size;
+}
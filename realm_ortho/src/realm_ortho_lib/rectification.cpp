@@ -18,103 +18,379 @@
 * along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include <opencv2/core.hpp>
+
 #include <realm_core/loguru.h>
 #include <realm_ortho/rectification.h>
 
 using namespace realm;
 
-void ortho::rectify(const Frame::Ptr &frame, CvGridMap &map)
+namespace
+{
+
+/*!
+ * @brief Brown-Conrady lens distortion of pinhole image positions, same model as used by OpenCV for undistortion.
+ */
+struct LensDistortion
+{
+    float fx, fy, cx, cy;
+    float k1, k2, p1, p2, k3;
+
+    /*!
+     * @brief Distorts n undistorted image positions. Positions follow OpenCV's convention, so the center of pixel
+     * (u, v) is at (u, v). The loop is branch free and vectorized by the compiler.
+     * @param x Undistorted x positions
+     * @param y Undistorted y positions
+     * @param xd Output; distorted x positions in the raw image
+     * @param yd Output; distorted y positions in the raw image
+     * @param n Number of positions
+     */
+    void apply(const float* x, const float* y, float* xd, float* yd, int n) const
+    {
+      const float inv_fx = 1.0f / fx;
+      const float inv_fy = 1.0f / fy;
+      for (int i = 0; i < n; ++i)
+      {
+        const float xn = (x[i] - cx)*inv_fx;
+        const float yn = (y[i] - cy)*inv_fy;
+        const float r2 = xn*xn + yn*yn;
+        const float radial = 1.0f + r2*(k1 + r2*(k2 + r2*k3));
+        const float xdn = xn*radial + 2.0f*p1*xn*yn + p2*(r2 + 2.0f*xn*xn);
+        const float ydn = yn*radial + p1*(r2 + 2.0f*yn*yn) + 2.0f*p2*xn*yn;
+        xd[i] = xdn*fx + cx;
+        yd[i] = ydn*fy + cy;
+      }
+    }
+};
+
+/*!
+ * @brief Input and output data of the backprojection. Headers are grabbed once, so no string lookup happens during
+ * the actual projection loop.
+ */
+struct BackprojectionData
 {
-  backprojectFromGrid(frame, map);
+    cv::Mat img;
+    cv::Mat P;
+    cv::Mat t;
+    cv::Rect2d roi;
+    double GSD;
+    int interpolation;
+    bool has_distortion;
+    LensDistortion distortion;
+    uchar is_elevated;
+    cv::Mat elevation;
+    cv::Mat valid_elevation;
+    cv::Mat color_data;
+    cv::Mat elevation_angle;
+    cv::Mat elevated;
+    cv::Mat num_observations;
+    cv::Mat valid_rect;
+};
+
+/*!
+ * @brief Color of the pixel the position (x, y) falls into. Position must be inside the image.
+ */
+inline cv::Vec4b sampleNearest(const cv::Mat &img, float x, float y)
+{
+  return img.ptr<cv::Vec4b>(static_cast<int>(y))[static_cast<int>(x)];
 }
 
-void ortho::backprojectFromGrid(const Frame::Ptr &frame, CvGridMap &map_rectified)
+/*!
+ * @brief Bilinear interpolation between the four pixel centers surrounding (x, y). Projected positions follow OpenCV's
+ * convention, so the center of pixel (u, v) is at (u, v). Pixels outside the image are replicated from the border,
+ * which matches cv::remap with cv::BORDER_REPLICATE.
+ */
+inline cv::Vec4b sampleBilinear(const cv::Mat &img, float x, float y)
 {
-  // Implementation details:
-  // Implementation is chosen as a compromise between readability and performance. Especially the raw array operations
-  // could be implemented in opencv. However depending on the resolution of the surface grid and the image the loop
-  // iterations can go up to several millions. To keep the computation time as low as possible for this performance sink,
-  // the style is as follows
-  CvGridMap::Ptr observed_map = frame->getObservedMap();
+  const int u0 = cvFloor(x);
+  const int v0 = cvFloor(y);
+  const float fx = x - static_cast<float>(u0);
+  const float fy = y - static_cast<float>(v0);
 
-  if (!observed_map->exists("elevation") || (*observed_map)["elevation"].type() != CV_32F)
-    throw(std::invalid_argument("Error: Layer 'elevation' does not exist or type is wrong."));
-  if (!observed_map->exists("valid") || (*observed_map)["valid"].type() != CV_8UC1)
-    throw(std::invalid_argument("Error: Layer 'valid' does not exist or type is wrong"));
+  const int u[2] = {std::max(u0, 0), std::min(u0 + 1, img.cols - 1)};
+  const cv::Vec4b* row0 = img.ptr<cv::Vec4b>(std::max(v0, 0));
+  const cv::Vec4b* row1 = img.ptr<cv::Vec4b>(std::min(v0 + 1, img.rows - 1));
 
-  // Prepare projection, use raw arrays for performance
-  cv::Mat img = frame->getImageUndistorted();
-  cv::Mat cv_P = frame->getCamera()->P();
-  double P[3][4] = {cv_P.at<double>(0, 0), cv_P.at<double>(0, 1), cv_P.at<double>(0, 2), cv_P.at<double>(0, 3),
-                    cv_P.at<double>(1, 0), cv_P.at<double>(1, 1), cv_P.at<double>(1, 2), cv_P.at<double>(1, 3),
-                    cv_P.at<double>(2, 0), cv_P.at<double>(2, 1), cv_P.at<double>(2, 2), cv_P.at<double>(2, 3)};
+  cv::Vec4b result;
+  for (int ch = 0; ch < 4; ++ch)
+  {
+    const float top = row0[u[0]][ch] + fx*(row0[u[1]][ch] - row0[u[0]][ch]);
+    const float bottom = row1[u[0]][ch] + fx*(row1[u[1]][ch] - row1[u[0]][ch]);
+    result[ch] = cv::saturate_cast<uchar>(top + fy*(bottom - top));
+  }
+  return result;
+}
 
-  // Prepare elevation angle calculation
-  cv::Mat t_pose = frame->getCamera()->t();
-  double t[3] = {t_pose.at<double>(0), t_pose.at<double>(1), t_pose.at<double>(2)};
+/*!
+ * @brief Cubic convolution weights with the same kernel coefficient as used by OpenCV (A = -0.75)
+ * @param t Fractional offset to the second of the four support points
+ * @param w Output; weights of the four support points
+ */
+inline void computeCubicWeights(float t, float w[4])
+{
+  const float A = -0.75f;
+  w[0] = ((A*(t + 1) - 5*A)*(t + 1) + 8*A)*(t + 1) - 4*A;
+  w[1] = ((A + 2)*t - (A + 3))*t*t + 1;
+  w[2] = ((A + 2)*(1 - t) - (A + 3))*(1 - t)*(1 - t) + 1;
+  w[3] = 1.0f - w[0] - w[1] - w[2];
+}
 
-  // Get data from container
-  double GSD = observed_map->resolution();
-  uchar is_elevated = (frame->getSurfaceAssumption() == SurfaceAssumption::PLANAR ? (uchar)0 : (uchar)255);
-  cv::Rect2d roi = observed_map->roi();
-  cv::Mat elevation = observed_map->get("elevation");
-  cv::Mat valid_elevation = observed_map->get("valid");
-
-  // Prepare resulting color layer data
-  cv::Mat color_data = cv::Mat::zeros(observed_map->size(), CV_8UC4);
-  cv::Mat elevation_angle = cv::Mat::zeros(observed_map->size(), CV_32F);
-  cv::Mat elevated = cv::Mat::zeros(observed_map->size(), CV_8UC1);
-  cv::Mat num_observations = cv::Mat::zeros(observed_map->size(), CV_16UC1);
-  cv::Mat valid_rect = cv::Mat::zeros(observed_map->size(), CV_8UC1);
+/*!
+ * @brief Bicubic interpolation of the 4x4 pixel centers surrounding (x, y). Pixel convention and border handling are
+ * the same as for sampleBilinear(...).
+ */
+inline cv::Vec4b sampleBicubic(const cv::Mat &img, float x, float y)
+{
+  const int u0 = cvFloor(x);
+  const int v0 = cvFloor(y);
 
-  LOG_F(INFO, "Processing rectification:");
-  LOG_F(INFO, "- ROI (%f, %f, %f, %f)", roi.x, roi.y, roi.width, roi.height);
-  LOG_F(INFO, "- Dimensions: %i x %i", elevation.rows, elevation.cols);
+  float wx[4], wy[4];
+  computeCubicWeights(x - static_cast<float>(u0), wx);
+  computeCubicWeights(y - static_cast<float>(v0), wy);
 
-  // Iterate through
-  for (uint32_t r = 0; r < elevation.rows; ++r)
-    for (uint32_t c = 0; c < elevation.cols; ++c)
+  int u[4];
+  for (int i = 0; i < 4; ++i)
+    u[i] = std::min(std::max(u0 - 1 + i, 0), img.cols - 1);
+
+  float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (int j = 0; j < 4; ++j)
+  {
+    const cv::Vec4b* row = img.ptr<cv::Vec4b>(std::min(std::max(v0 - 1 + j, 0), img.rows - 1));
+    for (int ch = 0; ch < 4; ++ch)
     {
-      auto elevation_val = static_cast<double>(elevation.at<float>(r, c));
+      const float val = wx[0]*row[u[0]][ch] + wx[1]*row[u[1]][ch] + wx[2]*row[u[2]][ch] + wx[3]*row[u[3]][ch];
+      sum[ch] += wy[j]*val;
+    }
+  }
+  return cv::Vec4b(cv::saturate_cast<uchar>(sum[0]), cv::saturate_cast<uchar>(sum[1]),
+                   cv::saturate_cast<uchar>(sum[2]), cv::saturate_cast<uchar>(sum[3]));
+}
+
+/*!
+ * @brief Row parallel backprojection of the grid into the image.
+ * Projection is computed relative to the projection center C, so x ~ M * (X - C) with M being the left 3x3 block of P.
+ * The differences (X - C) are small compared to the absolute utm coordinates, which allows float arithmetic without
+ * noticeable loss of precision. In addition the northing of a row is constant, therefore its contribution to the
+ * projection is computed once per row. Each row is then processed in two passes:
+ * 1) Branch free projection and elevation angle of all elements into contiguous row buffers. This loop has no data
+ *    dependency between elements and is vectorized by the compiler.
+ * 2) Validity check and color lookup, which need the scattered image access. Colors are sampled with the
+ *    interpolation set in the data.
+ * If the camera has lens distortion, the projected positions are distorted in between both passes and the colors are
+ * sampled from the raw image directly. The grid therefore never requires a full undistorted copy of the image.
+ */
+class BackprojectionInvoker : public cv::ParallelLoopBody
+{
+  public:
+    explicit BackprojectionInvoker(const BackprojectionData &data)
+    : _data(data)
+    {
+      const cv::Mat &P = data.P;
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+          _M[i][j] = static_cast<float>(P.at<double>(i, j));
 
-      if (valid_elevation.at<uchar>(r, c) == 0)
+      // Projection center from P = [M | p4] with p4 = -M * C
+      cv::Mat C = -P.colRange(0, 3).inv() * P.col(3);
+      for (int i = 0; i < 3; ++i)
       {
-        elevation.at<float>(r, c) = std::numeric_limits<float>::quiet_NaN();
-        continue;
+        _C[i] = C.at<double>(i);
+        _t[i] = data.t.at<double>(i);
       }
-      double pt[3]{roi.x+(double)c*GSD, roi.y+roi.height-(double)r*GSD, elevation_val};
-      double z = P[2][0]*pt[0]+P[2][1]*pt[1]+P[2][2]*pt[2]+P[2][3]*1.0;
-      double x = (P[0][0]*pt[0]+P[0][1]*pt[1]+P[0][2]*pt[2]+P[0][3]*1.0)/z;
-      double y = (P[1][0]*pt[0]+P[1][1]*pt[1]+P[1][2]*pt[2]+P[1][3]*1.0)/z;
-      if (x > 0.0 && x < img.cols && y > 0.0 && y < img.rows)
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      const int cols = _data.elevation.cols;
+      const int img_cols = _data.img.cols;
+      const int img_rows = _data.img.rows;
+      const float GSD = static_cast<float>(_data.GSD);
+      const uchar is_elevated = _data.is_elevated;
+      const int interpolation = _data.interpolation;
+      const cv::Mat &img = _data.img;
+      const float rad2deg = static_cast<float>(180.0/M_PI);
+
+      // Offsets of the first column to the projection center and the pose translation
+      const auto dx0 = static_cast<float>(_data.roi.x - _C[0]);
+      const auto dx0_t = static_cast<float>(_data.roi.x - _t[0]);
+      const auto cz = static_cast<float>(_C[2]);
+      const auto tz = static_cast<float>(_t[2]);
+
+      // Row buffers for the first pass. Sampling positions are the projected positions themselves, if no distortion
+      // has to be applied
+      std::vector<float> buf_x(cols), buf_y(cols), buf_angle(cols);
+      float* x = buf_x.data();
+      float* y = buf_y.data();
+      float* angle = buf_angle.data();
+
+      std::vector<float> buf_xd, buf_yd;
+      const float* xs = x;
+      const float* ys = y;
+      if (_data.has_distortion)
       {
-        color_data.at<cv::Vec4b>(r, c) = img.at<cv::Vec4b>((int)y, (int)x);
-        elevation_angle.at<float>(r, c) = static_cast<float>(ortho::internal::computeElevationAngle(t, pt));
-        elevated.at<uchar>(r, c) = is_elevated;
-        num_observations.at<uint16_t>(r, c) = 1;
-        valid_rect.at<uchar>(r, c) = 255;
+        buf_xd.resize(cols);
+        buf_yd.resize(cols);
+        xs = buf_xd.data();
+        ys = buf_yd.data();
       }
-      else
+
+      for (int r = range.start; r < range.end; ++r)
       {
-        elevation.at<float>(r, c) = std::numeric_limits<float>::quiet_NaN();
+        float* elevation = _data.elevation.ptr<float>(r);
+        const uchar* valid_elevation = _data.valid_elevation.ptr<uchar>(r);
+        cv::Vec4b* color_data = _data.color_data.ptr<cv::Vec4b>(r);
+        float* elevation_angle = _data.elevation_angle.ptr<float>(r);
+        uchar* elevated = _data.elevated.ptr<uchar>(r);
+        uint16_t* num_observations = _data.num_observations.ptr<uint16_t>(r);
+        uchar* valid_rect = _data.valid_rect.ptr<uchar>(r);
+
+        // Row constant parts of the projection
+        const double northing = _data.roi.y + _data.roi.height - static_cast<double>(r)*_data.GSD;
+        const auto dy = static_cast<float>(northing - _C[1]);
+        const auto dy_t = static_cast<float>(northing - _t[1]);
+        const float a0 = _M[0][1]*dy, a1 = _M[1][1]*dy, a2 = _M[2][1]*dy;
+        const float dy_t2 = dy_t*dy_t;
+
+        for (int c = 0; c < cols; ++c)
+        {
+          const float dx = dx0 + static_cast<float>(c)*GSD;
+          const float dz = elevation[c] - cz;
+          const float inv_z = 1.0f / (_M[2][0]*dx + _M[2][2]*dz + a2);
+          x[c] = (_M[0][0]*dx + _M[0][2]*dz + a0)*inv_z;
+          y[c] = (_M[1][0]*dx + _M[1][2]*dz + a1)*inv_z;
+
+          const float dx_t = dx0_t + static_cast<float>(c)*GSD;
+          angle[c] = atan2f(fabsf(tz - elevation[c]), sqrtf(dx_t*dx_t + dy_t2))*rad2deg;
+        }
+
+        if (_data.has_distortion)
+          _data.distortion.apply(x, y, buf_xd.data(), buf_yd.data(), cols);
+
+        for (int c = 0; c < cols; ++c)
+        {
+          // Coverage is limited to the undistorted image frame in any case. Far outside of it the distortion polynomial
+          // is not monotonic anymore and might fold positions back into the image.
+          if (valid_elevation[c] != 0 && x[c] > 0.0f && x[c] < img_cols && y[c] > 0.0f && y[c] < img_rows
+              && xs[c] > 0.0f && xs[c] < img_cols && ys[c] > 0.0f && ys[c] < img_rows)
+          {
+            switch (interpolation)
+            {
+              case cv::INTER_LINEAR:
+                color_data[c] = sampleBilinear(img, xs[c], ys[c]);
+                break;
+              case cv::INTER_CUBIC:
+                color_data[c] = sampleBicubic(img, xs[c], ys[c]);
+                break;
+              default:
+                color_data[c] = sampleNearest(img, xs[c], ys[c]);
+                break;
+            }
+            elevation_angle[c] = angle[c];
+            elevated[c] = is_elevated;
+            num_observations[c] = 1;
+            valid_rect[c] = 255;
+          }
+          else
+          {
+            elevation[c] = std::numeric_limits<float>::quiet_NaN();
+          }
+        }
       }
     }
 
+  private:
+    const BackprojectionData &_data;
+
+    // Left 3x3 block of the projection matrix
+    float _M[3][3];
+
+    // Projection center and pose translation in world frame
+    double _C[3];
+    double _t[3];
+};
+
+} // namespace
+
+void ortho::rectify(const Frame::Ptr &frame, CvGridMap &map, int interpolation)
+{
+  backprojectFromGrid(frame, map, interpolation);
+}
+
+void ortho::backprojectFromGrid(const Frame::Ptr &frame, CvGridMap &map_rectified, int interpolation)
+{
+  // Implementation details:
+  // Depending on the resolution of the surface grid and the image the loop iterations can go up to several millions.
+  // To keep the computation time as low as possible for this performance sink, rows are processed in parallel by
+  // BackprojectionInvoker. See there for details of the per row computation.
+  CvGridMap::Ptr observed_map = frame->getObservedMap();
+
+  if (!observed_map->exists("elevation") || (*observed_map)["elevation"].type() != CV_32F)
+    throw(std::invalid_argument("Error: Layer 'elevation' does not exist or type is wrong."));
+  if (!observed_map->exists("valid") || (*observed_map)["valid"].type() != CV_8UC1)
+    throw(std::invalid_argument("Error: Layer 'valid' does not exist or type is wrong"));
+
+  // Lens distortion is applied to the projected grid positions, so colors are sampled from the raw image directly
+  // instead of undistorting the full image first
+  camera::Pinhole::Ptr cam = frame->getCamera();
+  cv::Mat img = frame->getImageRaw();
+  if (img.type() != CV_8UC4)
+    throw(std::invalid_argument("Error: Image must be of type CV_8UC4."));
+  if (interpolation != cv::INTER_NEAREST && interpolation != cv::INTER_LINEAR && interpolation != cv::INTER_CUBIC)
+    throw(std::invalid_argument("Error: Interpolation for rectification must be nearest, linear or cubic."));
+
+  BackprojectionData data;
+  data.img = img;
+  data.P = cam->P();
+  data.t = cam->t();
+  data.has_distortion = cam->hasDistortion();
+  if (data.has_distortion)
+  {
+    data.distortion.fx = static_cast<float>(cam->fx());
+    data.distortion.fy = static_cast<float>(cam->fy());
+    data.distortion.cx = static_cast<float>(cam->cx());
+    data.distortion.cy = static_cast<float>(cam->cy());
+    data.distortion.k1 = static_cast<float>(cam->k1());
+    data.distortion.k2 = static_cast<float>(cam->k2());
+    data.distortion.p1 = static_cast<float>(cam->p1());
+    data.distortion.p2 = static_cast<float>(cam->p2());
+    data.distortion.k3 = static_cast<float>(cam->k3());
+  }
+  data.roi = observed_map->roi();
+  data.GSD = observed_map->resolution();
+  data.interpolation = interpolation;
+  data.is_elevated = (frame->getSurfaceAssumption() == SurfaceAssumption::PLANAR ? (uchar)0 : (uchar)255);
+
+  // Get data from container
+  data.elevation = observed_map->get("elevation");
+  data.valid_elevation = observed_map->get("valid");
+
+  // Prepare resulting layer data. Elements are only written for successfully projected grid elements, all others
+  // remain zero
+  data.color_data = cv::Mat::zeros(observed_map->size(), CV_8UC4);
+  data.elevation_angle = cv::Mat::zeros(observed_map->size(), CV_32F);
+  data.elevated = cv::Mat::zeros(observed_map->size(), CV_8UC1);
+  data.num_observations = cv::Mat::zeros(observed_map->size(), CV_16UC1);
+  data.valid_rect = cv::Mat::zeros(observed_map->size(), CV_8UC1);
+
+  LOG_F(INFO, "Processing rectification:");
+  LOG_F(INFO, "- ROI (%f, %f, %f, %f)", data.roi.x, data.roi.y, data.roi.width, data.roi.height);
+  LOG_F(INFO, "- Dimensions: %i x %i", data.elevation.rows, data.elevation.cols);
+
+  cv::parallel_for_(cv::Range(0, data.elevation.rows), BackprojectionInvoker(data));
+
   LOG_F(INFO, "Image successfully rectified.");
 
   if (map_rectified.empty())
     map_rectified.setGeometry(observed_map->roi(), observed_map->resolution());
 
-  map_rectified.add("color_rgb", color_data);
-  map_rectified.add("elevation_angle", elevation_angle);
-  map_rectified.add("elevated", elevated);
-  map_rectified.add("num_observations", num_observations);
-  map_rectified.add("valid", valid_rect);
+  map_rectified.add("color_rgb", data.color_data);
+  map_rectified.add("elevation_angle", data.elevation_angle);
+  map_rectified.add("elevated", data.elevated);
+  map_rectified.add("num_observations", data.num_observations);
+  map_rectified.add("valid", data.valid_rect);
 }
-
-double ortho::internal::computeElevationAngle(double *t, double *p)
-{
-  double v[3]{t[0]-p[0], t[1]-p[1], t[2]-p[2]};
-  double v_length = sqrt(v[0]*v[0]+v[1]*v[1]+v[2]*v[2]);
-  return acos(sqrt(v[0]*v[0]+v[1]*v[1])/v_length)*180/3.1415;
-}
\ No newline at end of file
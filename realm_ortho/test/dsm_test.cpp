@@ -0,0 +1,48 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <memory>
+
+#include <realm_ortho/dsm.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+TEST(DigitalSurfaceModel, DegenerateCloud)
+{
+  // Clouds without any point spacing give no neighbour search radius. All grid elements must stay invalid instead of
+  // aborting the surface generation.
+  cv::Rect2d roi(-5.0, -5.0, 10.0, 10.0);
+
+  cv::Mat point_single = (cv::Mat_<double>(1, 3) << 0.0, 0.0, 10.0);
+  cv::Mat points_duplicate = cv::repeat(point_single, 200, 1);
+
+  for (const cv::Mat &points : {point_single, points_duplicate})
+  {
+    std::unique_ptr<DigitalSurfaceModel> dsm;
+    ASSERT_NO_THROW(dsm.reset(new DigitalSurfaceModel(roi, points, DigitalSurfaceModel::SurfaceNormalMode::NONE, 2.0, 1.0)));
+
+    CvGridMap::Ptr surface = dsm->getSurfaceGrid();
+    ASSERT_TRUE(surface->exists("valid"));
+    EXPECT_EQ(cv::countNonZero((*surface)["valid"]), 0);
+  }
+}
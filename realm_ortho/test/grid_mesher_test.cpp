@@ -0,0 +1,136 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <vector>
+
+#include <realm_ortho/grid_mesher.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+namespace
+{
+
+/*!
+ * @brief Computes the signed area of a triangle in the world frame, positive for counter clockwise order
+ */
+double computeSignedArea(const CvGridMap &grid, const cv::Point2i &a, const cv::Point2i &b, const cv::Point2i &c)
+{
+  cv::Point2d pa = grid.atPosition2d(a.y, a.x);
+  cv::Point2d pb = grid.atPosition2d(b.y, b.x);
+  cv::Point2d pc = grid.atPosition2d(c.y, c.x);
+  return 0.5*((pb - pa).cross(pc - pa));
+}
+
+} // namespace
+
+TEST(GridMesher, FullyValidGrid)
+{
+  // Every quad of a fully valid grid is split into two triangles of half a cell, all counter clockwise in the world
+  CvGridMap grid(cv::Rect2d(0.0, 0.0, 9.0, 6.0), 0.5);
+  const int n = grid.size().height;
+  const int m = grid.size().width;
+
+  GridMesher mesher(GridMesher::Settings{false, 3.0, 0.0, 32});
+  std::vector<cv::Point2i> vertex_ids = mesher.buildMesh(grid);
+
+  ASSERT_EQ(vertex_ids.size(), static_cast<size_t>(3*2*(n - 1)*(m - 1)));
+  for (size_t i = 0; i < vertex_ids.size(); i += 3)
+    EXPECT_NEAR(computeSignedArea(grid, vertex_ids[i], vertex_ids[i + 1], vertex_ids[i + 2]), 0.125, 1e-9);
+}
+
+TEST(GridMesher, DecimationOfPlane)
+{
+  // A tilted plane collapses into two triangles per block of maximum size. A single outlier only splits the smallest
+  // block containing it. The decimated mesh still covers the whole grid without overlaps.
+  CvGridMap grid(cv::Rect2d(0.0, 0.0, 12.0, 8.0), 1.0);
+  cv::Mat elevation(grid.size(), CV_32F);
+  for (int r = 0; r < elevation.rows; ++r)
+    for (int c = 0; c < elevation.cols; ++c)
+    {
+      cv::Point2d pt = grid.atPosition2d(r, c);
+      elevation.at<float>(r, c) = static_cast<float>(10.0 + 0.1*pt.x + 0.05*pt.y);
+    }
+  grid.add("elevation", elevation);
+
+  GridMesher mesher(GridMesher::Settings{false, 3.0, 0.01, 4});
+  std::vector<cv::Point2i> vertex_ids = mesher.buildMesh(grid);
+
+  ASSERT_EQ(vertex_ids.size(), static_cast<size_t>(3*2*3*2));
+  for (size_t i = 0; i < vertex_ids.size(); i += 3)
+    EXPECT_NEAR(computeSignedArea(grid, vertex_ids[i], vertex_ids[i + 1], vertex_ids[i + 2]), 8.0, 1e-9);
+
+  // Outlier inside the upper left 2x2 block of the upper left 4x4 block: 4 quads + 3 blocks of 2x2 + 5 blocks of 4x4
+  grid["elevation"].at<float>(1, 1) += 1.0f;
+  vertex_ids = mesher.buildMesh(grid);
+
+  ASSERT_EQ(vertex_ids.size(), static_cast<size_t>(3*2*(4 + 3 + 5)));
+  double area = 0.0;
+  for (size_t i = 0; i < vertex_ids.size(); i += 3)
+  {
+    double area_triangle = computeSignedArea(grid, vertex_ids[i], vertex_ids[i + 1], vertex_ids[i + 2]);
+    EXPECT_GT(area_triangle, 0.0);
+    area += area_triangle;
+  }
+  EXPECT_NEAR(area, 12.0*8.0, 1e-9);
+}
+
+TEST(GridMesher, BridgeDiagonalStep)
+{
+  // Valid elements form a staircase with one cell steps along the diagonal. Cells on the diagonal have only three valid
+  // corners and are not covered by quads. Bridging must fill exactly these cells with one triangle each.
+  CvGridMap grid(cv::Rect2d(0.0, 0.0, 6.0, 6.0), 1.0);
+  const int n = grid.size().height;
+  cv::Mat valid = cv::Mat::zeros(grid.size(), CV_8UC1);
+  for (int r = 0; r < n; ++r)
+    for (int c = 0; c <= r; ++c)
+      valid.at<uchar>(r, c) = 255;
+  grid.add("valid", valid);
+
+  // Row r of the cells holds r complete quads
+  const size_t n_quads = static_cast<size_t>((n - 1)*(n - 2)/2);
+
+  GridMesher mesher_quads(GridMesher::Settings{false, 1.5, 0.0, 32});
+  EXPECT_EQ(mesher_quads.buildMesh(grid, "valid").size(), 3*2*n_quads);
+
+  GridMesher mesher(GridMesher::Settings{true, 1.5, 0.0, 32});
+  std::vector<cv::Point2i> vertex_ids = mesher.buildMesh(grid, "valid");
+
+  // Bridging triangles are appended after the triangles of the quads
+  ASSERT_EQ(vertex_ids.size(), 3*(2*n_quads + static_cast<size_t>(n - 1)));
+  std::vector<int> n_bridges(static_cast<size_t>(n - 1), 0);
+  for (size_t i = 3*2*n_quads; i < vertex_ids.size(); i += 3)
+  {
+    EXPECT_NEAR(computeSignedArea(grid, vertex_ids[i], vertex_ids[i + 1], vertex_ids[i + 2]), 0.5, 1e-9);
+
+    // Cell of the triangle is the one of its centroid, which must be on the diagonal
+    cv::Point2d centroid = cv::Point2d(vertex_ids[i] + vertex_ids[i + 1] + vertex_ids[i + 2])*(1.0/3.0);
+    int r = cvFloor(centroid.y);
+    int c = cvFloor(centroid.x);
+    EXPECT_EQ(r, c);
+    if (r == c && r >= 0 && r < n - 1)
+      n_bridges[r]++;
+  }
+  for (int count : n_bridges)
+    EXPECT_EQ(count, 1);
+}
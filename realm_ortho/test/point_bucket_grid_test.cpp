@@ -0,0 +1,95 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include <realm_ortho/dsm.h>
+#include <realm_ortho/point_bucket_grid.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+TEST(PointBucketGrid, RadiusSearchMatchesKdTree)
+{
+  // Neighbour sets of the bucket grid must be identical to the ones of the k-d tree it replaced in the DSM. Half of the
+  // points and queries lie exactly on bucket borders, the search radius equals the bucket size. Points at exactly the
+  // search radius are therefore common and must be excluded by both.
+  cv::RNG rng(42);
+  const double bucket_size = 1.0;
+  const double radius_sq = bucket_size*bucket_size;
+
+  cv::Mat points(2000, 3, CV_64F);
+  rng.fill(points, cv::RNG::UNIFORM, 0.0, 50.0);
+  for (int i = 0; i < points.rows; i += 2)
+  {
+    points.at<double>(i, 0) = std::floor(points.at<double>(i, 0));
+    points.at<double>(i, 1) = std::floor(points.at<double>(i, 1));
+  }
+  // Origin of the bucket grid is the minimum of the points, so the borders are on integer coordinates
+  points.at<double>(0, 0) = 0.0;
+  points.at<double>(0, 1) = 0.0;
+
+  PointBucketGrid bucket_grid(points, bucket_size);
+  EXPECT_EQ(bucket_grid.getNumberOfPoints(), static_cast<size_t>(points.rows));
+
+  PointCloud<double> point_cloud;
+  point_cloud.pts.resize(static_cast<size_t>(points.rows));
+  for (int i = 0; i < points.rows; ++i)
+  {
+    point_cloud.pts[i].x = points.at<double>(i, 0);
+    point_cloud.pts[i].y = points.at<double>(i, 1);
+    point_cloud.pts[i].z = points.at<double>(i, 2);
+  }
+  DigitalSurfaceModel::PointCloudAdaptor_t adaptor(point_cloud);
+  DigitalSurfaceModel::KdTree_t kd_tree(DigitalSurfaceModel::kDimensionKdTree, adaptor,
+                                        nanoflann::KDTreeSingleIndexAdaptorParams(DigitalSurfaceModel::kMaxLeaf));
+  kd_tree.buildIndex();
+
+  std::vector<PointBucketGrid::Neighbour> result_grid;
+  std::vector<std::pair<size_t, double>> result_tree;
+  for (int i = 0; i < 1000; ++i)
+  {
+    // Queries also outside of the point cloud's extent
+    double query[3]{rng.uniform(-2.0, 52.0), rng.uniform(-2.0, 52.0), 0.0};
+    if (i % 2 == 0)
+    {
+      query[0] = std::floor(query[0]);
+      query[1] = std::floor(query[1]);
+    }
+
+    bucket_grid.radiusSearch(query[0], query[1], radius_sq, result_grid);
+    result_tree.clear();
+    kd_tree.radiusSearch(&query[0], radius_sq, result_tree, nanoflann::SearchParams());
+
+    ASSERT_EQ(result_grid.size(), result_tree.size());
+
+    std::sort(result_grid.begin(), result_grid.end());
+    std::sort(result_tree.begin(), result_tree.end());
+    for (size_t j = 0; j < result_grid.size(); ++j)
+    {
+      EXPECT_EQ(static_cast<size_t>(result_grid[j].first), result_tree[j].first);
+      EXPECT_DOUBLE_EQ(result_grid[j].second, result_tree[j].second);
+    }
+  }
+}
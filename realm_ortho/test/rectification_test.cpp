@@ -0,0 +1,134 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <algorithm>
+
+#include <opencv2/imgproc.hpp>
+
+#include <realm_core/camera.h>
+#include <realm_core/frame.h>
+#include <realm_ortho/rectification.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+namespace
+{
+
+/*!
+ * @brief Nadir looking camera 100m above the origin with a smooth image. Smooth, so the fixed point interpolation of
+ * cv::remap deviates only slightly from the float interpolation of the backprojection.
+ */
+Frame::Ptr createNadirFrame()
+{
+  cv::Mat K = cv::Mat::eye(3, 3, CV_64F);
+  K.at<double>(0, 0) = 200.0;
+  K.at<double>(1, 1) = 200.0;
+  K.at<double>(0, 2) = 100.0;
+  K.at<double>(1, 2) = 80.0;
+  auto cam = std::make_shared<camera::Pinhole>(K, cv::Mat::zeros(5, 1, CV_64F), 200, 160);
+
+  cv::Mat img(160, 200, CV_8UC4);
+  for (int r = 0; r < img.rows; ++r)
+    for (int c = 0; c < img.cols; ++c)
+    {
+      auto val = cv::saturate_cast<uchar>(128.0 + 100.0*sin(c/7.0)*cos(r/5.0));
+      img.at<cv::Vec4b>(r, c) = cv::Vec4b(val, static_cast<uchar>(c), static_cast<uchar>(r), 255);
+    }
+
+  cv::Mat pose = cv::Mat::zeros(3, 4, CV_64F);
+  pose.at<double>(0, 0) = 1.0;
+  pose.at<double>(1, 1) = -1.0;
+  pose.at<double>(2, 2) = -1.0;
+  pose.at<double>(2, 3) = 100.0;
+
+  UTMPose utm(0.0, 0.0, 100.0, 0.0, 32, 'U');
+  auto frame = std::make_shared<Frame>("DUMMY_CAM", 1, 1234567890, img, utm, cam);
+  frame->setVisualPose(pose);
+
+  // Resolution is no integer fraction of the image footprint, so the grid elements project between pixel centers
+  auto observed_map = std::make_shared<CvGridMap>(cv::Rect2d(-45.0, -35.0, 90.0, 70.0), 0.37);
+  observed_map->add("elevation", cv::Mat::zeros(observed_map->size(), CV_32F));
+  observed_map->add("valid", cv::Mat(observed_map->size(), CV_8UC1, cv::Scalar(255)));
+  frame->setObservedMap(observed_map);
+  return frame;
+}
+
+/*!
+ * @brief Reference rectification: Projects every grid element into the image and samples it with cv::remap
+ */
+cv::Mat remapReference(const Frame::Ptr &frame, int interpolation)
+{
+  CvGridMap::Ptr observed_map = frame->getObservedMap();
+  cv::Mat P = frame->getCamera()->P();
+
+  cv::Mat map_x(observed_map->size(), CV_32F);
+  cv::Mat map_y(observed_map->size(), CV_32F);
+  for (int r = 0; r < map_x.rows; ++r)
+    for (int c = 0; c < map_x.cols; ++c)
+    {
+      cv::Point2d pt = observed_map->atPosition2d(r, c);
+      cv::Mat x = P * (cv::Mat_<double>(4, 1) << pt.x, pt.y, 0.0, 1.0);
+      map_x.at<float>(r, c) = static_cast<float>(x.at<double>(0) / x.at<double>(2));
+      map_y.at<float>(r, c) = static_cast<float>(x.at<double>(1) / x.at<double>(2));
+    }
+
+  cv::Mat color;
+  cv::remap(frame->getImageRaw(), color, map_x, map_y, interpolation, cv::BORDER_REPLICATE);
+  return color;
+}
+
+} // namespace
+
+TEST(Rectification, InterpolationMatchesRemap)
+{
+  // Bilinear and bicubic sampling of the backprojection must match cv::remap on the same projected positions. Any
+  // shift of the pixel convention moves all samples and results in large differences on the image gradients.
+  for (int interpolation : {cv::INTER_LINEAR, cv::INTER_CUBIC})
+  {
+    Frame::Ptr frame = createNadirFrame();
+
+    CvGridMap map_rectified;
+    ortho::backprojectFromGrid(frame, map_rectified, interpolation);
+    cv::Mat expected = remapReference(frame, interpolation);
+
+    const cv::Mat &color = map_rectified["color_rgb"];
+    const cv::Mat &valid = map_rectified["valid"];
+
+    int num_valid = 0;
+    int max_diff = 0;
+    for (int r = 0; r < color.rows; ++r)
+      for (int c = 0; c < color.cols; ++c)
+      {
+        if (valid.at<uchar>(r, c) == 0)
+          continue;
+        num_valid++;
+        for (int ch = 0; ch < 4; ++ch)
+          max_diff = std::max(max_diff, std::abs(color.at<cv::Vec4b>(r, c)[ch] - expected.at<cv::Vec4b>(r, c)[ch]));
+      }
+
+    // Grid covers the image footprint, only elements projecting exactly onto the image border are invalid
+    EXPECT_GT(num_valid, color.rows*color.cols*9/10);
+    EXPECT_LE(max_diff, 2);
+  }
+}
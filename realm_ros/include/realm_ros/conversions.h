@@ -53,6 +53,7 @@
 #include <realm_msgs/CvGridMap.h>
 #include <realm_msgs/Georeference.h>
 #include <realm_msgs/GroundImageCompressed.h>
+#include <realm_msgs/TraceSpan.h>
 
 namespace realm
 {
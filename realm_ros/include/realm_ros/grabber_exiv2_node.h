@@ -102,7 +102,6 @@ class Exiv2GrabberNode
     void readParams();
     void setPaths();
     void pubFrame(const Frame::Ptr &frame);
-    std::vector<std::string> getFileList(const std::string& path);
 };
 
 } // namespace realm
@@ -219,6 +219,16 @@ realm::Frame::Ptr to_realm::frame(const realm_msgs::Frame &msg)
   if (pcl.cols >= 3 && pcl.rows > 5)
     frame->setSurfacePoints(pcl);
 
+  // Trace context is only overwritten, if it was set by the sender. Otherwise the frame enters the pipeline now.
+  if (msg.trace_acquisition.data > 0)
+  {
+    realm::tracing::TraceContext context;
+    context.t_acquisition = msg.trace_acquisition.data;
+    for (const auto &span : msg.trace_spans)
+      context.spans.push_back(realm::tracing::Span{span.name, span.frame_id, span.t_start, span.t_end, span.pid, span.tid});
+    frame->setTraceContext(context);
+  }
+
   return std::move(frame);
 }
 
@@ -436,6 +446,20 @@ realm_msgs::Frame to_ros::frame(const std_msgs::Header &header, const realm::Fra
   if (frame->getSurfaceAssumption() == realm::SurfaceAssumption::ELEVATION)
     msg.is_surface_elevated.data = 1;
 
+  realm::tracing::TraceContext context = frame->getTraceContext();
+  msg.trace_acquisition.data = context.t_acquisition;
+  for (const auto &span : context.spans)
+  {
+    realm_msgs::TraceSpan msg_span;
+    msg_span.name = span.name;
+    msg_span.frame_id = span.frame_id;
+    msg_span.t_start = span.t_start;
+    msg_span.t_end = span.t_end;
+    msg_span.pid = span.pid;
+    msg_span.tid = span.tid;
+    msg.trace_spans.push_back(msg_span);
+  }
+
   return msg;
 }
 
@@ -81,7 +81,7 @@ Exiv2GrabberNode::Exiv2GrabberNode()
   _pub_image = _nh.advertise<sensor_msgs::Image>(_topic_prefix + "/img", 5);
 
   // Start grabbing images
-  _file_list = getFileList(_path_grab);
+  _file_list = io::getFileList(_path_grab);
 }
 
 void Exiv2GrabberNode::readParams()
@@ -156,7 +156,7 @@ void Exiv2GrabberNode::spin()
     _id_curr_file++;
   }
 
-  std::vector<std::string> new_file_list = getFileList(_path_grab);
+  std::vector<std::string> new_file_list = io::getFileList(_path_grab);
   if (new_file_list.size() != _file_list.size())
   {
     ROS_INFO_STREAM("Processed images in folder: " << _file_list.size() << " / " << new_file_list.size());
@@ -185,22 +185,4 @@ void Exiv2GrabberNode::pubFrame(const Frame::Ptr &frame)
 bool Exiv2GrabberNode::isOkay()
 {
   return _nh.ok();
-}
-
-std::vector<std::string> Exiv2GrabberNode::getFileList(const std::string& path)
-{
-  std::vector<std::string> file_names;
-  if (!path.empty())
-  {
-    boost::filesystem::path apk_path(path);
-    boost::filesystem::recursive_directory_iterator end;
-
-    for (boost::filesystem::recursive_directory_iterator it(apk_path); it != end; ++it)
-    {
-      const boost::filesystem::path cp = (*it);
-      file_names.push_back(cp.string());
-    }
-  }
-  std::sort(file_names.begin(), file_names.end());
-  return file_names;
 }
\ No newline at end of file
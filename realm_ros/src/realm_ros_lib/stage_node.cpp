@@ -232,7 +232,16 @@ void StageNode::subFrame(const realm_msgs::Frame &msg)
     return;
   }
 
+  // Conversion from the message is traced, so the transport between the stages is visible in the trace of the frame
+  int64_t t_receive = tracing::Tracer::now();
   Frame::Ptr frame = to_realm::frame(msg);
+  if (tracing::Tracer::instance().isEnabled())
+  {
+    tracing::Span span{_type_stage + "/receive", frame->getFrameId(), t_receive, tracing::Tracer::now(), 0, 0};
+    tracing::Tracer::instance().record(span);
+    frame->addTraceSpan(span);
+  }
+
   if (_is_master_stage)
   {
     if (!_is_tf_base_initialized)
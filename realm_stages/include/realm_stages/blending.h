@@ -0,0 +1,62 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_BLENDING_H
+#define PROJECT_BLENDING_H
+
+#include <realm_core/cv_grid_map.h>
+
+namespace realm
+{
+namespace blending
+{
+
+/*!
+ * @brief Thresholds and flags of the elevation blending of the mosaicing stage
+ * @var th_elevation_var Threshold for the elevation variance, above which a new hypothesis is considered
+ * @var th_elevation_min_nobs Minimum number of observations for a grid element to be marked valid
+ * @var use_surface_normals Flag if "elevation_normal" layers should be blended as well
+ */
+struct Settings
+{
+    float th_elevation_var;
+    int th_elevation_min_nobs;
+    bool use_surface_normals;
+};
+
+/*!
+ * @brief Blends the input map into the reference map inplace. Both maps must have identical size. Rows are processed in
+ * parallel with OpenCV's thread pool, all layers are accessed via contiguous row pointers. Result is identical to
+ * a sequential processing of all grid elements.
+ * Reference needs layers: "elevation", "elevation_var", "elevation_hyp", "elevation_angle", "elevated", "color_rgb",
+ * "num_observations", "valid" and "elevation_normal" if surface normals are used.
+ * Input needs layers: "elevation", "elevation_angle", "elevated", "color_rgb", "valid" and "elevation_normal" if surface
+ * normals are used.
+ * @param ref Reference map, typically the overlapping region of the global map. Data is modified inplace.
+ * @param inp Input map, typically the overlapping region of the newly observed map
+ * @param settings Blending thresholds
+ * @throws invalid_argument if map sizes or layer types do not match
+ */
+void blendOverlap(CvGridMap &ref, const CvGridMap &inp, const Settings &settings);
+
+} // namespace blending
+} // namespace realm
+
+#endif //PROJECT_BLENDING_H
@@ -28,34 +28,56 @@ namespace realm
 {
 
 /*!
- * @brief Function for conversion of visual reconstructed data to a point cloud as cv::Mat with row() = x,y,z,b,g,r,nx,ny,nz
+ * @brief Memory layout of the point clouds created by the conversion functions
+ * BGR_NORMAL_64F: CV_64F with row() = x,y,z,b,g,r,nx,ny,nz and colors in [0,1]. Default format of the framework.
+ * RGB_PACKED_NORMAL_32F: CV_32F with row() = x,y,z,rgb,nx,ny,nz. Color is packed as 0x00RRGGBB into the bits of the
+ *                        float, like it is done for PCL point types. Needs less than half of the memory, but float
+ *                        positions are only suited for local coordinates and not for absolute UTM coordinates.
+ */
+enum class PointCloudFormat
+{
+    BGR_NORMAL_64F,
+    RGB_PACKED_NORMAL_32F
+};
+
+/*!
+ * @brief Function for conversion of visual reconstructed data to a point cloud. The cloud is allocated once and filled
+ *        row parallel, every row writes its points at an offset that is computed by a prefix sum over the valid
+ *        elements per row. The order of the points is therefore the same as for a sequential conversion.
  * @param img3d Matrix with 3 channel double precision data (accessed by cv::Vec3d) for 3d points
- * @param color Color informations
- * @param normals Matrix with 3 channel single precision normal map
- * @param mask Mask for valid elements
- * @return cv::Mat with row() = x,y,z,b,g,r,nx,ny,nz
+ * @param color Color informations (optional), either 1, 3 or 4 channel CV_8U
+ * @param normals Matrix with 3 channel single precision normal map (optional)
+ * @param mask Mask for valid elements (optional), all elements are converted if empty
+ * @param format Memory layout of the resulting point cloud
+ * @return Point cloud with one row per valid element, see PointCloudFormat for the layout
+ * @throws invalid_argument if the number of color channels is not supported
  */
-cv::Mat cvtToPointCloud(const cv::Mat &img3d, const cv::Mat &color, const cv::Mat &normals, const cv::Mat &mask);
+cv::Mat cvtToPointCloud(const cv::Mat &img3d, const cv::Mat &color, const cv::Mat &normals, const cv::Mat &mask,
+                        PointCloudFormat format = PointCloudFormat::BGR_NORMAL_64F);
 
 /*!
- * @brief Function for converting a grid map to a point cloud as cv::Mat with row() = x,y,z,b,g,r,nx,ny,nz
+ * @brief Function for converting a grid map to a point cloud. Positions are computed on the fly from the grid geometry
+ *        and the elevation layer, so no intermediate 3d image is created. See overload for details of the conversion.
  * @param map Grid map with root at global x,y and dimensions of width/height
  * @param layer_elevation Elevation layer: Grid map gives x,y coordinates, layer the elevation/z data.
  * @param layer_color Color layer (optional)
  * @param layer_normals Surface normal corresponding to elevation layer (optional
- * @return cv::Mat with row() = x,y,z,b,g,r,nx,ny,nz
+ * @param layer_mask Mask layer for valid elements (optional)
+ * @param format Memory layout of the resulting point cloud
+ * @return Point cloud with one row per valid element, see PointCloudFormat for the layout
  */
 cv::Mat cvtToPointCloud(const CvGridMap &map,
                         const std::string &layer_elevation,
                         const std::string &layer_color,
                         const std::string &layer_normals,
-                        const std::string &layer_mask);
+                        const std::string &layer_mask,
+                        PointCloudFormat format = PointCloudFormat::BGR_NORMAL_64F);
 
 /*!
  * @brief Function for converting a grid map to a mesh using triangle vertex ids
  * @param map Grid map to be converted into a mesh
- * @param layer_elevation Elevation layer used for height informations
- * @param layer_color Color layer to be used for vertices
+ * @param layer_elevation Elevation layer used for height informations, must be CV_32F
+ * @param layer_color Color layer to be used for vertices, must be CV_8UC4
  * @param vertex_ids Ids of the mesh triangles, 3 ids always form one triangle. Must have been build BEFORE call of this
  *                   function, e.g. with delaunay's "buildMesh"
  * @return Vector of faces
@@ -106,6 +106,9 @@ class Densification : public StageBase
     //! Flag for fallback solution based on sparse cloud interpolation
     bool _use_sparse_depth;
 
+    //! Method to interpolate the sparse depth map
+    densifier::SparseInterpolation _sparse_interpolation;
+
     //! Flag for 3d surface reconstruction
     bool _use_dense_depth;
 
@@ -130,6 +133,9 @@ class Densification : public StageBase
     //! Current frame in class wide processing
     Frame::Ptr _frame_current;
 
+    //! Sparse cloud of the current frame projected into the resized image, reused for densification and masking
+    cv::Mat _depthmap_sparse_current;
+
     //! Minimum depth of the current observed scene
     float _depth_min_current;
 
@@ -23,18 +23,22 @@
 
 #include <deque>
 #include <chrono>
+#include <atomic>
 
 #include <realm_stages/stage_base.h>
 #include <realm_stages/conversions.h>
+#include <realm_stages/blending.h>
 #include <realm_stages/stage_settings.h>
 #include <realm_core/frame.h>
 #include <realm_core/cv_grid_map.h>
+#include <realm_core/cv_grid_map_tiled.h>
 #include <realm_core/analysis.h>
 #include <realm_io/cv_export.h>
 #include <realm_io/pcl_export.h>
 #include "realm_io/gis_export.h"
 #include <realm_io/utilities.h>
 #include <realm_ortho/delaunay_2d.h>
+#include <realm_ortho/grid_mesher.h>
 
 namespace realm
 {
@@ -66,36 +70,6 @@ class Mosaicing : public StageBase
         bool save_dense_ply;
     };
 
-    struct GridQuickAccess
-    {
-      public:
-        using Ptr = std::shared_ptr<GridQuickAccess>;
-        using ConstPtr = std::shared_ptr<const GridQuickAccess>;
-      public:
-        GridQuickAccess(const std::vector<std::string> &layer_names, const CvGridMap &map);
-        void move(int row, int col);
-
-        float* ele;         // elevation at row, col
-        float* var;         // elevation variance at row, col
-        float* hyp;         // elevation hypothesis at row, col
-        float* angle;       // elevation observation angle at row, col
-        uint16_t* nobs;     // number of observations at row, col
-        cv::Vec3f* normal;  // surface normal
-        cv::Vec4b* rgb;     // color at row, col
-        uchar* elevated;    // elevation computed at row, col
-        uchar* valid;       // valid at row, col
-      private:
-        cv::Mat _elevation;
-        cv::Mat _elevation_normal;
-        cv::Mat _elevation_var;
-        cv::Mat _elevation_hyp;
-        cv::Mat _elevation_angle;
-        cv::Mat _elevated;
-        cv::Mat _num_observations;
-        cv::Mat _color_rgb;
-        cv::Mat _valid;
-    };
-
   public:
     explicit Mosaicing(const StageSettings::Ptr &stage_set, double rate);
     void addFrame(const Frame::Ptr &frame) override;
@@ -106,6 +80,10 @@ class Mosaicing : public StageBase
     std::deque<Frame::Ptr> _buffer;
     std::mutex _mutex_buffer;
 
+    //! Publish of the full global map as images. Set >0 to publish every n-th keyframe, 0 disables it.
+    int _publish_map_nth_iter;
+    int _publish_map_every_nth_kf;
+
     //! Publish of mesh is optional. Set >0 if should be published. Additionally it can be downsampled.
     int _publish_mesh_nth_iter;
     int _publish_mesh_every_nth_kf;
@@ -117,27 +95,48 @@ class Mosaicing : public StageBase
     int _th_elevation_min_nobs;
     float _th_elevation_var;
 
+    //! Number of grid cells per tile edge of the global map
+    int _tile_size;
+
     SaveSettings _settings_save;
 
     UTMPose::Ptr _utm_reference;
-    CvGridMap::Ptr _global_map;
-    Delaunay2D::Ptr _mesher;
+    CvGridMapTiled::Ptr _global_map;
 
-    void finishCallback() override;
-    void printSettingsToLog() override;
+    //! State of the incremental GeoTIFF shared with its write job. At most one update is handed to the writer at a
+    //! time, so updates of the same file are never reordered or executed concurrently.
+    struct GeoTIFFState
+    {
+        std::atomic<bool> is_writing;
+        std::atomic<bool> has_failed;
+    };
+    std::shared_ptr<GeoTIFFState> _gtiff_state;
+
+    //! Region changed since the last update of the GeoTIFF was handed to the writer
+    cv::Rect2d _gtiff_roi_dirty;
 
-    CvGridMap blend(CvGridMap::Overlap *overlap);
+    //! Extent of the global map the GeoTIFF was written for, empty if it has to be written completely
+    cv::Rect2d _gtiff_roi_file;
+
+    //! Mesher of the global map, either the regular grid mesher or a full Delaunay triangulation of all valid elements
+    std::string _mesh_method;
+    Delaunay2D::Ptr _mesher_delaunay;
+    GridMesher::Ptr _mesher_grid;
+
+    void finishStageCallback() override;
+    void printSettingsToLog() override;
 
-    void setGridElement(const GridQuickAccess::Ptr &ref, const GridQuickAccess::Ptr &inp);
-    void updateGridElement(const GridQuickAccess::Ptr &ref, const GridQuickAccess::Ptr &inp);
+    void blend(CvGridMap::Overlap *overlap);
 
     void reset() override;
     void initStageCallback() override;
     std::vector<Face> createMeshFaces(const CvGridMap::Ptr &map);
+    std::vector<cv::Point2i> buildMesh(const CvGridMap &map);
 
-    void publish(const Frame::Ptr &frame, const CvGridMap::Ptr &global_map, const CvGridMap::Ptr &update, uint64_t timestamp);
+    void publish(const Frame::Ptr &frame, const CvGridMap::Ptr &update, uint64_t timestamp);
 
-    void saveIter(uint32_t id);
+    void saveIter(uint32_t id, const cv::Rect2d &roi_update);
+    void saveIterGeoTIFF(const cv::Rect2d &roi_update);
     Frame::Ptr getNewFrame();
 };
 
@@ -60,6 +60,8 @@ class OrthoRectification : public StageBase
   private:
 
     double _GSD;
+    std::string _interpolation_name;
+    int _interpolation;
     SaveSettings _settings_save;
 
     std::deque<Frame::Ptr> _buffer;
@@ -72,6 +74,14 @@ class OrthoRectification : public StageBase
     void saveIter(const CvGridMap& map, uint8_t zone, uint32_t id);
     void publish(const Frame::Ptr &frame);
     Frame::Ptr getNewFrame();
+
+    /*!
+     * @brief Converts the interpolation name of the stage settings into the OpenCV flag
+     * @param name "nearest", "bilinear" or "bicubic". Empty name defaults to "nearest"
+     * @return cv::INTER_NEAREST, cv::INTER_LINEAR or cv::INTER_CUBIC
+     * @throws invalid_argument if name is unknown
+     */
+    static int toInterpolationFlag(const std::string &name);
 };
 
 } // namespace stages
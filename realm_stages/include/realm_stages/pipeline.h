@@ -0,0 +1,148 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECT_PIPELINE_H
+#define PROJECT_PIPELINE_H
+
+#include <memory>
+#include <vector>
+#include <string>
+
+#include <realm_stages/stage_base.h>
+#include <realm_stages/stage_settings_factory.h>
+#include <realm_stages/pose_estimation.h>
+#include <realm_stages/densification.h>
+#include <realm_stages/surface_generation.h>
+#include <realm_stages/ortho_rectification.h>
+#include <realm_stages/mosaicing.h>
+#include <realm_core/frame.h>
+#include <realm_core/camera_settings_factory.h>
+#include <realm_vslam_base/visual_slam_settings_factory.h>
+#include <realm_densifier_base/densifier_settings_factory.h>
+#include <realm_io/utilities.h>
+
+namespace realm
+{
+namespace stages
+{
+
+/*!
+ * @brief Runs the complete processing chain PoseEstimation -> Densification -> SurfaceGeneration -> OrthoRectification
+ * -> Mosaicing inside one process. Stages are linked through their frame transport, so frames are handed over as
+ * shared pointers without any serialization, image encoding or copying in between. All other transports (poses, point
+ * clouds, images, ...) are ignored by default. Intended for offline processing without ROS.
+ */
+class Pipeline
+{
+  public:
+    using Ptr = std::shared_ptr<Pipeline>;
+    using ConstPtr = std::shared_ptr<const Pipeline>;
+
+  public:
+    /*!
+     * @brief Constructor loads all settings of the profile and creates the stages. Layout of the profile folder is
+     * the same as for the ROS nodes, e.g. <profile>/<stage type>/stage_settings.yaml,
+     * <profile>/<stage type>/method/<method>_settings.yaml and <profile>/camera/calib.yaml
+     * @param path_profile Absolute path to the profile folder
+     * @param path_output Absolute path to the output folder, a sub directory with current date and time is created
+     * @param method_vslam Name of the visual SLAM method, e.g. "orb_slam2"
+     * @param method_densifier Name of the densifier method, e.g. "psl" or "dummy"
+     * @throws runtime_error if profile folder does not exist
+     */
+    Pipeline(const std::string &path_profile,
+             const std::string &path_output,
+             const std::string &method_vslam,
+             const std::string &method_densifier);
+
+    /*!
+     * @brief Destructor finishes all stages, that are still running
+     */
+    ~Pipeline();
+
+    /*!
+     * @brief Starts the processing threads of all stages
+     */
+    void start();
+
+    /*!
+     * @brief Feeds a new frame into the first stage of the pipeline
+     * @param frame Frame as loaded e.g. by io::Exiv2FrameReader
+     */
+    void addFrame(const Frame::Ptr &frame);
+
+    /*!
+     * @brief Checks if the first stage has processed all frames added so far. Allows to feed frames as fast as the
+     * pipeline accepts them, without overflowing the input queue of the first stage
+     * @return true if the first stage is idle
+     */
+    bool isInputIdle() const;
+
+    /*!
+     * @brief Waits until all stages have processed their pending frames and finishes them afterwards in pipeline
+     * order. Finish callbacks of the stages, e.g. the final save of the mosaic, are therefore executed with all data.
+     * @param t_settle Time in milliseconds all stages must be idle before finishing. Covers frames that are handed
+     * over time delayed, e.g. by the keyframe scheduling of the pose estimation
+     */
+    void finish(int64_t t_settle = 1000);
+
+    /*!
+     * @brief Getter for the camera frame rate read from the profile. Stages are polling with this rate, so frames
+     * should not be added faster
+     * @return Frame rate in [Hz]
+     */
+    double getFps() const;
+
+    /*!
+     * @brief Getter for the output directory of the current run
+     * @return Absolute path to the output directory
+     */
+    std::string getOutputPath() const;
+
+  private:
+
+    //! Flags if start() and finish() were already executed
+    bool _is_started;
+    bool _is_finished;
+
+    //! Frame rate of the camera, also processing rate of the stages
+    double _fps;
+
+    //! Output directory of the current run, <path_output>/<date_time>
+    std::string _path_output;
+
+    //! All stages in pipeline order
+    std::vector<StageBase::Ptr> _stages;
+
+    /*!
+     * @brief Links the frame transport of each stage to the input of the following stage. All other transports are
+     * set to no operation, because they must be set for the stages to work
+     */
+    void linkStages();
+
+    /*!
+     * @brief Requests finish of all stages in pipeline order and joins their threads
+     */
+    void finishStages();
+};
+
+} // namespace stages
+} // namespace realm
+
+#endif //PROJECT_PIPELINE_H
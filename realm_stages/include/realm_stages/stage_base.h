@@ -22,11 +22,13 @@
 #define PROJECT_STAGE_H
 
 #include <iostream>
+#include <atomic>
 #include <functional>
 #include <thread>
 #include <chrono>
 #include <mutex>
 #include <string>
+#include <map>
 
 #include <opencv2/core.hpp>
 
@@ -35,6 +37,10 @@
 #include <realm_core/structs.h>
 #include <realm_core/worker_thread_base.h>
 #include <realm_core/settings_base.h>
+#include <realm_core/metrics.h>
+#include <realm_core/metrics_exporter.h>
+#include <realm_core/tracing.h>
+#include <realm_io/async_writer.h>
 
 namespace realm
 {
@@ -178,6 +184,51 @@ class StageBase : public WorkerThreadBase
     Timer::Ptr _timer_statistics_fps;
     std::mutex _mutex_statistics_fps;
 
+    /*!
+     * @brief Metrics of the stage, registered with prefix "realm_stage_<name>_". Frames are tracked from arrival in
+     * addFrame(...) until they are published or dropped, so the time waiting in the input queue and the overall latency
+     * through the stage can be measured. Frames leaving the stage differently are forgotten once more than
+     * kMaxTrackedFrames are tracked. Trace times are kept additionally, because spans use the system clock to be
+     * comparable across processes. The frame age is the time since acquisition of the frame when it leaves the stage,
+     * for the last stage of the chain this is the end-to-end latency.
+     */
+    metrics::Counter::Ptr _metric_frames_in;
+    metrics::Counter::Ptr _metric_frames_out;
+    metrics::Counter::Ptr _metric_frames_dropped;
+    metrics::Gauge::Ptr _metric_queue_depth;
+    metrics::Histogram::Ptr _metric_queue_wait;
+    metrics::Histogram::Ptr _metric_latency;
+    metrics::Histogram::Ptr _metric_frame_age;
+    metrics::Counter::Ptr _metric_writer_written;
+    metrics::Counter::Ptr _metric_writer_dropped;
+    metrics::Counter::Ptr _metric_writer_failed;
+    metrics::Gauge::Ptr _metric_writer_queue_depth;
+    metrics::Histogram::Ptr _metric_writer_latency;
+    struct FrameTiming
+    {
+        std::chrono::steady_clock::time_point t_arrival;
+        int64_t t_arrival_trace;
+        int64_t t_processing_trace;
+    };
+    std::map<uint32_t, FrameTiming> _frame_timing;
+    std::mutex _mutex_frame_timing;
+    static constexpr size_t kMaxTrackedFrames = 100;
+
+    /*!
+     * @brief Export of all metrics of the process. File is written into the stage path, therefore the export is only
+     * started in "initStagePath".
+     */
+    metrics::Exporter::Ptr _metrics_exporter;
+    int _metrics_period;
+
+    /*!
+     * @brief Tracing of the frames through the stage. If enabled, the spans "<stage>/queue", "<stage>/process" and
+     * "<stage>/transport" are recorded and the first two are appended to the trace context of the frame. The Chrome
+     * trace "trace.json" is rewritten in the stage path with every statistics evaluation.
+     */
+    bool _is_tracing;
+    std::atomic<uint32_t> _frame_id_traced;
+
     /*!
      * @brief Queue size of the added frames. Usually implemented as ringbuffer / fifo
      */
@@ -236,12 +287,103 @@ class StageBase : public WorkerThreadBase
      */
     CvGridMapTransportFunc _transport_cvgridmap;
 
+    /*!
+     * @brief Writer for the save outputs of the stage. If not initialized through "initAsyncWriter", all saves are
+     * executed synchronously inside the processing thread.
+     */
+    io::AsyncWriter::Ptr _async_writer;
+
     /*!
      * @brief Function for creation of all neccessary output directories of the derived stage. Will be called whenever
      * "initStagePath" was triggered.
      */
     virtual void initStageCallback() = 0;
 
+    /*!
+     * @brief Function that every derived stage may implement. Will be called when finish was requested, after all
+     * queued save jobs were written. Final savings should be put here, they are written before finish returns.
+     */
+    virtual void finishStageCallback() {};
+
+    /*!
+     * @brief Writes all queued save jobs before and after the final savings of the derived stage, so all outputs are on
+     * disk once finish was handled
+     */
+    void finishCallback() override;
+
+    /*!
+     * @brief Creates the asynchronous writer for save outputs of the stage. Should be called in the constructor of the
+     * derived stage.
+     * @param num_threads Number of writer threads. If zero or negative, saves are executed synchronously.
+     * @param queue_size Maximum number of queued save jobs
+     * @param overflow_policy Behaviour if queue is full, "block", "drop_newest" or "drop_oldest"
+     */
+    void initAsyncWriter(int num_threads, int queue_size, const std::string &overflow_policy);
+
+    /*!
+     * @brief Executes a save job through the asynchronous writer or directly, if no writer was initialized. Data used
+     * by the job must be captured by value and must not be modified by the stage or following stages afterwards.
+     * Shared data, e.g. the observed map of a frame, should therefore be cloned before.
+     * @param description Short description of the job for logging, e.g. the output name
+     * @param job Function doing the actual save
+     * @param is_droppable Flag if the job may be discarded by the overflow policy of the writer
+     * @return true if the job was queued or executed, false if it was dropped
+     */
+    bool saveAsync(const std::string &description, const io::AsyncWriter::Job &job, bool is_droppable = true);
+
+    /*!
+     * @brief Blocks until all save jobs queued so far were written. Returns immediately, if saves are synchronous.
+     */
+    void flushAsync();
+
+    /*!
+     * @brief Configures the export of the metrics. Should be called in the constructor of the derived stage.
+     * @param period Period in seconds for writing "metrics.txt" into the stage path. Zero or negative disables it.
+     * @param port Port of the local text endpoint on 127.0.0.1. Zero or negative disables it.
+     */
+    void initMetricsExport(int period, int port);
+
+    /*!
+     * @brief Enables tracing of the frames. Should be called in the constructor of the derived stage. Tracing is process
+     * wide, so it stays enabled once one stage of the process requested it.
+     * @param flag true to enable tracing
+     */
+    void initTracing(bool flag);
+
+    /*!
+     * @brief Update function to be called by the derived class when a frame was added. Updates the incoming frame rate
+     * statistic and starts tracking the frame for the latency metrics.
+     * @param frame Frame added to the stage
+     */
+    void updateStatisticsIncoming(const Frame::Ptr &frame);
+
+    /*!
+     * @brief Update function to be called by the derived class when a frame was taken from the input queue for
+     * processing. Records the time the frame was waiting in the queue.
+     * @param frame Frame taken from the queue
+     */
+    void updateStatisticsProcessing(const Frame::Ptr &frame);
+
+    /*!
+     * @brief Update function to be called by the derived class when a frame is published. Updates the outgoing frame
+     * rate statistic and records the latency from arrival until now.
+     * @param frame Frame published by the stage
+     */
+    void updateStatisticsOutgoing(const Frame::Ptr &frame);
+
+    /*!
+     * @brief Update function to be called by the derived class when a frame was dropped, e.g. because the ringbuffer
+     * of the input queue exceeded its size.
+     * @param frame Frame dropped by the stage
+     */
+    void updateStatisticsDropped(const Frame::Ptr &frame);
+
+    /*!
+     * @brief Update function to be called by the derived class whenever the number of queued frames changed
+     * @param depth Current number of frames in the input queue
+     */
+    void updateStatisticsQueueDepth(size_t depth);
+
     /*!
      * @brief Setter for the statistics evaluation period.
      * @param s Period of time in seconds
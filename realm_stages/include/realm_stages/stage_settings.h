@@ -37,6 +37,13 @@ class StageSettings : public SettingsBase
       add("type", Parameter_t<std::string>{"", "Stage type, e.g. pose_estimation, densification, ..."});
       add("queue_size", Parameter_t<int>{5, "Size of the measurement input queue, implemented as ringbuffer"});
       add("path_output", Parameter_t<std::string>{"", "Path to output folder."});
+      add("event_driven", Parameter_t<int>{0, "Flag to process frames as soon as they arrive instead of polling with the frame rate"});
+      add("io_threads", Parameter_t<int>{0, "Number of threads writing save outputs. Zero saves synchronously."});
+      add("io_queue_size", Parameter_t<int>{10, "Maximum number of queued save outputs"});
+      add("io_overflow_policy", Parameter_t<std::string>{"block", "Behaviour on full save queue: block, drop_newest or drop_oldest"});
+      add("metrics_period", Parameter_t<int>{0, "Period in seconds for writing metrics.txt into the stage folder. Zero disables it."});
+      add("metrics_port", Parameter_t<int>{0, "Port of the local metrics text endpoint on 127.0.0.1. Zero disables it."});
+      add("trace", Parameter_t<int>{0, "Flag to trace frames through the stages and write trace.json (Chrome trace) into the stage folder"});
     }
 };
 
@@ -66,6 +73,7 @@ class DensificationSettings : public StageSettings
     DensificationSettings()
     {
       add("use_sparse_disparity", Parameter_t<int>{0, "Flag to use sparse disparity map for pseudo densification."});
+      add("sparse_interpolation", Parameter_t<std::string>{"inpaint", "Interpolation of the sparse disparity map: inpaint or pull_push"});
       add("use_filter_bilat", Parameter_t<int>{0, "Flag to use bilateral filter for disparity map."});
       add("use_filter_guided", Parameter_t<int>{0, "Flag to use guided filter. Only possible with stereo reconstruction."});
       add("compute_normals", Parameter_t<int>{0, "Flag to compute surface normals from disparity map."});
@@ -73,8 +81,8 @@ class DensificationSettings : public StageSettings
       add("save_dense", Parameter_t<int>{0, "Save map produced by stereo reconstruction (if processed)"});
       add("save_guided", Parameter_t<int>{0, "Save disparity map after guided filtering (if processed)"});
       add("save_imgs", Parameter_t<int>{0, "Save processed, resized images"});
-      add("save_sparse", Parameter_t<int>{0, "Save sparse disparity map produced through inpainting (if processed)"});
-      add("save_thumb", Parameter_t<int>{0, "Save sparse disparity map before inpainting (if processed)"});
+      add("save_sparse", Parameter_t<int>{0, "Save sparse disparity map produced through interpolation (if processed)"});
+      add("save_thumb", Parameter_t<int>{0, "Save sparse disparity map before interpolation (if processed)"});
       add("save_normals", Parameter_t<int>{0, "Save surface normals as color map from disparity"});
     }
 };
@@ -86,6 +94,7 @@ class SurfaceGenerationSettings : public StageSettings
     {
       add("try_use_elevation", Parameter_t<int>{0, "Flag for trying to use surface points for elevation map generation"});
       add("knn_radius_factor", Parameter_t<double>{1.0, "Initial search radius for nearest neighbours is GSD * knn_radius_factor"});
+      add("GSD", Parameter_t<double>{0.0, "Resolution of the surface in [m/px]. Zero estimates it from the point cloud"});
       add("mode_surface_normals", Parameter_t<int>{0, "0 - None, 1 - Random neighbours, 2 - Furthest neighbours, 3 - Best-fit"});
       add("save_valid", Parameter_t<int>{0, "Save valid elevation grid element mask"});
       add("save_elevation", Parameter_t<int>{0, "Save elevation map as colored PNG image file"});
@@ -99,6 +108,7 @@ class OrthoRectificationSettings : public StageSettings
     OrthoRectificationSettings()
     {
       add("GSD", Parameter_t<double>{0.0, "Ground sampling distance in [m/px]"});
+      add("interpolation", Parameter_t<std::string>{"nearest", "Color sampling of the image, e.g. nearest, bilinear or bicubic"});
       add("save_valid", Parameter_t<int>{0, "Save valid incremental map grid elements"});
       add("save_ortho_rgb", Parameter_t<int>{0, "Save incremental map ortho foto as PNG image file"});
       add("save_ortho_gtiff", Parameter_t<int>{0, "Save global map ortho foto as one GeoTIFF image file"});
@@ -114,14 +124,21 @@ class MosaicingSettings : public StageSettings
     {
       add("th_elevation_min_nobs", Parameter_t<int>{0, "Threshold for minimum number of observations for elevation point"});
       add("th_elevation_variance", Parameter_t<double>{0.0, "Threshold for elevation variance marking outlier"});
+      add("publish_map_every_nth_kf", Parameter_t<int>{1, "Publish the full global map as images every n keyframes, zero disables it"});
       add("publish_mesh_every_nth_kf", Parameter_t<int>{0, "Activate global map publish every n keyframes as mesh"});
       add("publish_mesh_at_finish", Parameter_t<int>{0, "Activate global map publish as mesh at finishCallback call"});
       add("downsample_publish_mesh", Parameter_t<double>{0.0, "Downsample published mesh to lower GSD for performance. Unit: [m/pix]"});
+      add("mesh_method", Parameter_t<std::string>{"delaunay", "Mesher of the global map: delaunay or grid"});
+      add("mesh_fill_borders", Parameter_t<int>{0, "Grid mesher only: Bridge irregular borders with Delaunay triangles"});
+      add("mesh_th_planarity", Parameter_t<double>{0.0, "Grid mesher only: Max. elevation deviation for decimation of planar regions, zero disables. Unit: [m]"});
+      add("mesh_max_bridge_length", Parameter_t<double>{3.0, "Grid mesher only: Max. edge length of bridging triangles at the borders. Unit: [grid cells]"});
+      add("mesh_max_block_size", Parameter_t<int>{32, "Grid mesher only: Max. edge length of decimated blocks, must be a power of two. Unit: [grid cells]"});
+      add("tile_size", Parameter_t<int>{256, "Number of grid cells per tile edge of the global map"});
       add("save_valid", Parameter_t<int>{0, "Save valid global map grid elements"});
       add("save_ortho_rgb_one", Parameter_t<int>{0, "Save global map ortho foto as one PNG image file"});
       add("save_ortho_rgb_all", Parameter_t<int>{0, "Save global map ortho foto as incremental PNG image files"});
       add("save_ortho_gtiff_one", Parameter_t<int>{0, "Save global map ortho foto as one GeoTIFF image file"});
-      add("save_ortho_gtiff_all", Parameter_t<int>{0, "Save global map ortho foto as incremental GeoTIFF image files"});
+      add("save_ortho_gtiff_all", Parameter_t<int>{0, "Save global map ortho foto as one GeoTIFF, that is updated every iteration"});
       add("save_elevation_one", Parameter_t<int>{0, "Save global elevation map as one PNG image file"});
       add("save_elevation_all", Parameter_t<int>{0, "Save global elevation map as incremental PNG image files"});
       add("save_elevation_var_one", Parameter_t<int>{0, "Save global standard deviation map as one PNG image file"});
@@ -56,6 +56,9 @@ class SurfaceGeneration : public StageBase
     bool _try_use_elevation;
     double _knn_radius_factor;
 
+    //! Resolution of the generated surface. Zero means it is estimated from the point cloud
+    double _GSD;
+
     bool _is_projection_plane_offset_computed;
     double _projection_plane_offset;
 
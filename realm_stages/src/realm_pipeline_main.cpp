@@ -0,0 +1,79 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+
+#include <realm_core/loguru.h>
+#include <realm_io/exif_import.h>
+#include <realm_io/realm_import.h>
+#include <realm_io/utilities.h>
+#include <realm_stages/pipeline.h>
+
+using namespace realm;
+
+int main(int argc, char **argv)
+{
+  if (argc < 6)
+  {
+    std::cout << "Usage: realm_pipeline <profile_dir> <image_dir> <output_dir> <vslam_method> <densifier_method> [camera_id]" << std::endl;
+    std::cout << "Example: realm_pipeline .../profiles/alexa_noreco .../images .../output orb_slam2 dummy" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string path_profile = argv[1];
+  std::string path_images = argv[2];
+  std::string path_output = argv[3];
+  std::string method_vslam = argv[4];
+  std::string method_densifier = argv[5];
+  std::string camera_id = (argc > 6 ? argv[6] : "realm");
+
+  if (!io::dirExists(path_images))
+    throw(std::invalid_argument("Error: Image folder '" + path_images + "' does not exist!"));
+
+  io::Exiv2FrameReader reader(io::Exiv2FrameReader::FrameTags::loadFromFile(path_profile + "/config/exif.yaml"));
+  auto cam = std::make_shared<camera::Pinhole>(io::loadCameraFromYaml(path_profile + "/camera/calib.yaml"));
+
+  stages::Pipeline pipeline(path_profile, path_output, method_vslam, method_densifier);
+  pipeline.start();
+
+  // Frames are fed with the camera frame rate, because stages drop frames when their input queue overflows
+  auto t_frame = std::chrono::milliseconds(static_cast<int64_t>(1/pipeline.getFps()*1000.0));
+
+  std::vector<std::string> file_list = io::getFileList(path_images);
+  for (size_t i = 0; i < file_list.size(); ++i)
+  {
+    auto t_next = std::chrono::steady_clock::now() + t_frame;
+
+    LOG_F(INFO, "Image #%lu / %lu, image path: %s", i + 1, file_list.size(), file_list[i].c_str());
+
+    // Every frame needs its own camera model, because the frame sets its pose while it is processed by the stages
+    auto cam_frame = std::make_shared<camera::Pinhole>(*cam);
+    pipeline.addFrame(reader.loadFrameFromExiv2(camera_id, cam_frame, file_list[i]));
+
+    std::this_thread::sleep_until(t_next);
+  }
+
+  pipeline.finish();
+  LOG_F(INFO, "Results written to: %s", pipeline.getOutputPath().c_str());
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,245 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+
+#include <opencv2/core.hpp>
+
+#include <realm_stages/blending.h>
+
+using namespace realm;
+
+namespace
+{
+
+/*!
+ * @brief Layer data of one map involved in blending. Headers are grabbed once, so no string lookup happens during
+ * the actual blending loop.
+ */
+struct BlendLayers
+{
+    cv::Mat elevation;
+    cv::Mat elevation_normal;
+    cv::Mat elevation_var;
+    cv::Mat elevation_hyp;
+    cv::Mat elevation_angle;
+    cv::Mat elevated;
+    cv::Mat num_observations;
+    cv::Mat color_rgb;
+    cv::Mat valid;
+};
+
+void checkLayer(const cv::Mat &data, int type, const cv::Size2i &size)
+{
+  if (data.type() != type)
+    throw(std::invalid_argument("Error blending overlap: Layer type mismatch!"));
+  if (data.cols != size.width || data.rows != size.height)
+    throw(std::invalid_argument("Error blending overlap: Layer dimension mismatch!"));
+}
+
+class BlendInvoker : public cv::ParallelLoopBody
+{
+  public:
+    BlendInvoker(const BlendLayers &ref, const BlendLayers &inp, const blending::Settings &settings)
+    : _ref(ref),
+      _inp(inp),
+      _settings(settings)
+    {
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      const int cols = _ref.elevation.cols;
+      const bool use_normals = _settings.use_surface_normals;
+      const float th_var = _settings.th_elevation_var;
+      const int th_nobs = _settings.th_elevation_min_nobs;
+
+      for (int r = range.start; r < range.end; ++r)
+      {
+        // Row pointers of all layers are resolved once per row, the inner loop works on contiguous memory only
+        float* ref_ele = _ref.elevation.ptr<float>(r);
+        float* ref_var = _ref.elevation_var.ptr<float>(r);
+        float* ref_hyp = _ref.elevation_hyp.ptr<float>(r);
+        float* ref_angle = _ref.elevation_angle.ptr<float>(r);
+        uint16_t* ref_nobs = _ref.num_observations.ptr<uint16_t>(r);
+        cv::Vec4b* ref_rgb = _ref.color_rgb.ptr<cv::Vec4b>(r);
+        uchar* ref_elevated = _ref.elevated.ptr<uchar>(r);
+        uchar* ref_valid = _ref.valid.ptr<uchar>(r);
+        cv::Vec3f* ref_normal = (use_normals ? _ref.elevation_normal.ptr<cv::Vec3f>(r) : nullptr);
+
+        const float* inp_ele = _inp.elevation.ptr<float>(r);
+        const float* inp_angle = _inp.elevation_angle.ptr<float>(r);
+        const cv::Vec4b* inp_rgb = _inp.color_rgb.ptr<cv::Vec4b>(r);
+        const uchar* inp_elevated = _inp.elevated.ptr<uchar>(r);
+        const uchar* inp_valid = _inp.valid.ptr<uchar>(r);
+        const cv::Vec3f* inp_normal = (use_normals ? _inp.elevation_normal.ptr<cv::Vec3f>(r) : nullptr);
+
+        for (int c = 0; c < cols; ++c)
+        {
+          const bool is_inp_elevated = (inp_elevated[c] != 0);
+          const bool is_ref_elevated = (ref_elevated[c] != 0);
+
+          // Check cases for input. Elevated reference is never overwritten by non elevated input
+          if (inp_valid[c] == 0 || (is_ref_elevated && !is_inp_elevated))
+            continue;
+
+          // Case 1: No observation so far or first elevated observation. Input is set directly.
+          if (ref_nobs[c] == 0 || (is_inp_elevated && !is_ref_elevated))
+          {
+            ref_ele[c] = inp_ele[c];
+            ref_elevated[c] = inp_elevated[c];
+            ref_var[c] = 0.0f;
+            ref_hyp[c] = 0.0f;
+            ref_angle[c] = inp_angle[c];
+            ref_rgb[c] = inp_rgb[c];
+            ref_nobs[c] = 1;
+            ref_valid[c] = 255;
+            if (use_normals)
+              ref_normal[c] = inp_normal[c];
+            continue;
+          }
+
+          // Color of the observation closest to nadir is kept. This is the same for all update cases below.
+          const bool is_closer_to_nadir = (fabsf(inp_angle[c] - 90) < fabsf(ref_angle[c] - 90));
+
+          // Case 2: Both not elevated. Elevation is simply taken over.
+          if (!is_inp_elevated)
+          {
+            ref_ele[c] = inp_ele[c];
+            ref_elevated[c] = 0;
+            ref_valid[c] = 255;
+            ref_nobs[c] = ref_nobs[c] + (uint16_t)1;
+            if (is_closer_to_nadir)
+            {
+              ref_angle[c] = inp_angle[c];
+              ref_rgb[c] = inp_rgb[c];
+            }
+            continue;
+          }
+
+          // Case 3: Both elevated. Online update of mean and variance
+          // Formulas avr+std_dev: https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Online_algorithm
+          const uint16_t nobs = ref_nobs[c];
+          const float ele = ref_ele[c];
+          const float ele_inp = inp_ele[c];
+          const float variance_new = (nobs + 1 - 2) / (float) (nobs + 1 - 1) * ref_var[c]
+                                     + (ele_inp - ele)*(ele_inp - ele) / (float) (nobs + 1);
+
+          // First assume grid element is not valid and set only if legitimate values were computed.
+          ref_valid[c] = 0;
+
+          if (variance_new < th_var)
+          {
+            const uint16_t nobs_new = nobs + (uint16_t)1;
+            ref_ele[c] = ele + (ele_inp - ele) / (float)(nobs + 1);
+            ref_var[c] = variance_new;
+            ref_nobs[c] = nobs_new;
+            if (use_normals)
+              ref_normal[c] = ref_normal[c] + (inp_normal[c] - ref_normal[c]) / (float)(nobs_new + 1);
+            if (nobs_new >= th_nobs)
+              ref_valid[c] = 255;
+            if (is_closer_to_nadir)
+            {
+              ref_angle[c] = inp_angle[c];
+              ref_rgb[c] = inp_rgb[c];
+            }
+            continue;
+          }
+
+          // Variance too high. Check if the existing hypothesis explains the input better and switch if so.
+          const float hyp = ref_hyp[c];
+          if (!std::isnan(hyp))
+          {
+            const float variance_hyp = (ele_inp - hyp)*(ele_inp - hyp) / 2.0f;
+            if (variance_hyp < th_var || variance_hyp < variance_new)
+            {
+              ref_var[c] = variance_hyp;
+              ref_ele[c] = (hyp + ele_inp) / 2.0f;
+              ref_nobs[c] = 2;
+              if (use_normals)
+                ref_normal[c] = (ref_normal[c] + inp_normal[c]) / 2.0f;
+              if (2 >= th_nobs)
+                ref_valid[c] = 255;
+              ref_angle[c] = inp_angle[c];
+              ref_rgb[c] = inp_rgb[c];
+            }
+          }
+
+          // Input is always the new hypothesis
+          ref_hyp[c] = ele_inp;
+        }
+      }
+    }
+
+  private:
+    const BlendLayers &_ref;
+    const BlendLayers &_inp;
+    const blending::Settings &_settings;
+};
+
+} // namespace
+
+void blending::blendOverlap(CvGridMap &ref, const CvGridMap &inp, const Settings &settings)
+{
+  cv::Size2i size = ref.size();
+  if (inp.size() != size)
+    throw(std::invalid_argument("Error blending overlap: Map dimension mismatch!"));
+
+  BlendLayers ref_layers;
+  ref_layers.elevation = ref["elevation"];
+  ref_layers.elevation_var = ref["elevation_var"];
+  ref_layers.elevation_hyp = ref["elevation_hyp"];
+  ref_layers.elevation_angle = ref["elevation_angle"];
+  ref_layers.elevated = ref["elevated"];
+  ref_layers.num_observations = ref["num_observations"];
+  ref_layers.color_rgb = ref["color_rgb"];
+  ref_layers.valid = ref["valid"];
+
+  BlendLayers inp_layers;
+  inp_layers.elevation = inp["elevation"];
+  inp_layers.elevation_angle = inp["elevation_angle"];
+  inp_layers.elevated = inp["elevated"];
+  inp_layers.color_rgb = inp["color_rgb"];
+  inp_layers.valid = inp["valid"];
+
+  if (settings.use_surface_normals)
+  {
+    ref_layers.elevation_normal = ref["elevation_normal"];
+    inp_layers.elevation_normal = inp["elevation_normal"];
+    checkLayer(ref_layers.elevation_normal, CV_32FC3, size);
+    checkLayer(inp_layers.elevation_normal, CV_32FC3, size);
+  }
+
+  checkLayer(ref_layers.elevation, CV_32F, size);
+  checkLayer(ref_layers.elevation_var, CV_32F, size);
+  checkLayer(ref_layers.elevation_hyp, CV_32F, size);
+  checkLayer(ref_layers.elevation_angle, CV_32F, size);
+  checkLayer(ref_layers.elevated, CV_8UC1, size);
+  checkLayer(ref_layers.num_observations, CV_16UC1, size);
+  checkLayer(ref_layers.color_rgb, CV_8UC4, size);
+  checkLayer(ref_layers.valid, CV_8UC1, size);
+  checkLayer(inp_layers.elevation, CV_32F, size);
+  checkLayer(inp_layers.elevation_angle, CV_32F, size);
+  checkLayer(inp_layers.elevated, CV_8UC1, size);
+  checkLayer(inp_layers.color_rgb, CV_8UC4, size);
+  checkLayer(inp_layers.valid, CV_8UC1, size);
+
+  cv::parallel_for_(cv::Range(0, size.height), BlendInvoker(ref_layers, inp_layers, settings));
+}
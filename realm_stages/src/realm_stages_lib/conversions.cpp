@@ -18,95 +18,305 @@
 * along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <cstring>
+
 #include <realm_stages/conversions.h>
 
 namespace realm
 {
 
-cv::Mat cvtToPointCloud(const cv::Mat &img3d, const cv::Mat &color, const cv::Mat &normals, const cv::Mat &mask)
+namespace
 {
-  assert(!img3d.empty());
 
-  size_t n = (size_t)img3d.cols*img3d.rows;
+/*!
+ * @brief Source of the 3d positions for the conversion, reads precomputed positions from a 3 channel double image
+ */
+class Img3dPositions
+{
+  public:
+    explicit Img3dPositions(const cv::Mat &img3d)
+    : _img3d(img3d)
+    {
+    }
 
-  cv::Mat points;
-  points.reserve(n);
+    inline const cv::Vec3d* row(int r, std::vector<cv::Vec3d> &/*buffer*/) const
+    {
+      return _img3d.ptr<cv::Vec3d>(r);
+    }
+
+  private:
+    const cv::Mat &_img3d;
+};
+
+/*!
+ * @brief Source of the 3d positions for the conversion, computes x,y from the grid geometry and z from the elevation
+ * @tparam T Element type of the elevation layer, float or double
+ */
+template<typename T>
+class GridPositions
+{
+  public:
+    GridPositions(const CvGridMap &map, const std::string &layer_elevation)
+    : _elevation(map.getHandle<T>(layer_elevation)),
+      _roi(map.roi()),
+      _resolution(map.resolution())
+    {
+    }
 
-  // Create one point per valid grid element
-  for (int r = 0; r < img3d.rows; ++r)
-    for (int c = 0; c < img3d.cols; ++c)
+    inline const cv::Vec3d* row(int r, std::vector<cv::Vec3d> &buffer) const
     {
-      if (mask.at<uchar>(r, c) == 0)
-        continue;
+      const T* row_elevation = _elevation.ptr(r);
+      const double y = _roi.y + _roi.height - static_cast<double>(r)*_resolution;  // ENU world frame
+      for (size_t c = 0; c < buffer.size(); ++c)
+        buffer[c] = cv::Vec3d(_roi.x + static_cast<double>(c)*_resolution, y, static_cast<double>(row_elevation[c]));
+      return buffer.data();
+    }
 
-      cv::Mat pt = cv::Mat::zeros(1, 9, CV_64F);
+    inline cv::Point3d at(int r, int c) const
+    {
+      return cv::Point3d(_roi.x + static_cast<double>(c)*_resolution,
+                         _roi.y + _roi.height - static_cast<double>(r)*_resolution,
+                         static_cast<double>(_elevation(r, c)));
+    }
 
-      // Position informations
-      auto pos = img3d.at<cv::Vec3d>(r, c);
-      pt.at<double>(0) = pos[0];
-      pt.at<double>(1) = pos[1];
-      pt.at<double>(2) = pos[2];
+  private:
+    LayerHandle<const T> _elevation;
+    cv::Rect2d _roi;
+    double _resolution;
+};
 
-      // Color informations
-      if (!color.empty())
+/*!
+ * @brief Counts the valid elements of every row of the mask
+ */
+class MaskCountInvoker : public cv::ParallelLoopBody
+{
+  public:
+    MaskCountInvoker(const cv::Mat &mask, std::vector<int> &counts)
+    : _mask(mask),
+      _counts(counts)
+    {
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      for (int r = range.start; r < range.end; ++r)
       {
-        if (color.channels() == 1)
-        {
-          auto mono = color.at<uchar>(r, c);
-          pt.at<double>(3) = static_cast<double>(mono)/255.0;
-          pt.at<double>(4) = static_cast<double>(mono)/255.0;
-          pt.at<double>(5) = static_cast<double>(mono)/255.0;
-        }
-        else if(color.channels() == 3)
-        {
-          auto bgr = color.at<cv::Vec3b>(r, c);
-          pt.at<double>(3) = static_cast<double>(bgr[0])/255.0;
-          pt.at<double>(4) = static_cast<double>(bgr[1])/255.0;
-          pt.at<double>(5) = static_cast<double>(bgr[2])/255.0;
-        }
-        else if(color.channels() == 4)
-        {
-          auto bgra = color.at<cv::Vec4b>(r, c);
-          pt.at<double>(3) = static_cast<double>(bgra[0])/255.0;
-          pt.at<double>(4) = static_cast<double>(bgra[1])/255.0;
-          pt.at<double>(5) = static_cast<double>(bgra[2])/255.0;
-        }
-        else
-          throw(std::invalid_argument("Error: Converting to colored pointcloud failed. Image channel mismatch!"));
+        const uchar* row = _mask.ptr<uchar>(r);
+        int count = 0;
+        for (int c = 0; c < _mask.cols; ++c)
+          count += (row[c] != 0);
+        _counts[r] = count;
       }
+    }
+
+  private:
+    const cv::Mat &_mask;
+    std::vector<int> &_counts;
+};
+
+/*!
+ * @brief Reads the color of an element as b,g,r
+ */
+inline void readColor(const cv::Mat &color, int r, int c, uchar bgr[3])
+{
+  switch (color.channels())
+  {
+    case 1:
+      bgr[0] = bgr[1] = bgr[2] = color.ptr<uchar>(r)[c];
+      break;
+    case 3:
+    {
+      const cv::Vec3b &val = color.ptr<cv::Vec3b>(r)[c];
+      bgr[0] = val[0]; bgr[1] = val[1]; bgr[2] = val[2];
+      break;
+    }
+    default:
+    {
+      const cv::Vec4b &val = color.ptr<cv::Vec4b>(r)[c];
+      bgr[0] = val[0]; bgr[1] = val[1]; bgr[2] = val[2];
+      break;
+    }
+  }
+}
 
-      // Surface normals
-      if (!normals.empty())
+/*!
+ * @brief Writes the points of a range of rows into the preallocated point cloud. Every row starts at its precomputed
+ * offset, so no synchronisation between the threads is needed.
+ * @tparam PositionSource Either Img3dPositions or GridPositions
+ */
+template<typename PositionSource>
+class PointCloudInvoker : public cv::ParallelLoopBody
+{
+  public:
+    PointCloudInvoker(const PositionSource &positions, int width, const cv::Mat &color, const cv::Mat &normals,
+                      const cv::Mat &mask, const std::vector<int> &offsets, PointCloudFormat format, cv::Mat &points)
+    : _positions(positions),
+      _width(width),
+      _color(color),
+      _normals(normals),
+      _mask(mask),
+      _offsets(offsets),
+      _format(format),
+      _points(points)
+    {
+    }
+
+    void operator()(const cv::Range &range) const override
+    {
+      const bool has_color = !_color.empty();
+      const bool has_normals = !_normals.empty();
+
+      // Row buffer for position sources, that compute their positions on the fly
+      std::vector<cv::Vec3d> buffer(static_cast<size_t>(_width));
+
+      for (int r = range.start; r < range.end; ++r)
       {
-        cv::Vec3f normal = normals.at<cv::Vec3f>(r, c);
-        pt.at<double>(6) = static_cast<double>(normal[0]);
-        pt.at<double>(7) = static_cast<double>(normal[1]);
-        pt.at<double>(8) = static_cast<double>(normal[2]);
-      }
+        const cv::Vec3d* pos = _positions.row(r, buffer);
+        const uchar* mask = (_mask.empty() ? nullptr : _mask.ptr<uchar>(r));
+        const cv::Vec3f* normal = (has_normals ? _normals.ptr<cv::Vec3f>(r) : nullptr);
+
+        int idx = _offsets[r];
+        for (int c = 0; c < _width; ++c)
+        {
+          if (mask != nullptr && mask[c] == 0)
+            continue;
+
+          uchar bgr[3] = {0, 0, 0};
+          if (has_color)
+            readColor(_color, r, c, bgr);
+          const cv::Vec3f n = (has_normals ? normal[c] : cv::Vec3f(0.0f, 0.0f, 0.0f));
 
-      points.push_back(pt);
+          if (_format == PointCloudFormat::BGR_NORMAL_64F)
+          {
+            double* pt = _points.ptr<double>(idx);
+            pt[0] = pos[c][0];
+            pt[1] = pos[c][1];
+            pt[2] = pos[c][2];
+            pt[3] = static_cast<double>(bgr[0])/255.0;
+            pt[4] = static_cast<double>(bgr[1])/255.0;
+            pt[5] = static_cast<double>(bgr[2])/255.0;
+            pt[6] = static_cast<double>(n[0]);
+            pt[7] = static_cast<double>(n[1]);
+            pt[8] = static_cast<double>(n[2]);
+          }
+          else
+          {
+            float* pt = _points.ptr<float>(idx);
+            const uint32_t rgb = (static_cast<uint32_t>(bgr[2]) << 16) | (static_cast<uint32_t>(bgr[1]) << 8) | bgr[0];
+            pt[0] = static_cast<float>(pos[c][0]);
+            pt[1] = static_cast<float>(pos[c][1]);
+            pt[2] = static_cast<float>(pos[c][2]);
+            memcpy(&pt[3], &rgb, sizeof(float));
+            pt[4] = n[0];
+            pt[5] = n[1];
+            pt[6] = n[2];
+          }
+          ++idx;
+        }
+      }
     }
+
+  private:
+    const PositionSource &_positions;
+    int _width;
+    const cv::Mat &_color;
+    const cv::Mat &_normals;
+    const cv::Mat &_mask;
+    const std::vector<int> &_offsets;
+    PointCloudFormat _format;
+    cv::Mat &_points;
+};
+
+/*!
+ * @brief Converts all valid elements of a grid of size rows x cols into a point cloud. Counting and writing are row
+ * parallel, the offsets of the rows are an exclusive prefix sum of the counts.
+ */
+template<typename PositionSource>
+cv::Mat createPointCloud(const PositionSource &positions, const cv::Size2i &size, const cv::Mat &color,
+                         const cv::Mat &normals, const cv::Mat &mask, PointCloudFormat format)
+{
+  if (!color.empty() && color.channels() != 1 && color.channels() != 3 && color.channels() != 4)
+    throw(std::invalid_argument("Error: Converting to colored pointcloud failed. Image channel mismatch!"));
+
+  // Number of valid elements per row and their offset in the point cloud
+  std::vector<int> offsets((size_t)size.height + 1, 0);
+  if (mask.empty())
+  {
+    for (int r = 0; r < size.height; ++r)
+      offsets[r] = size.width;
+  }
+  else
+    cv::parallel_for_(cv::Range(0, size.height), MaskCountInvoker(mask, offsets));
+
+  int n = 0;
+  for (int r = 0; r <= size.height; ++r)
+  {
+    int count = offsets[r];
+    offsets[r] = n;
+    n += count;
+  }
+
+  cv::Mat points;
+  if (format == PointCloudFormat::BGR_NORMAL_64F)
+    points = cv::Mat(n, 9, CV_64F);
+  else
+    points = cv::Mat(n, 7, CV_32F);
+
+  if (n == 0)
+    return points;
+
+  cv::parallel_for_(cv::Range(0, size.height),
+                    PointCloudInvoker<PositionSource>(positions, size.width, color, normals, mask, offsets, format, points));
   return points;
+}
+
+/*!
+ * @brief Creates the faces of a mesh with the 3d positions of the vertices taken from the grid
+ * @tparam T Element type of the elevation layer, float or double
+ */
+template<typename T>
+std::vector<Face> createFaces(const GridPositions<T> &positions, const LayerHandle<const cv::Vec4b> &color,
+                              const std::vector<cv::Point2i> &vertex_ids)
+{
+  size_t count = 0;
+  std::vector<Face> faces(vertex_ids.size()/3);
+
+  for (size_t i = 0; i < vertex_ids.size(); i+=3, ++count)
+    for (size_t j = 0; j < 3; ++j)
+    {
+      const int r = vertex_ids[i+j].y;
+      const int c = vertex_ids[i+j].x;
+      faces[count].vertices[j] = positions.at(r, c);
+      if (!color.empty())
+        faces[count].color[j] = color(r, c);
+      else
+        faces[count].color[j] = cv::Vec4b(0, 0, 0, 255);
+    }
+  return faces;
+}
+
+} // namespace
+
+cv::Mat cvtToPointCloud(const cv::Mat &img3d, const cv::Mat &color, const cv::Mat &normals, const cv::Mat &mask,
+                        PointCloudFormat format)
+{
+  assert(!img3d.empty() && img3d.type() == CV_64FC3);
 
+  return createPointCloud(Img3dPositions(img3d), img3d.size(), color, normals, mask, format);
 }
 
 cv::Mat cvtToPointCloud(const CvGridMap &map,
                         const std::string &layer_elevation,
                         const std::string &layer_color,
                         const std::string &layer_normals,
-                        const std::string &layer_mask)
+                        const std::string &layer_mask,
+                        PointCloudFormat format)
 {
   assert(map.exists(layer_elevation));
   assert(!layer_color.empty() ? map.exists(layer_color) : true);
   assert(!layer_normals.empty() ? map.exists(layer_normals) : true);
   assert(!layer_mask.empty() ? map.exists(layer_mask) : true);
 
-  cv::Size2i size = map.size();
-  size_t n = (size_t)size.width*size.height;
-
-  cv::Mat points;
-  points.reserve(n);
-
   // OPTIONAL
   cv::Mat color;
   if (map.exists(layer_color))
@@ -120,13 +330,11 @@ cv::Mat cvtToPointCloud(const CvGridMap &map,
   if (map.exists(layer_mask))
     mask = map[layer_mask];
 
-  // Create one point per grid element
-  cv::Mat img3d(size, CV_64FC3);
-  for (int r = 0; r < size.height; ++r)
-    for (int c = 0; c < size.width; ++c)
-      img3d.at<cv::Point3d>(r, c) = map.atPosition3d(r, c, layer_elevation);
-
-  return cvtToPointCloud(img3d, color, elevation_normal, mask);
+  // Positions are computed per row while converting, no intermediate 3d image is needed
+  if (map[layer_elevation].type() == CV_64F)
+    return createPointCloud(GridPositions<double>(map, layer_elevation), map.size(), color, elevation_normal, mask, format);
+  else
+    return createPointCloud(GridPositions<float>(map, layer_elevation), map.size(), color, elevation_normal, mask, format);
 }
 
 std::vector<Face> cvtToMesh(const CvGridMap &map,
@@ -138,24 +346,14 @@ std::vector<Face> cvtToMesh(const CvGridMap &map,
   assert(!layer_color.empty() ? map.exists(layer_color) : true);
 
   // OPTIONAL
-  cv::Mat color;
+  LayerHandle<const cv::Vec4b> color;
   if (map.exists(layer_color))
-    color = map[layer_color];
+    color = map.getHandle<cv::Vec4b>(layer_color);
 
-  // Create output vector of faces
-  size_t count = 0;
-  std::vector<Face> faces(vertex_ids.size()/3);
-
-  for (size_t i = 0; i < vertex_ids.size(); i+=3, ++count)
-    for (size_t j = 0; j < 3; ++j)
-    {
-      faces[count].vertices[j] = map.atPosition3d(vertex_ids[i+j].y, vertex_ids[i+j].x, layer_elevation);
-      if (!color.empty())
-        faces[count].color[j] = color.at<cv::Vec4b>(vertex_ids[i+j].y, vertex_ids[i+j].x);
-      else
-        faces[count].color[j] = cv::Vec4b(0, 0, 0, 255);
-    }
-  return faces;
+  if (map[layer_elevation].type() == CV_64F)
+    return createFaces(GridPositions<double>(map, layer_elevation), color, vertex_ids);
+  else
+    return createFaces(GridPositions<float>(map, layer_elevation), color, vertex_ids);
 }
 
 } // namespace realm
\ No newline at end of file
@@ -28,6 +28,7 @@ Densification::Densification(const StageSettings::Ptr &stage_set,
                              double rate)
 : StageBase("densification", (*stage_set)["path_output"].toString(), rate, (*stage_set)["queue_size"].toInt()),
   _use_sparse_depth((*stage_set)["use_sparse_disparity"].toInt() > 0),
+  _sparse_interpolation(densifier::toSparseInterpolation((*stage_set)["sparse_interpolation"].toString())),
   _use_filter_bilat((*stage_set)["use_filter_bilat"].toInt() > 0),
   _use_filter_guided((*stage_set)["use_filter_guided"].toInt() > 0),
   _depth_min_current(0.0),
@@ -51,12 +52,20 @@ Densification::Densification(const StageSettings::Ptr &stage_set,
 
   LOG_IF_F(WARNING, no_densification, "Densification launched, but settings forbid.");
   LOG_IF_F(WARNING, no_densification, "Try set 'use_sparse_depth' or 'use_dense_depth' in settings. All frames are redirected.");
+
+  setEventDriven((*stage_set)["event_driven"].toInt() > 0);
+  initAsyncWriter((*stage_set)["io_threads"].toInt(),
+                  (*stage_set)["io_queue_size"].toInt(),
+                  (*stage_set)["io_overflow_policy"].toString());
+  initMetricsExport((*stage_set)["metrics_period"].toInt(),
+                    (*stage_set)["metrics_port"].toInt());
+  initTracing((*stage_set)["trace"].toInt() > 0);
 }
 
 void Densification::addFrame(const Frame::Ptr &frame)
 {
   // First update statistics about incoming frame rate
-  updateFpsStatisticsIncoming();
+  updateStatisticsIncoming(frame);
 
   // Check if frame and settings are fulfilled to process/densify incoming frames
   // if not, redirect to next stage
@@ -90,6 +99,7 @@ void Densification::addFrame(const Frame::Ptr &frame)
 
   // Increment received valid frames
   _rcvd_frames++;
+  notifyWorkAvailable();
 }
 
 bool Densification::process()
@@ -115,9 +125,11 @@ bool Densification::process()
   // Post processing steps
   cv::Mat depthmap_filtered = applyDepthMapPostProcessing(depthmap);
 
+  // Reprojection and normals are computed in one sweep over the filtered depth map
+  LOG_F(INFO, "Reprojecting depthmap map into space...");
+  cv::Mat img3d;
   cv::Mat normals;
-  if (_compute_normals)
-    normals = stereo::computeNormalsFromDepthMap(depthmap_filtered);
+  stereo::reprojectDepthMap(_frame_current->getResizedCamera(), depthmap_filtered, img3d, normals, _compute_normals);
 
   // Output step
   LOG_F(INFO, "Scene depthmap force in range %4.2f ... %4.2f", _depth_min_current, _depth_max_current);
@@ -127,8 +139,6 @@ bool Densification::process()
   if (_compute_normals)
     cv::erode(mask, mask, cv::Mat(), cv::Point(-1, -1), 4, cv::BORDER_CONSTANT, 0);
 
-  LOG_F(INFO, "Reprojecting depthmap map into space...");
-  cv::Mat img3d = stereo::reprojectDepthMap(_frame_current->getResizedCamera(), depthmap_filtered);
   cv::Mat surface_pts = cvtToPointCloud(img3d, _frame_current->getResizedImageUndistorted(), normals, mask);
 
   _frame_current->setSurfacePoints(surface_pts);
@@ -146,6 +156,7 @@ bool Densification::processNoReconstruction(const FrameBuffer &buffer, cv::Outpu
   LOG_F(INFO, "Performing no reconstruction. Interpolation of sparse cloud...");
 
   _frame_current = buffer.front();
+  updateStatisticsProcessing(_frame_current);
 
   if (_frame_current->getSurfacePoints().rows < 50 || !_use_sparse_depth)
   {
@@ -163,19 +174,29 @@ bool Densification::processNoReconstruction(const FrameBuffer &buffer, cv::Outpu
   if (!_frame_current->isImageResizeSet())
     _frame_current->setImageResizeFactor(_densifier->getResizeFactor());
 
-  // Compute sparse depth map and save if neccessary
+  // Compute sparse depth map and save if neccessary. The sparse cloud is projected only once, the projection is
+  // reused for the sparse mask later on
   cv::Mat depthmap_sparse;
   cv::Mat depthmap_sparse_densified;
+  cv::Mat point_indices;
+
+  stereo::projectPointCloud(_frame_current->getResizedCamera(), _frame_current->getSurfacePoints(), depthmap_sparse, point_indices);
+  densifier::computeDepthMapFromSparseDepth(depthmap_sparse, depthmap_sparse_densified, _sparse_interpolation);
+  _depthmap_sparse_current = depthmap_sparse;
 
-  densifier::computeDepthMapFromSparseCloud(_frame_current->getSurfacePoints(),
-                                            _frame_current->getResizedCamera(),
-                                            depthmap_sparse_densified,
-                                            depthmap_sparse);
+  std::string path = _stage_path;
+  uint32_t id = _frame_current->getFrameId();
+  float depth_min = _depth_min_current;
+  float depth_max = _depth_max_current;
 
   if (_settings_save.save_thumb)
-    io::saveImageColorMap(depthmap_sparse, _depth_min_current, _depth_max_current, _stage_path + "/thumb", "thumb", _frame_current->getFrameId(), io::ColormapType::DEPTH);
+    saveAsync("thumb", [=](){ io::saveImageColorMap(depthmap_sparse, depth_min, depth_max, path + "/thumb", "thumb", id, io::ColormapType::DEPTH); });
   if (_settings_save.save_sparse)
-    io::saveDepthMap(depthmap_sparse_densified, _stage_path + "/sparse/sparse_%06i.tif", _frame_current->getFrameId(), _depth_min_current, _depth_max_current);
+  {
+    // Depth map is passed on for further processing, therefore save a snapshot
+    cv::Mat snapshot = depthmap_sparse_densified.clone();
+    saveAsync("sparse", [=](){ io::saveDepthMap(snapshot, path + "/sparse/sparse_%06i.tif", id, depth_min, depth_max); });
+  }
 
   depthmap.assign(depthmap_sparse_densified);
   popFromBufferNoReco();
@@ -189,6 +210,7 @@ bool Densification::processStereoReconstruction(const FrameBuffer &buffer, cv::O
   // Reference frame is the one in the middle (if more than two)
   int ref_idx = (int)buffer.size()/2;
   _frame_current = buffer[ref_idx];
+  updateStatisticsProcessing(_frame_current);
   _depth_min_current = static_cast<float>(_frame_current->getMedianSceneDepth()) * 0.25f;
   _depth_max_current = static_cast<float>(_frame_current->getMedianSceneDepth()) * 1.75f;
 
@@ -222,9 +244,20 @@ bool Densification::processStereoReconstruction(const FrameBuffer &buffer, cv::O
     return false;
   }
 
+  // Depth map was computed at the scale of the densifier, which therefore becomes the default scale of the frame
+  _frame_current->setImageResizeFactor(_densifier->getResizeFactor());
+
   // Saving raw
   if (_settings_save.save_dense)
-    io::saveDepthMap(depthmap_dense, _stage_path + "/dense/dense_%06i.tif", _frame_current->getFrameId(), _depth_min_current, _depth_max_current);
+  {
+    // Depth map is passed on for further processing, therefore save a snapshot
+    cv::Mat snapshot = depthmap_dense.clone();
+    std::string path = _stage_path;
+    uint32_t id = _frame_current->getFrameId();
+    float depth_min = _depth_min_current;
+    float depth_max = _depth_max_current;
+    saveAsync("dense", [=](){ io::saveDepthMap(snapshot, path + "/dense/dense_%06i.tif", id, depth_min, depth_max); });
+  }
 
   depthmap.assign(depthmap_dense);
   popFromBufferReco(_frame_current->getCameraId());
@@ -240,8 +273,15 @@ cv::Mat Densification::applyDepthMapPostProcessing(const cv::Mat &depthmap)
       cv::bilateralFilter(depthmap, depthmap_filtered, 5, 25, 25);
 
   if (_settings_save.save_bilat)
-    io::saveImageColorMap(depthmap_filtered, _depth_min_current, _depth_max_current, _stage_path + "/bilat", "bilat",
-                          _frame_current->getFrameId(), io::ColormapType::DEPTH);
+  {
+    // Depth map is passed on for further processing, therefore save a snapshot
+    cv::Mat snapshot = depthmap_filtered.clone();
+    std::string path = _stage_path;
+    uint32_t id = _frame_current->getFrameId();
+    float depth_min = _depth_min_current;
+    float depth_max = _depth_max_current;
+    saveAsync("bilat", [=](){ io::saveImageColorMap(snapshot, depth_min, depth_max, path + "/bilat", "bilat", id, io::ColormapType::DEPTH); });
+  }
 
   return depthmap_filtered;
 }
@@ -250,7 +290,9 @@ cv::Mat Densification::computeDepthMapMask(const cv::Mat &depth_map, bool use_sp
 {
   cv::Mat mask1, mask2, mask3;
 
-  if (use_sparse_mask)
+  if (use_sparse_mask && !_depthmap_sparse_current.empty())
+    densifier::computeSparseMaskFromSparseDepth(_depthmap_sparse_current, mask1);
+  else if (use_sparse_mask)
     densifier::computeSparseMask(_frame_current->getSurfacePoints(), _frame_current->getResizedCamera(), mask1);
   else
     mask1 = cv::Mat::ones(depth_map.rows, depth_map.cols, CV_8UC1)*255;
@@ -312,7 +354,7 @@ Densification::ProcessingElement Densification::getProcessingElement()
 void Densification::publish(const Frame::Ptr &frame, const cv::Mat &depthmap)
 {
   // First update statistics about outgoing frame rate
-  updateFpsStatisticsOutgoing();
+  updateStatisticsOutgoing(frame);
 
   _transport_frame(frame, "output/frame");
   _transport_pose(frame->getPose(), frame->getGnssUtm().zone, frame->getGnssUtm().band, "output/pose");
@@ -327,10 +369,17 @@ void Densification::publish(const Frame::Ptr &frame, const cv::Mat &depthmap)
 
 void Densification::saveIter(const Frame::Ptr &frame, const cv::Mat &normals, const cv::Mat &mask)
 {
+  // Resized image is memoized by the frame and never modified inplace, normals and mask are computed freshly in each
+  // iteration and not modified afterwards
+  std::string path = _stage_path;
+  uint32_t id = frame->getFrameId();
   if (_settings_save.save_imgs)
-    io::saveImage(frame->getResizedImageUndistorted(), _stage_path + "/imgs", "imgs", frame->getFrameId());
+  {
+    cv::Mat img = frame->getResizedImageUndistorted();
+    saveAsync("imgs", [=](){ io::saveImage(img, path + "/imgs", "imgs", id); });
+  }
   if (_settings_save.save_normals && _compute_normals && !normals.empty())
-    io::saveImageColorMap(normals, mask, _stage_path + "/normals", "normals", frame->getFrameId(), io::ColormapType::NORMALS);
+    saveAsync("normals", [=](){ io::saveImageColorMap(normals, mask, path + "/normals", "normals", id, io::ColormapType::NORMALS); });
 }
 
 void Densification::pushToBufferReco(const Frame::Ptr &frame)
@@ -344,7 +393,10 @@ void Densification::pushToBufferReco(const Frame::Ptr &frame)
 
     // Limit incoming frames
     if (buffer->second->size() > _queue_size)
+    {
+      updateStatisticsDropped(buffer->second->front());
       buffer->second->pop_front();
+    }
   }
   else
   {
@@ -360,13 +412,18 @@ void Densification::pushToBufferNoReco(const Frame::Ptr &frame)
 
   // Limit incoming frames
   if (_buffer_no_reco.size() > _queue_size)
+  {
+    updateStatisticsDropped(_buffer_no_reco.front());
     _buffer_no_reco.pop_front();
+  }
+  updateStatisticsQueueDepth(_buffer_no_reco.size());
 }
 
 void Densification::popFromBufferNoReco()
 {
   std::unique_lock<std::mutex> lock(_mutex_buffer_no_reco);
   _buffer_no_reco.pop_front();
+  updateStatisticsQueueDepth(_buffer_no_reco.size());
 }
 
 void Densification::popFromBufferReco(const std::string &buffer_name)
@@ -447,6 +504,7 @@ void Densification::printSettingsToLog()
 {
   LOG_F(INFO, "### Stage process settings ###");
   LOG_F(INFO, "- use_sparse_depth: %i", _use_sparse_depth);
+  LOG_F(INFO, "- sparse_interpolation: %s", _sparse_interpolation == densifier::SparseInterpolation::PULL_PUSH ? "pull_push" : "inpaint");
   LOG_F(INFO, "- use_filter_bilat: %i", _use_filter_bilat);
   LOG_F(INFO, "- use_filter_guided: %i", _use_filter_guided);
   LOG_F(INFO, "- compute_normals: %i", _compute_normals);
@@ -28,6 +28,9 @@ using namespace stages;
 Mosaicing::Mosaicing(const StageSettings::Ptr &stage_set, double rate)
     : StageBase("mosaicing", (*stage_set)["path_output"].toString(), rate, (*stage_set)["queue_size"].toInt()),
       _utm_reference(nullptr),
+      _gtiff_state(std::make_shared<GeoTIFFState>()),
+      _publish_map_nth_iter(0),
+      _publish_map_every_nth_kf((*stage_set)["publish_map_every_nth_kf"].toInt()),
       _publish_mesh_nth_iter(0),
       _publish_mesh_every_nth_kf((*stage_set)["publish_mesh_every_nth_kf"].toInt()),
       _do_publish_mesh_at_finish((*stage_set)["publish_mesh_at_finish"].toInt() > 0),
@@ -35,6 +38,7 @@ Mosaicing::Mosaicing(const StageSettings::Ptr &stage_set, double rate)
       _use_surface_normals(true),
       _th_elevation_min_nobs((*stage_set)["th_elevation_min_nobs"].toInt()),
       _th_elevation_var((*stage_set)["th_elevation_variance"].toFloat()),
+      _tile_size((*stage_set)["tile_size"].toInt()),
       _settings_save({(*stage_set)["save_valid"].toInt() > 0,
                       (*stage_set)["save_ortho_rgb_one"].toInt() > 0,
                       (*stage_set)["save_ortho_rgb_all"].toInt() > 0,
@@ -49,20 +53,40 @@ Mosaicing::Mosaicing(const StageSettings::Ptr &stage_set, double rate)
                       (*stage_set)["save_elevation_mesh_one"].toInt() > 0,
                       (*stage_set)["save_num_obs_one"].toInt() > 0,
                       (*stage_set)["save_num_obs_all"].toInt() > 0,
-                      (*stage_set)["save_dense_ply"].toInt() > 0})
+                      (*stage_set)["save_dense_ply"].toInt() > 0}),
+      _mesh_method((*stage_set)["mesh_method"].toString())
 {
   std::cout << "Stage [" << _stage_name << "]: Created Stage with Settings: " << std::endl;
   stage_set->print();
+
+  if (_mesh_method == "grid")
+    _mesher_grid = std::make_shared<GridMesher>(GridMesher::Settings{(*stage_set)["mesh_fill_borders"].toInt() > 0,
+                                                                     (*stage_set)["mesh_max_bridge_length"].toDouble(),
+                                                                     (*stage_set)["mesh_th_planarity"].toDouble(),
+                                                                     (*stage_set)["mesh_max_block_size"].toInt()});
+  else if (_mesh_method == "delaunay")
+    _mesher_delaunay = std::make_shared<Delaunay2D>();
+  else
+    throw(std::invalid_argument("Error: Mesh method '" + _mesh_method + "' not supported!"));
+
+  setEventDriven((*stage_set)["event_driven"].toInt() > 0);
+  initAsyncWriter((*stage_set)["io_threads"].toInt(),
+                  (*stage_set)["io_queue_size"].toInt(),
+                  (*stage_set)["io_overflow_policy"].toString());
+  initMetricsExport((*stage_set)["metrics_period"].toInt(),
+                    (*stage_set)["metrics_port"].toInt());
+  initTracing((*stage_set)["trace"].toInt() > 0);
 }
 
 void Mosaicing::addFrame(const Frame::Ptr &frame)
 {
   // First update statistics about incoming frame rate
-  updateFpsStatisticsIncoming();
+  updateStatisticsIncoming(frame);
 
   if (frame->getObservedMap()->empty())
   {
     LOG_F(INFO, "Input frame missing observed map. Dropping!");
+    updateStatisticsDropped(frame);
     return;
   }
   std::unique_lock<std::mutex> lock(_mutex_buffer);
@@ -70,7 +94,12 @@ void Mosaicing::addFrame(const Frame::Ptr &frame)
 
   // Ringbuffer implementation for buffer with no pose
   if (_buffer.size() > _queue_size)
+  {
+    updateStatisticsDropped(_buffer.front());
     _buffer.pop_front();
+  }
+  updateStatisticsQueueDepth(_buffer.size());
+  notifyWorkAvailable();
 }
 
 bool Mosaicing::process()
@@ -94,242 +123,210 @@ bool Mosaicing::process()
     if (_global_map == nullptr)
     {
       LOG_F(INFO, "Initializing global map...");
-      _global_map = observed_map;
-      (*_global_map).add("elevation_var", cv::Mat(_global_map->size(), CV_32F, std::numeric_limits<float>::quiet_NaN()));
-      (*_global_map).add("elevation_hyp", cv::Mat(_global_map->size(), CV_32F, std::numeric_limits<float>::quiet_NaN()));
+      _global_map = std::make_shared<CvGridMapTiled>(observed_map->resolution(), _tile_size);
+
+      // Shallow copy, so the additional layers of the global map are not added to the frame's observed map
+      map_update = std::make_shared<CvGridMap>(*observed_map);
+      map_update->add("elevation_var", cv::Mat(map_update->size(), CV_32F, std::numeric_limits<float>::quiet_NaN()));
+      map_update->add("elevation_hyp", cv::Mat(map_update->size(), CV_32F, std::numeric_limits<float>::quiet_NaN()));
 
       // Incremental update is equal to global map on initialization
-      map_update = _global_map;
+      _global_map->add(*map_update, REALM_OVERWRITE_ALL);
     }
     else
     {
       LOG_F(INFO, "Adding new map data to global map...");
-      (*_global_map).add(*observed_map, REALM_OVERWRITE_ZERO, true);
 
-      CvGridMap::Overlap overlap = _global_map->getOverlap(*observed_map);
+      // Only the region of the global map covered by the observed map is extracted as dense reference. Regions without
+      // any tile yet are initialized with default values, therefore the overlap always covers the whole observed map.
+      CvGridMap map_ref = _global_map->getSubmap(_global_map->getAllLayerNames(), observed_map->roi());
+      map_ref.add(*observed_map, REALM_OVERWRITE_ZERO, false);
+
+      // Overlap is extracted as view on both maps, blending therefore writes directly into the reference
+      CvGridMap::Overlap overlap = map_ref.getOverlap(*observed_map, false);
       if (overlap.first == nullptr && overlap.second == nullptr)
       {
         LOG_F(INFO, "No overlap detected. Add without blending...");
+        _global_map->add(map_ref, REALM_OVERWRITE_ALL);
+        map_update = std::make_shared<CvGridMap>(map_ref.getSubmap({"color_rgb", "elevation", "valid"}));
       }
       else
       {
         LOG_F(INFO, "Overlap detected. Add with blending...");
-        CvGridMap overlap_blended = blend(&overlap);
-        (*_global_map).add(overlap_blended, REALM_OVERWRITE_ALL, false);
+        blend(&overlap);
+        _global_map->add(*overlap.first, REALM_OVERWRITE_ALL);
 
-        cv::Rect2d roi = overlap_blended.roi();
+        cv::Rect2d roi = overlap.first->roi();
         LOG_F(INFO, "Overlap region: [%4.2f, %4.2f] [%4.2f x %4.2f]", roi.x, roi.y, roi.width, roi.height);
         LOG_F(INFO, "Overlap area: %6.2f", roi.area());
-      }
 
-      LOG_F(INFO, "Extracting updated map...");
-      map_update = std::make_shared<CvGridMap>(_global_map->getSubmap({"color_rgb", "elevation", "valid"}, overlap.first->roi()));
+        LOG_F(INFO, "Extracting updated map...");
+        map_update = std::make_shared<CvGridMap>(overlap.first->getSubmap({"color_rgb", "elevation", "valid"}));
+      }
+      LOG_F(INFO, "Global map tiles allocated: %lu", _global_map->getNumberOfTiles());
     }
 
     // Publishings every iteration
     LOG_F(INFO, "Publishing...");
-    publish(frame, _global_map, map_update, frame->getTimestamp());
+    publish(frame, map_update, frame->getTimestamp());
 
     // Savings every iteration
-    saveIter(frame->getFrameId());
+    saveIter(frame->getFrameId(), map_update->roi());
+
+    // Mosaicing is the last consumer of the frame, the image pyramid is not needed anymore
+    frame->releaseCache();
 
     has_processed = true;
   }
   return has_processed;
 }
 
-CvGridMap Mosaicing::blend(CvGridMap::Overlap *overlap)
+void Mosaicing::blend(CvGridMap::Overlap *overlap)
 {
-  // Overlap between global mosaic (ref) and new data (inp)
-  CvGridMap ref = *overlap->first;
-  CvGridMap inp = *overlap->second;
-
-  // Data layers to grab from reference
-  std::vector<std::string> ref_layers;
-  // Data layers to grab from input map
-  std::vector<std::string> inp_layers;
-
-  // Surface normal computation is optional, therefore use only if set
-  if (_use_surface_normals)
-  {
-    ref_layers = {"elevation", "elevation_normal", "elevation_var", "elevation_hyp", "elevation_angle", "elevated", "color_rgb", "num_observations", "valid"};
-    inp_layers = {"elevation", "elevation_normal", "elevation_angle", "elevated", "color_rgb", "valid"};
-  }
-  else
-  {
-    ref_layers = {"elevation", "elevation_var", "elevation_hyp", "elevation_angle", "elevated", "color_rgb", "num_observations", "valid"};
-    inp_layers = {"elevation", "elevation_angle", "elevated", "color_rgb", "valid"};
-  }
-
-  GridQuickAccess::Ptr ref_grid_element = std::make_shared<GridQuickAccess>(ref_layers, ref);
-  GridQuickAccess::Ptr inp_grid_element = std::make_shared<GridQuickAccess>(inp_layers, inp);
+  // Overlap between global mosaic (ref) and new data (inp). Reference data is modified inplace.
+  blending::blendOverlap(*overlap->first, *overlap->second,
+                         blending::Settings{_th_elevation_var, _th_elevation_min_nobs, _use_surface_normals});
+}
 
-  cv::Size size = ref.size();
-  for (int r = 0; r < size.height; ++r)
-    for (int c = 0; c < size.width; ++c)
-    {
-      // Move the quick access element to current position
-      ref_grid_element->move(r, c);
-      inp_grid_element->move(r, c);
-
-      // Check cases for input
-      if (*inp_grid_element->valid == 0)
-        continue;
-      if (*ref_grid_element->elevated && !*inp_grid_element->elevated)
-        continue;
-
-      if (*ref_grid_element->nobs == 0 || (*inp_grid_element->elevated && !*ref_grid_element->elevated))
-        setGridElement(ref_grid_element, inp_grid_element);
-      else
-        updateGridElement(ref_grid_element, inp_grid_element);
+void Mosaicing::saveIter(uint32_t id, const cv::Rect2d &roi_update)
+{
+  if (_settings_save.save_ortho_gtiff_all)
+    saveIterGeoTIFF(roi_update);
+
+  // Incremental images show the whole global map, so they require it densely. Only the layers of the active savings
+  // are assembled, nothing at all if none of them is active.
+  std::vector<std::string> layer_names;
+  if (_settings_save.save_valid || _settings_save.save_elevation_all || _settings_save.save_elevation_var_all
+      || _settings_save.save_elevation_obs_angle_all || _settings_save.save_num_obs_all)
+    layer_names.push_back("valid");
+  if (_settings_save.save_ortho_rgb_all)
+    layer_names.push_back("color_rgb");
+  if (_settings_save.save_elevation_all)
+    layer_names.push_back("elevation");
+  if (_settings_save.save_elevation_var_all)
+    layer_names.push_back("elevation_var");
+  if (_settings_save.save_elevation_obs_angle_all)
+    layer_names.push_back("elevation_angle");
+  if (_settings_save.save_num_obs_all)
+    layer_names.push_back("num_observations");
+  if (layer_names.empty())
+    return;
 
-    }
+  // Dense map is assembled freshly from the tiles and owned by the save jobs only, so no further copy is necessary
+  CvGridMap global_map = _global_map->getSubmap(layer_names);
+  std::string path = _stage_path;
 
-  return ref;
+  if (_settings_save.save_valid)
+    saveAsync("valid", [=](){ io::saveImage(global_map["valid"], path + "/valid", "valid", id); });
+  if (_settings_save.save_ortho_rgb_all)
+    saveAsync("ortho", [=](){ io::saveImage(global_map["color_rgb"], path + "/ortho", "ortho", id); });
+  if (_settings_save.save_elevation_all)
+    saveAsync("elevation", [=](){ io::saveImageColorMap(global_map["elevation"], global_map["valid"], path + "/elevation/color_map", "elevation", id, io::ColormapType::ELEVATION); });
+  if (_settings_save.save_elevation_var_all)
+    saveAsync("variance", [=](){ io::saveImageColorMap(global_map["elevation_var"], global_map["valid"], path + "/variance", "variance", id,io::ColormapType::ELEVATION); });
+  if (_settings_save.save_elevation_obs_angle_all)
+    saveAsync("angle", [=](){ io::saveImageColorMap(global_map["elevation_angle"], global_map["valid"], path + "/obs_angle", "angle", id, io::ColormapType::ELEVATION); });
+  if (_settings_save.save_num_obs_all)
+    saveAsync("nobs", [=](){ io::saveImageColorMap(global_map["num_observations"], global_map["valid"], path + "/nobs", "nobs", id, io::ColormapType::ELEVATION); });
 }
 
-void Mosaicing::updateGridElement(const GridQuickAccess::Ptr &ref, const GridQuickAccess::Ptr &inp)
+void Mosaicing::saveIterGeoTIFF(const cv::Rect2d &roi_update)
 {
-  // Formulas avr+std_dev: https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Online_algorithm
-  assert(*inp->valid == 255);
+  // GeoTIFF is kept as one file, of which only the tiles overlapping the updated region are rewritten. Regions of all
+  // keyframes are accumulated, until the previous update of the file has finished.
+  if (roi_update.area() > 0.0)
+    _gtiff_roi_dirty = (_gtiff_roi_dirty.area() > 0.0 ? (_gtiff_roi_dirty | roi_update) : roi_update);
+  if (_gtiff_state->is_writing || _gtiff_roi_dirty.area() <= 0.0)
+    return;
 
-  if (!*inp->elevated)
+  // File is in an unknown state after a failed write, therefore written completely
+  if (_gtiff_state->has_failed)
   {
-    *ref->ele = *inp->ele;
-    *ref->elevated = 0;
-    *ref->valid = 255;
-    *ref->nobs = (*ref->nobs)+(uint16_t)1;
-    if (fabsf(*inp->angle - 90) < fabsf(*ref->angle - 90))
-    {
-      *ref->angle = *inp->angle;
-      *ref->rgb = *inp->rgb;
-    }
-    return;
+    _gtiff_roi_file = cv::Rect2d();
+    _gtiff_state->has_failed = false;
   }
 
-  // First assume grid element is not valid and set only if legitimate values were computed.
-  *ref->valid = 0;
-
-  // First compute new variance of elevation WITH input elevation and check if it is below threshold
-  // If yes, update average elevation for grid element and return
-  // If no, check if hypothesis is valid
-  float variance_new = ((*ref->nobs) + 1 - 2) / (float) ((*ref->nobs) + 1 - 1) * (*ref->var)
-      + (*inp->ele - *ref->ele)*(*inp->ele - *ref->ele) / (float) ((*ref->nobs) + 1);
-  if (variance_new < _th_elevation_var)
+  // Only the dirty region is extracted from the tiles. The dense map is only needed, if the extent of the global map
+  // has changed and the file has to be written completely.
+  cv::Rect2d roi_map = _global_map->roi();
+  bool is_complete = (roi_map != _gtiff_roi_file);
+  CvGridMap map = (is_complete ? _global_map->getSubmap({"color_rgb"})
+                               : _global_map->getSubmap({"color_rgb"}, _gtiff_roi_dirty));
+  std::string filename = _stage_path + "/ortho/ortho_incremental.tif";
+  uint8_t zone = _utm_reference->zone;
+  std::shared_ptr<GeoTIFFState> state = _gtiff_state;
+
+  // Job is not droppable, otherwise the dirty region would be lost and the file stays outdated
+  state->is_writing = true;
+  bool is_queued = saveAsync("gtiff", [=]()
   {
-    *ref->ele = (*ref->ele) + ((*inp->ele) - (*ref->ele))/ (float)(*ref->nobs+1);
-    *ref->var = variance_new;
-    *ref->nobs = (*ref->nobs)+(uint16_t)1;
-    if (_use_surface_normals)
-      *ref->normal = (*ref->normal) + ((*inp->normal) - (*ref->normal))/ (float)(*ref->nobs+1);
-    if (*ref->nobs >= _th_elevation_min_nobs)
-      *ref->valid = 255;
-    // Color blending
-    if (fabsf(*inp->angle - 90) < fabsf(*ref->angle - 90))
+    try
     {
-      *ref->angle = *inp->angle;
-      *ref->rgb = *inp->rgb;
+      if (is_complete)
+        io::saveGeoTIFF(map, "color_rgb", zone, filename);
+      else if (!io::updateGeoTIFF(map, "color_rgb", roi_map, filename))
+        throw(std::runtime_error("Error: GeoTIFF '" + filename + "' does not match the global map."));
     }
-    return;
-  }
-
-  // Compute std deviation of elevation hypothesis WITH input elevation. Check then if below threshold.
-  // If yes OR hypothesis is better than set elevation, switch hypothesis and elevation, update std deviation
-  // If no, go on
-  if (!std::isnan(*ref->hyp))
-  {
-    float variance_hyp = ((*inp->ele)-(*ref->hyp))*((*inp->ele)-(*ref->hyp)) / 2.0f;
-    if (variance_hyp < _th_elevation_var || variance_hyp < variance_new)
+    catch (...)
     {
-      float elevation = (*ref->ele);
-      *ref->var = variance_hyp;
-      *ref->ele = ((*ref->hyp) + (*inp->ele))/2.0f;
-      *ref->hyp = elevation;
-      *ref->nobs = 2;
-      if (_use_surface_normals)
-        *ref->normal = ((*ref->normal) + (*inp->normal))/2.0f;
-      if (*ref->nobs >= _th_elevation_min_nobs)
-        *ref->valid = 255;
-      *ref->angle = *inp->angle;
-      *ref->rgb = *inp->rgb;
+      state->has_failed = true;
+      state->is_writing = false;
+      throw;
     }
-  }
+    state->is_writing = false;
+  }, false);
 
-  // No valid assumption of grid element can be identified.
-  // Set current input as new hypothesis and choose the one with the lowest variance.
-  *ref->hyp = *inp->ele;
+  if (!is_queued)
+  {
+    state->is_writing = false;
+    return;
+  }
+  _gtiff_roi_file = roi_map;
+  _gtiff_roi_dirty = cv::Rect2d();
 }
 
-void Mosaicing::setGridElement(const GridQuickAccess::Ptr &ref, const GridQuickAccess::Ptr &inp)
+void Mosaicing::saveAll()
 {
-  assert(*inp->valid == 255);
-  *ref->ele = *inp->ele;
-  *ref->elevated = *inp->elevated;
-  *ref->var = 0.0f;
-  *ref->hyp = 0.0f;
-  *ref->angle = *inp->angle;
-  *ref->rgb = *inp->rgb;
-  *ref->nobs = 1;
-  *ref->valid = 255;
-  if (_use_surface_normals)
-    *ref->normal = *inp->normal;
-}
+  if (_global_map == nullptr || _global_map->empty())
+    return;
 
-void Mosaicing::saveIter(uint32_t id)
-{
-  if (_settings_save.save_valid)
-    io::saveImage((*_global_map)["valid"], _stage_path + "/valid", "valid", id);
-  if (_settings_save.save_ortho_rgb_all)
-    io::saveImage((*_global_map)["color_rgb"], _stage_path + "/ortho", "ortho", id);
-  if (_settings_save.save_elevation_all)
-    io::saveImageColorMap((*_global_map)["elevation"], (*_global_map)["valid"], _stage_path + "/elevation/color_map", "elevation", id, io::ColormapType::ELEVATION);
-  if (_settings_save.save_elevation_var_all)
-    io::saveImageColorMap((*_global_map)["elevation_var"], (*_global_map)["valid"], _stage_path + "/variance", "variance", id,io::ColormapType::ELEVATION);
-  if (_settings_save.save_elevation_obs_angle_all)
-    io::saveImageColorMap((*_global_map)["elevation_angle"], (*_global_map)["valid"], _stage_path + "/obs_angle", "angle", id, io::ColormapType::ELEVATION);
-  if (_settings_save.save_num_obs_all)
-    io::saveImageColorMap((*_global_map)["num_observations"], (*_global_map)["valid"], _stage_path + "/nobs", "nobs", id, io::ColormapType::ELEVATION);
-  if (_settings_save.save_ortho_gtiff_all)
-    io::saveGeoTIFF(*_global_map, "color_rgb", _utm_reference->zone, _stage_path + "/ortho", "ortho", id);
-}
+  CvGridMap::Ptr global_map = std::make_shared<CvGridMap>(_global_map->toCvGridMap());
 
-void Mosaicing::saveAll()
-{
   // 2D map output
   if (_settings_save.save_ortho_rgb_one)
-    io::saveImage((*_global_map)["color_rgb"], _stage_path + "/ortho", "ortho");
+    io::saveImage((*global_map)["color_rgb"], _stage_path + "/ortho", "ortho");
   if (_settings_save.save_elevation_one)
-    io::saveImageColorMap((*_global_map)["elevation"], (*_global_map)["valid"], _stage_path + "/elevation/color_map", "elevation", io::ColormapType::ELEVATION);
+    io::saveImageColorMap((*global_map)["elevation"], (*global_map)["valid"], _stage_path + "/elevation/color_map", "elevation", io::ColormapType::ELEVATION);
   if (_settings_save.save_elevation_var_one)
-    io::saveImageColorMap((*_global_map)["elevation_var"], (*_global_map)["valid"], _stage_path + "/variance", "variance", io::ColormapType::ELEVATION);
+    io::saveImageColorMap((*global_map)["elevation_var"], (*global_map)["valid"], _stage_path + "/variance", "variance", io::ColormapType::ELEVATION);
   if (_settings_save.save_elevation_obs_angle_one)
-    io::saveImageColorMap((*_global_map)["elevation_angle"], (*_global_map)["valid"], _stage_path + "/obs_angle", "angle", io::ColormapType::ELEVATION);
+    io::saveImageColorMap((*global_map)["elevation_angle"], (*global_map)["valid"], _stage_path + "/obs_angle", "angle", io::ColormapType::ELEVATION);
   if (_settings_save.save_num_obs_one)
-    io::saveImageColorMap((*_global_map)["num_observations"], (*_global_map)["valid"], _stage_path + "/nobs", "nobs", io::ColormapType::ELEVATION);
+    io::saveImageColorMap((*global_map)["num_observations"], (*global_map)["valid"], _stage_path + "/nobs", "nobs", io::ColormapType::ELEVATION);
   if (_settings_save.save_num_obs_one)
-    io::saveGeoTIFF(*_global_map, "num_observations", _utm_reference->zone, _stage_path + "/nobs", "nobs");
+    io::saveGeoTIFF(*global_map, "num_observations", _utm_reference->zone, _stage_path + "/nobs", "nobs");
   if (_settings_save.save_ortho_gtiff_one)
-    io::saveGeoTIFF(*_global_map, "color_rgb", _utm_reference->zone, _stage_path + "/ortho", "ortho");
+    io::saveGeoTIFF(*global_map, "color_rgb", _utm_reference->zone, _stage_path + "/ortho", "ortho");
   if (_settings_save.save_elevation_one)
-    io::saveGeoTIFF(*_global_map, "elevation", _utm_reference->zone, _stage_path + "/elevation/gtiff", "elevation");
+    io::saveGeoTIFF(*global_map, "elevation", _utm_reference->zone, _stage_path + "/elevation/gtiff", "elevation");
 
   // 3D Point cloud output
   if (_settings_save.save_dense_ply)
   {
-    if (_global_map->exists("elevation_normal"))
-      io::saveElevationPointsToPLY(*_global_map, "elevation", "elevation_normal", "color_rgb", "valid", _stage_path + "/elevation/ply", "elevation");
+    if (global_map->exists("elevation_normal"))
+      io::saveElevationPointsToPLY(*global_map, "elevation", "elevation_normal", "color_rgb", "valid", _stage_path + "/elevation/ply", "elevation");
     else
-      io::saveElevationPointsToPLY(*_global_map, "elevation", "", "color_rgb", "valid", _stage_path + "/elevation/ply", "elevation");
+      io::saveElevationPointsToPLY(*global_map, "elevation", "", "color_rgb", "valid", _stage_path + "/elevation/ply", "elevation");
   }
 
   // 3D Mesh output
   if (_settings_save.save_elevation_mesh_one)
   {
-    std::vector<cv::Point2i> vertex_ids = _mesher->buildMesh(*_global_map, "valid");
-    if (_global_map->exists("elevation_normal"))
-      io::saveElevationMeshToPLY(*_global_map, vertex_ids, "elevation", "elevation_normal", "color_rgb", "valid", _stage_path + "/elevation/mesh", "elevation");
+    std::vector<cv::Point2i> vertex_ids = buildMesh(*global_map);
+    if (global_map->exists("elevation_normal"))
+      io::saveElevationMeshToPLY(*global_map, vertex_ids, "elevation", "elevation_normal", "color_rgb", "valid", _stage_path + "/elevation/mesh", "elevation");
     else
-      io::saveElevationMeshToPLY(*_global_map, vertex_ids, "elevation", "", "color_rgb", "valid", _stage_path + "/elevation/mesh", "elevation");
+      io::saveElevationMeshToPLY(*global_map, vertex_ids, "elevation", "", "color_rgb", "valid", _stage_path + "/elevation/mesh", "elevation");
   }
 }
 
@@ -338,8 +335,12 @@ void Mosaicing::reset()
   LOG_F(INFO, "Reseted!");
 }
 
-void Mosaicing::finishCallback()
+void Mosaicing::finishStageCallback()
 {
+  // Previous update of the incremental GeoTIFF has finished, so the region not handed to the writer yet is written now
+  if (_settings_save.save_ortho_gtiff_all && _global_map != nullptr)
+    saveIterGeoTIFF(cv::Rect2d());
+
   // First polish results
   runPostProcessing();
 
@@ -347,8 +348,8 @@ void Mosaicing::finishCallback()
   saveAll();
 
   // Publish final mesh at the end
-  if (_do_publish_mesh_at_finish)
-    _transport_mesh(createMeshFaces(_global_map), "output/mesh");
+  if (_do_publish_mesh_at_finish && _global_map != nullptr && !_global_map->empty())
+    _transport_mesh(createMeshFaces(std::make_shared<CvGridMap>(_global_map->getSubmap({"elevation", "color_rgb", "valid"}))), "output/mesh");
 }
 
 void Mosaicing::runPostProcessing()
@@ -361,6 +362,8 @@ Frame::Ptr Mosaicing::getNewFrame()
   std::unique_lock<std::mutex> lock(_mutex_buffer);
   Frame::Ptr frame = _buffer.front();
   _buffer.pop_front();
+  updateStatisticsQueueDepth(_buffer.size());
+  updateStatisticsProcessing(frame);
   return (std::move(frame));
 }
 
@@ -398,13 +401,16 @@ void Mosaicing::initStageCallback()
 void Mosaicing::printSettingsToLog()
 {
   LOG_F(INFO, "### Stage process settings ###");
+  LOG_F(INFO, "- publish_map_every_nth_kf: %i", _publish_map_every_nth_kf);
   LOG_F(INFO, "- publish_mesh_nth_iter: %i", _publish_mesh_nth_iter);
   LOG_F(INFO, "- publish_mesh_every_nth_kf: %i", _publish_mesh_every_nth_kf);
   LOG_F(INFO, "- do_publish_mesh_at_finish: %i", _do_publish_mesh_at_finish);
   LOG_F(INFO, "- downsample_publish_mesh: %4.2f", _downsample_publish_mesh);
+  LOG_F(INFO, "- mesh_method: %s", _mesh_method.c_str());
   LOG_F(INFO, "- use_surface_normals: %i", _use_surface_normals);
   LOG_F(INFO, "- th_elevation_min_nobs: %i", _th_elevation_min_nobs);
   LOG_F(INFO, "- th_elevation_var: %4.2f", _th_elevation_var);
+  LOG_F(INFO, "- tile_size: %i", _tile_size);
 
   LOG_F(INFO, "### Stage save settings ###");
   LOG_F(INFO, "- save_valid: %i", _settings_save.save_valid);
@@ -424,6 +430,13 @@ void Mosaicing::printSettingsToLog()
   LOG_F(INFO, "- save_dense_ply: %i", _settings_save.save_dense_ply);
 }
 
+std::vector<cv::Point2i> Mosaicing::buildMesh(const CvGridMap &map)
+{
+  if (_mesher_grid)
+    return _mesher_grid->buildMesh(map, "valid", "elevation");
+  return _mesher_delaunay->buildMesh(map, "valid");
+}
+
 std::vector<Face> Mosaicing::createMeshFaces(const CvGridMap::Ptr &map)
 {
   CvGridMap::Ptr mesh_sampled;
@@ -456,26 +469,41 @@ std::vector<Face> Mosaicing::createMeshFaces(const CvGridMap::Ptr &map)
     mesh_sampled = map;
   }
 
-  std::vector<cv::Point2i> vertex_ids = _mesher->buildMesh(*mesh_sampled, "valid");
+  std::vector<cv::Point2i> vertex_ids = buildMesh(*mesh_sampled);
   std::vector<Face> faces = cvtToMesh((*mesh_sampled), "elevation", "color_rgb", vertex_ids);
   return faces;
 }
 
-void Mosaicing::publish(const Frame::Ptr &frame, const CvGridMap::Ptr &map, const CvGridMap::Ptr &update, uint64_t timestamp)
+void Mosaicing::publish(const Frame::Ptr &frame, const CvGridMap::Ptr &update, uint64_t timestamp)
 {
   // First update statistics about outgoing frame rate
-  updateFpsStatisticsOutgoing();
+  updateStatisticsOutgoing(frame);
 
-  _transport_img((*_global_map)["color_rgb"], "output/rgb");
-  _transport_img(analysis::convertToColorMapFromCVFC1((*_global_map)["elevation"],
-                                                      (*_global_map)["valid"],
-                                                      cv::COLORMAP_JET), "output/elevation");
   _transport_cvgridmap(update->getSubmap({"color_rgb"}), _utm_reference->zone, _utm_reference->band, "output/update/ortho");
   //_transport_cvgridmap(update->getSubmap({"elevation", "valid"}), _utm_reference->zone, _utm_reference->band, "output/update/elevation");
 
+  // Dense global map is only assembled when a publish of the full map or the mesh is actually due. Throttling the full
+  // map keeps the cost per keyframe from growing with the mosaic.
+  CvGridMap::Ptr map;
+  auto getMap = [&]() -> CvGridMap::Ptr
+  {
+    if (map == nullptr)
+      map = std::make_shared<CvGridMap>(_global_map->getSubmap({"color_rgb", "elevation", "valid"}));
+    return map;
+  };
+
+  if (_publish_map_every_nth_kf > 0 && ++_publish_map_nth_iter >= _publish_map_every_nth_kf)
+  {
+    _transport_img((*getMap())["color_rgb"], "output/rgb");
+    _transport_img(analysis::convertToColorMapFromCVFC1((*getMap())["elevation"],
+                                                        (*getMap())["valid"],
+                                                        cv::COLORMAP_JET), "output/elevation");
+    _publish_map_nth_iter = 0;
+  }
+
   if (_publish_mesh_every_nth_kf > 0 && _publish_mesh_every_nth_kf == _publish_mesh_nth_iter)
   {
-    std::vector<Face> faces = createMeshFaces(map);
+    std::vector<Face> faces = createMeshFaces(getMap());
     std::thread t(_transport_mesh, faces, "output/mesh");
     t.detach();
     _publish_mesh_nth_iter = 0;
@@ -485,56 +513,3 @@ void Mosaicing::publish(const Frame::Ptr &frame, const CvGridMap::Ptr &map, cons
     _publish_mesh_nth_iter++;
   }
 }
-
-Mosaicing::GridQuickAccess::GridQuickAccess(const std::vector<std::string> &layer_names, const CvGridMap &map)
-: ele(nullptr),
-  var(nullptr),
-  hyp(nullptr),
-  nobs(nullptr),
-  rgb(nullptr),
-  valid(nullptr)
-{
-  for (const auto& layer_name : layer_names)
-    if (layer_name == "elevation")
-      _elevation = map["elevation"];
-    else if (layer_name == "elevation_normal")
-      _elevation_normal = map["elevation_normal"];
-    else if (layer_name == "elevation_var")
-      _elevation_var = map["elevation_var"];
-    else if (layer_name == "elevation_hyp")
-      _elevation_hyp = map["elevation_hyp"];
-    else if (layer_name == "elevation_angle")
-      _elevation_angle = map["elevation_angle"];
-    else if (layer_name == "color_rgb")
-      _color_rgb = map["color_rgb"];
-    else if (layer_name == "num_observations")
-      _num_observations = map["num_observations"];
-    else if (layer_name == "elevated")
-      _elevated = map["elevated"];
-    else if (layer_name == "valid")
-      _valid = map["valid"];
-    else
-      throw(std::out_of_range("Error creating GridQuickAccess object. Demanded layer name does not exist!"));
-
-  assert(!_elevation.empty() && _elevation.type() == CV_32F);
-  assert(!_elevation_angle.empty() && _elevation_angle.type() == CV_32F);
-  assert(!_color_rgb.empty() && _color_rgb.type() == CV_8UC4);
-  assert(!_elevated.empty() && _elevated.type() == CV_8UC1);
-  assert(!_valid.empty() && _valid.type() == CV_8UC1);
-
-  move(0, 0);
-}
-
-void Mosaicing::GridQuickAccess::move(int row, int col)
-{
-  ele = &_elevation.ptr<float>(row)[col];
-  var = &_elevation_var.ptr<float>(row)[col];
-  hyp = &_elevation_hyp.ptr<float>(row)[col];
-  angle = &_elevation_angle.ptr<float>(row)[col];
-  nobs = &_num_observations.ptr<uint16_t>(row)[col];
-  rgb = &_color_rgb.ptr<cv::Vec4b>(row)[col];
-  elevated = &_elevated.ptr<uchar>(row)[col];
-  valid = &_valid.ptr<uchar>(row)[col];
-  if (!_elevation_normal.empty())
-    normal = &_elevation_normal.ptr<cv::Vec3f>(row)[col];
-}
\ No newline at end of file
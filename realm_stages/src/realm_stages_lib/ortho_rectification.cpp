@@ -28,6 +28,8 @@ using namespace stages;
 OrthoRectification::OrthoRectification(const StageSettings::Ptr &stage_set, double rate)
     : StageBase("ortho_rectification", (*stage_set)["path_output"].toString(), rate, (*stage_set)["queue_size"].toInt()),
       _GSD((*stage_set)["GSD"].toDouble()),
+      _interpolation_name((*stage_set)["interpolation"].toString()),
+      _interpolation(toInterpolationFlag(_interpolation_name)),
       _settings_save({(*stage_set)["save_valid"].toInt() > 0,
                   (*stage_set)["save_ortho_rgb"].toInt() > 0,
                   (*stage_set)["save_ortho_gtiff"].toInt() > 0,
@@ -36,28 +38,43 @@ OrthoRectification::OrthoRectification(const StageSettings::Ptr &stage_set, doub
 {
   std::cout << "Stage [" << _stage_name << "]: Created Stage with Settings: " << std::endl;
   stage_set->print();
+
+  setEventDriven((*stage_set)["event_driven"].toInt() > 0);
+  initAsyncWriter((*stage_set)["io_threads"].toInt(),
+                  (*stage_set)["io_queue_size"].toInt(),
+                  (*stage_set)["io_overflow_policy"].toString());
+  initMetricsExport((*stage_set)["metrics_period"].toInt(),
+                    (*stage_set)["metrics_port"].toInt());
+  initTracing((*stage_set)["trace"].toInt() > 0);
 }
 
 void OrthoRectification::addFrame(const Frame::Ptr &frame)
 {
   // First update statistics about incoming frame rate
-  updateFpsStatisticsIncoming();
+  updateStatisticsIncoming(frame);
 
   if (!frame->hasObservedMap())
   {
     LOG_F(INFO, "Input frame has no surface informations. Dropping...");
+    updateStatisticsDropped(frame);
     return;
   }
   if (!frame->getObservedMap()->exists("elevation"))
   {
     LOG_F(INFO, "Input frame missing surface elevation layer. Dropping...");
+    updateStatisticsDropped(frame);
     return;
   }
   std::unique_lock<std::mutex> lock(_mutex_buffer);
   _buffer.push_back(frame);
   // Ringbuffer implementation for buffer with no pose
   if (_buffer.size() > _queue_size)
+  {
+    updateStatisticsDropped(_buffer.front());
     _buffer.pop_front();
+  }
+  updateStatisticsQueueDepth(_buffer.size());
+  notifyWorkAvailable();
 }
 
 bool OrthoRectification::process()
@@ -75,27 +92,33 @@ bool OrthoRectification::process()
     LOG_IF_F(INFO, resize_quotient < 0.9, "Loss of resolution! Consider downsizing depth map or increase GSD.");
     LOG_IF_F(INFO, resize_quotient > 1.1, "Large resizing of elevation map detected. Keep in mind that ortho resolution is now >> spatial resolution");
 
-    // Check ranges of input elevation, this is necessary to correct resizing interpolation errors
-    double ele_min, ele_max;
-    cv::Point2i min_loc, max_loc;
-    cv::minMaxLoc((*observed_map)["elevation"], &ele_min, &ele_max, &min_loc, &max_loc, (*observed_map)["valid"]);
-
-    // First change resolution of observed map to desired GSD
-    observed_map->setLayerInterpolation("valid", CV_INTER_NN);
-    observed_map->changeResolution(_GSD);
-
-    // After resizing through bilinear interpolation there can occure bad elevation values at the border
-    cv::Mat mask_low = ((*observed_map)["elevation"] < ele_min);
-    cv::Mat mask_high = ((*observed_map)["elevation"] > ele_max);
-    (*observed_map)["elevation"].setTo(std::numeric_limits<float>::quiet_NaN(), mask_low);
-    (*observed_map)["elevation"].setTo(std::numeric_limits<float>::quiet_NaN(), mask_high);
-    (*observed_map)["valid"].setTo(0, mask_low);
-    (*observed_map)["valid"].setTo(0, mask_high);
+    // Surface generation should already provide the observed map at the desired GSD. Resampling is only a fallback.
+    if (fabs(resize_quotient - 1.0) > 10e-6)
+    {
+      LOG_F(WARNING, "Observed map is resampled to GSD. Set GSD of surface generation to %4.2f to avoid this.", _GSD);
+
+      // Check ranges of input elevation, this is necessary to correct resizing interpolation errors
+      double ele_min, ele_max;
+      cv::Point2i min_loc, max_loc;
+      cv::minMaxLoc((*observed_map)["elevation"], &ele_min, &ele_max, &min_loc, &max_loc, (*observed_map)["valid"]);
+
+      // First change resolution of observed map to desired GSD
+      observed_map->setLayerInterpolation("valid", CV_INTER_NN);
+      observed_map->changeResolution(_GSD);
+
+      // After resizing through bilinear interpolation there can occure bad elevation values at the border
+      cv::Mat mask_low = ((*observed_map)["elevation"] < ele_min);
+      cv::Mat mask_high = ((*observed_map)["elevation"] > ele_max);
+      (*observed_map)["elevation"].setTo(std::numeric_limits<float>::quiet_NaN(), mask_low);
+      (*observed_map)["elevation"].setTo(std::numeric_limits<float>::quiet_NaN(), mask_high);
+      (*observed_map)["valid"].setTo(0, mask_low);
+      (*observed_map)["valid"].setTo(0, mask_high);
+    }
 
     // Rectification needs img data, surface map and camera pose -> All contained in frame
     // Output, therefore the new additional data is written into rectified map
     CvGridMap map_rect;
-    ortho::rectify(frame, map_rect);
+    ortho::rectify(frame, map_rect, _interpolation);
     observed_map->add(map_rect, REALM_OVERWRITE_ALL, false);
 
     // Transport results
@@ -116,22 +139,39 @@ void OrthoRectification::reset()
 
 void OrthoRectification::saveIter(const CvGridMap& map, uint8_t zone, uint32_t id)
 {
+  // Map is the observed map of the frame, which is passed on to the next stage. Writes therefore work on a snapshot.
+  std::vector<std::string> layer_names;
+  if (_settings_save.save_valid || _settings_save.save_elevation_angle)
+    layer_names.emplace_back("valid");
+  if (_settings_save.save_ortho_rgb || _settings_save.save_ortho_gtiff)
+    layer_names.emplace_back("color_rgb");
+  if (_settings_save.save_elevation_angle)
+    layer_names.emplace_back("elevation_angle");
+  if (_settings_save.save_elevation)
+    layer_names.emplace_back("elevation");
+
+  if (layer_names.empty())
+    return;
+
+  CvGridMap snapshot = map.cloneSubmap(layer_names);
+  std::string path = _stage_path;
+
   if (_settings_save.save_valid)
-    io::saveImage(map["valid"], _stage_path + "/valid", "valid", id);
+    saveAsync("valid", [=](){ io::saveImage(snapshot["valid"], path + "/valid", "valid", id); });
   if (_settings_save.save_ortho_rgb)
-    io::saveImage(map["color_rgb"], _stage_path + "/ortho", "ortho", id);
+    saveAsync("ortho", [=](){ io::saveImage(snapshot["color_rgb"], path + "/ortho", "ortho", id); });
   if (_settings_save.save_elevation_angle)
-    io::saveImageColorMap(map["elevation_angle"], map["valid"], _stage_path + "/angle", "angle", id, io::ColormapType::ELEVATION);
+    saveAsync("angle", [=](){ io::saveImageColorMap(snapshot["elevation_angle"], snapshot["valid"], path + "/angle", "angle", id, io::ColormapType::ELEVATION); });
   if (_settings_save.save_ortho_gtiff)
-    io::saveGeoTIFF(map, "color_rgb", zone, _stage_path + "/gtiff", "gtiff", id);
+    saveAsync("gtiff", [=](){ io::saveGeoTIFF(snapshot, "color_rgb", zone, path + "/gtiff", "gtiff", id); });
   if (_settings_save.save_elevation)
-    io::saveGeoTIFF(map, "elevation", zone, _stage_path + "/elevation", "elevation", id);
+    saveAsync("elevation", [=](){ io::saveGeoTIFF(snapshot, "elevation", zone, path + "/elevation", "elevation", id); });
 }
 
 void OrthoRectification::publish(const Frame::Ptr &frame)
 {
   // First update statistics about outgoing frame rate
-  updateFpsStatisticsOutgoing();
+  updateStatisticsOutgoing(frame);
 
   _transport_frame(frame, "output/frame");
   _transport_img((*frame->getObservedMap())["color_rgb"], "output/rectified");
@@ -150,9 +190,22 @@ Frame::Ptr OrthoRectification::getNewFrame()
   std::unique_lock<std::mutex> lock(_mutex_buffer);
   Frame::Ptr frame = _buffer.front();
   _buffer.pop_front();
+  updateStatisticsQueueDepth(_buffer.size());
+  updateStatisticsProcessing(frame);
   return (std::move(frame));
 }
 
+int OrthoRectification::toInterpolationFlag(const std::string &name)
+{
+  if (name.empty() || name == "nearest")
+    return cv::INTER_NEAREST;
+  if (name == "bilinear")
+    return cv::INTER_LINEAR;
+  if (name == "bicubic")
+    return cv::INTER_CUBIC;
+  throw(std::invalid_argument("Error: Unknown interpolation '" + name + "' for rectification."));
+}
+
 void OrthoRectification::initStageCallback()
 {
   // Stage directory first
@@ -176,6 +229,7 @@ void OrthoRectification::printSettingsToLog()
 {
   LOG_F(INFO, "### Stage process settings ###");
   LOG_F(INFO, "- GSD: %4.2f", _GSD);
+  LOG_F(INFO, "- interpolation: %s", _interpolation_name.c_str());
 
   LOG_F(INFO, "### Stage save settings ###");
   LOG_F(INFO, "- save_valid: %i", _settings_save.save_valid);
@@ -0,0 +1,160 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <realm_core/loguru.h>
+#include <realm_stages/pipeline.h>
+
+using namespace realm;
+using namespace stages;
+
+Pipeline::Pipeline(const std::string &path_profile,
+                   const std::string &path_output,
+                   const std::string &method_vslam,
+                   const std::string &method_densifier)
+: _is_started(false),
+  _is_finished(false),
+  _fps(0.0)
+{
+  if (!io::dirExists(path_profile))
+    throw(std::runtime_error("Error: Profile folder '" + path_profile + "' was not found!"));
+
+  // Create sub directory with timestamp, all stages write into the same folder
+  _path_output = path_output + "/" + io::getDateTime();
+  if (!io::dirExists(path_output))
+    io::createDir(path_output);
+  if (!io::dirExists(_path_output))
+    io::createDir(_path_output);
+
+  CameraSettings::Ptr settings_camera = CameraSettingsFactory::load(path_profile + "/camera/calib.yaml");
+  _fps = (*settings_camera)["fps"].toDouble();
+
+  VisualSlamSettings::Ptr settings_vslam = VisualSlamSettingsFactory::load(
+      path_profile + "/pose_estimation/method/" + method_vslam + "_settings.yaml",
+      path_profile + "/pose_estimation/method");
+  DensifierSettings::Ptr settings_densifier = DensifierSettingsFactory::load(
+      path_profile + "/densification/method/" + method_densifier + "_settings.yaml",
+      path_profile + "/densification/method");
+
+  auto loadStageSettings = [&](const std::string &stage_type)
+  {
+    return StageSettingsFactory::load(stage_type, path_profile + "/" + stage_type + "/stage_settings.yaml");
+  };
+
+  _stages.push_back(std::make_shared<PoseEstimation>(loadStageSettings("pose_estimation"), settings_vslam, settings_camera, _fps));
+  _stages.push_back(std::make_shared<Densification>(loadStageSettings("densification"), settings_densifier, _fps));
+  _stages.push_back(std::make_shared<SurfaceGeneration>(loadStageSettings("surface_generation"), _fps));
+  _stages.push_back(std::make_shared<OrthoRectification>(loadStageSettings("ortho_rectification"), _fps));
+  _stages.push_back(std::make_shared<Mosaicing>(loadStageSettings("mosaicing"), _fps));
+
+  linkStages();
+
+  for (const auto &stage : _stages)
+    stage->initStagePath(_path_output);
+}
+
+Pipeline::~Pipeline()
+{
+  // In case of an unproper shutdown, at least call the finish procedure
+  if (_is_started && !_is_finished)
+    finishStages();
+}
+
+void Pipeline::start()
+{
+  for (const auto &stage : _stages)
+    stage->start();
+  _is_started = true;
+  LOG_F(INFO, "Started pipeline with %lu stages. Output: %s", _stages.size(), _path_output.c_str());
+}
+
+void Pipeline::addFrame(const Frame::Ptr &frame)
+{
+  _stages.front()->addFrame(frame);
+}
+
+bool Pipeline::isInputIdle() const
+{
+  return _stages.front()->isIdle();
+}
+
+void Pipeline::finish(int64_t t_settle)
+{
+  if (!_is_started || _is_finished)
+    return;
+
+  // Frames can be handed over in between stages at any time, so all of them must be idle at once for the settle time
+  auto t_idle = std::chrono::steady_clock::now();
+  while (true)
+  {
+    bool is_idle = true;
+    for (const auto &stage : _stages)
+      is_idle = is_idle && stage->isIdle();
+
+    auto t_now = std::chrono::steady_clock::now();
+    if (!is_idle)
+      t_idle = t_now;
+    else if (std::chrono::duration_cast<std::chrono::milliseconds>(t_now - t_idle).count() >= t_settle)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  finishStages();
+}
+
+double Pipeline::getFps() const
+{
+  return _fps;
+}
+
+std::string Pipeline::getOutputPath() const
+{
+  return _path_output;
+}
+
+void Pipeline::finishStages()
+{
+  for (const auto &stage : _stages)
+  {
+    stage->requestFinish();
+    stage->join();
+  }
+  _is_finished = true;
+  LOG_F(INFO, "Finished pipeline.");
+}
+
+void Pipeline::linkStages()
+{
+  for (size_t i = 0; i < _stages.size(); ++i)
+  {
+    // Stages are owned by the pipeline and joined before destruction, so the raw pointer is valid for all transports
+    StageBase* stage_next = (i + 1 < _stages.size() ? _stages[i + 1].get() : nullptr);
+    _stages[i]->registerFrameTransport([stage_next](const Frame::Ptr &frame, const std::string &topic)
+    {
+      if (stage_next && topic == "output/frame")
+        stage_next->addFrame(frame);
+    });
+
+    _stages[i]->registerPoseTransport([](const cv::Mat &, uint8_t, char, const std::string &){});
+    _stages[i]->registerPointCloudTransport([](const cv::Mat &, const std::string &){});
+    _stages[i]->registerDepthMapTransport([](const cv::Mat &, const std::string &){});
+    _stages[i]->registerImageTransport([](const cv::Mat &, const std::string &){});
+    _stages[i]->registerMeshTransport([](const std::vector<Face> &, const std::string &){});
+    _stages[i]->registerCvGridMapTransport([](const CvGridMap &, uint8_t, char, const std::string &){});
+  }
+}
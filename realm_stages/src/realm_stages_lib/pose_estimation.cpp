@@ -60,6 +60,11 @@ PoseEstimation::PoseEstimation(const StageSettings::Ptr &stage_set,
     _georeferencer = std::make_shared<GeometricReferencer>(_th_error_georef);
   }
 
+  setEventDriven((*stage_set)["event_driven"].toInt() > 0);
+  initMetricsExport((*stage_set)["metrics_period"].toInt(),
+                    (*stage_set)["metrics_port"].toInt());
+  initTracing((*stage_set)["trace"].toInt() > 0);
+
   // Create Pose Estimation publisher
   _stage_publisher.reset(new PoseEstimationIO(this, rate, true));
   _stage_publisher->start();
@@ -81,7 +86,7 @@ PoseEstimation::~PoseEstimation()
 void PoseEstimation::addFrame(const Frame::Ptr &frame)
 {
   // First update statistics about incoming frame rate
-  updateFpsStatisticsIncoming();
+  updateStatisticsIncoming(frame);
 
   // The user can provide a-priori georeferencing. Check if this is the case
   if (!_is_georef_initialized && frame->isGeoreferenced())
@@ -100,8 +105,10 @@ void PoseEstimation::addFrame(const Frame::Ptr &frame)
   if (_buffer_no_pose.size() > 5)
   {
     std::unique_lock<std::mutex> lock(_mutex_buffer_no_pose);
+    updateStatisticsDropped(_buffer_no_pose.front());
     _buffer_no_pose.pop_front();
   }
+  notifyWorkAvailable();
 
   _transport_pose(frame->getDefaultPose(), frame->getGnssUtm().zone, frame->getGnssUtm().band, "output/pose/gnss");
 }
@@ -393,6 +400,8 @@ Frame::Ptr PoseEstimation::getNewFrameTracking()
   std::unique_lock<std::mutex> lock(_mutex_buffer_no_pose);
   Frame::Ptr frame = _buffer_no_pose.front();
   _buffer_no_pose.pop_front();
+  updateStatisticsQueueDepth(_buffer_no_pose.size());
+  updateStatisticsProcessing(frame);
   return std::move(frame);
 }
 
@@ -536,7 +545,7 @@ void PoseEstimationIO::publishSurfacePoints(const Frame::Ptr &frame)
 void PoseEstimationIO::publishFrame(const Frame::Ptr &frame)
 {
   // First update statistics about outgoing frame rate
-  _stage_handle->updateFpsStatisticsOutgoing();
+  _stage_handle->updateStatisticsOutgoing(frame);
 
   // Two situation can occure, when publishing a frame is triggered
   // 1) Frame is marked as keyframe by the SLAM -> publish directly
@@ -24,6 +24,8 @@
 
 using namespace realm;
 
+constexpr size_t StageBase::kMaxTrackedFrames;
+
 StageBase::StageBase(const std::string &name, const std::string &path, double rate, int queue_size)
 : WorkerThreadBase("Stage [" + name + "]", static_cast<int64_t>(1/rate*1000.0), true),
   _stage_name(name),
@@ -33,8 +35,24 @@ StageBase::StageBase(const std::string &name, const std::string &path, double ra
   _t_statistics_period(10),
   _counter_frames_in(0),
   _counter_frames_out(0),
-  _timer_statistics_fps(new Timer(std::chrono::seconds(_t_statistics_period), std::bind(&StageBase::evaluateFpsStatistic, this)))
+  _timer_statistics_fps(new Timer(std::chrono::seconds(_t_statistics_period), std::bind(&StageBase::evaluateFpsStatistic, this))),
+  _metrics_period(0),
+  _is_tracing(false),
+  _frame_id_traced(0)
 {
+  metrics::Registry &registry = metrics::Registry::instance();
+  _metric_frames_in = registry.counter(_metrics_prefix + "frames_in");
+  _metric_frames_out = registry.counter(_metrics_prefix + "frames_out");
+  _metric_frames_dropped = registry.counter(_metrics_prefix + "frames_dropped");
+  _metric_queue_depth = registry.gauge(_metrics_prefix + "queue_depth");
+  _metric_queue_wait = registry.histogram(_metrics_prefix + "queue_wait_ms");
+  _metric_latency = registry.histogram(_metrics_prefix + "latency_ms");
+  _metric_frame_age = registry.histogram(_metrics_prefix + "frame_age_ms");
+  _metric_writer_written = registry.counter(_metrics_prefix + "writer_written");
+  _metric_writer_dropped = registry.counter(_metrics_prefix + "writer_dropped");
+  _metric_writer_failed = registry.counter(_metrics_prefix + "writer_failed");
+  _metric_writer_queue_depth = registry.gauge(_metrics_prefix + "writer_queue_depth");
+  _metric_writer_latency = registry.histogram(_metrics_prefix + "writer_latency_ms");
 }
 
 bool StageBase::changeParam(const std::string &name, const std::string &val)
@@ -55,41 +73,211 @@ void StageBase::initStagePath(const std::string &abs_path)
   LOG_F(INFO, "Successfully initialized!");
   LOG_F(INFO, "Stage path set to: %s", _stage_path.c_str());
   printSettingsToLog();
+
+  if (_metrics_exporter && _metrics_period > 0)
+    _metrics_exporter->startFileExport(_stage_path + "/metrics.txt", _metrics_period);
 }
 
+// All transports are wrapped to trace the time spent in them, e.g. for the serialization to the communication
+// interface. Spans of transports without a frame are assigned to the frame currently processed by the stage.
+
 void StageBase::registerFrameTransport(const std::function<void(const Frame::Ptr&, const std::string&)> &func)
 {
-  _transport_frame = func;
+  std::string name = _stage_name + "/transport";
+  _transport_frame = [func, name](const Frame::Ptr &frame, const std::string &topic)
+  {
+    tracing::ScopedSpan span(name, frame->getFrameId());
+    func(frame, topic);
+  };
 }
 
 void StageBase::registerPoseTransport(const std::function<void(const cv::Mat &, uint8_t zone, char band, const std::string &)> &func)
 {
-  _transport_pose = func;
+  std::string name = _stage_name + "/transport";
+  _transport_pose = [this, func, name](const cv::Mat &pose, uint8_t zone, char band, const std::string &topic)
+  {
+    tracing::ScopedSpan span(name, _frame_id_traced);
+    func(pose, zone, band, topic);
+  };
 }
 
 void StageBase::registerDepthMapTransport(const std::function<void(const cv::Mat&, const std::string&)> &func)
 {
-  _transport_depth_map = func;
+  std::string name = _stage_name + "/transport";
+  _transport_depth_map = [this, func, name](const cv::Mat &depth_map, const std::string &topic)
+  {
+    tracing::ScopedSpan span(name, _frame_id_traced);
+    func(depth_map, topic);
+  };
 }
 
 void StageBase::registerPointCloudTransport(const std::function<void(const cv::Mat&, const std::string&)> &func)
 {
-  _transport_pointcloud = func;
+  std::string name = _stage_name + "/transport";
+  _transport_pointcloud = [this, func, name](const cv::Mat &points, const std::string &topic)
+  {
+    tracing::ScopedSpan span(name, _frame_id_traced);
+    func(points, topic);
+  };
 }
 
 void StageBase::registerImageTransport(const std::function<void(const cv::Mat&, const std::string&)> &func)
 {
-  _transport_img = func;
+  std::string name = _stage_name + "/transport";
+  _transport_img = [this, func, name](const cv::Mat &img, const std::string &topic)
+  {
+    tracing::ScopedSpan span(name, _frame_id_traced);
+    func(img, topic);
+  };
 }
 
 void StageBase::registerMeshTransport(const std::function<void(const std::vector<Face>&, const std::string&)> &func)
 {
-  _transport_mesh = func;
+  std::string name = _stage_name + "/transport";
+  _transport_mesh = [this, func, name](const std::vector<Face> &faces, const std::string &topic)
+  {
+    tracing::ScopedSpan span(name, _frame_id_traced);
+    func(faces, topic);
+  };
 }
 
 void StageBase::registerCvGridMapTransport(const std::function<void(const CvGridMap &, uint8_t zone, char band, const std::string&)> &func)
 {
-  _transport_cvgridmap = func;
+  std::string name = _stage_name + "/transport";
+  _transport_cvgridmap = [this, func, name](const CvGridMap &map, uint8_t zone, char band, const std::string &topic)
+  {
+    tracing::ScopedSpan span(name, _frame_id_traced);
+    func(map, zone, band, topic);
+  };
+}
+
+void StageBase::initAsyncWriter(int num_threads, int queue_size, const std::string &overflow_policy)
+{
+  if (num_threads > 0)
+  {
+    _async_writer = std::make_shared<io::AsyncWriter>(num_threads, queue_size, io::AsyncWriter::toOverflowPolicy(overflow_policy));
+    _async_writer->setMetrics(_metric_writer_queue_depth, _metric_writer_latency);
+  }
+  else
+    _async_writer = nullptr;
+}
+
+bool StageBase::saveAsync(const std::string &description, const io::AsyncWriter::Job &job, bool is_droppable)
+{
+  if (_async_writer)
+    return _async_writer->enqueue(description, job, is_droppable);
+
+  // Synchronous writes are recorded as well, so the latencies of both modes can be compared
+  auto t_start = std::chrono::steady_clock::now();
+  job();
+  _metric_writer_latency->record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count());
+  return true;
+}
+
+void StageBase::flushAsync()
+{
+  if (_async_writer)
+    _async_writer->flush();
+}
+
+void StageBase::finishCallback()
+{
+  flushAsync();
+  finishStageCallback();
+  flushAsync();
+}
+
+void StageBase::initMetricsExport(int period, int port)
+{
+  _metrics_period = period;
+  if (period <= 0 && port <= 0)
+  {
+    _metrics_exporter = nullptr;
+    return;
+  }
+
+  _metrics_exporter = std::make_shared<metrics::Exporter>();
+  if (port > 0)
+    _metrics_exporter->startEndpoint(port);
+}
+
+void StageBase::initTracing(bool flag)
+{
+  _is_tracing = flag;
+  if (flag)
+    tracing::Tracer::instance().setEnabled(true);
+}
+
+void StageBase::updateStatisticsIncoming(const Frame::Ptr &frame)
+{
+  updateFpsStatisticsIncoming();
+  _metric_frames_in->increment();
+
+  std::unique_lock<std::mutex> lock(_mutex_frame_timing);
+  FrameTiming &timing = _frame_timing[frame->getFrameId()];
+  timing.t_arrival = std::chrono::steady_clock::now();
+  timing.t_arrival_trace = tracing::Tracer::now();
+  timing.t_processing_trace = timing.t_arrival_trace;
+  if (_frame_timing.size() > kMaxTrackedFrames)
+    _frame_timing.erase(_frame_timing.begin());
+}
+
+void StageBase::updateStatisticsProcessing(const Frame::Ptr &frame)
+{
+  _frame_id_traced = frame->getFrameId();
+
+  std::unique_lock<std::mutex> lock(_mutex_frame_timing);
+  auto it = _frame_timing.find(frame->getFrameId());
+  if (it == _frame_timing.end())
+    return;
+
+  FrameTiming &timing = it->second;
+  _metric_queue_wait->record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timing.t_arrival).count());
+  timing.t_processing_trace = tracing::Tracer::now();
+
+  if (tracing::Tracer::instance().isEnabled())
+  {
+    tracing::Span span{_stage_name + "/queue", frame->getFrameId(), timing.t_arrival_trace, timing.t_processing_trace, 0, 0};
+    tracing::Tracer::instance().record(span);
+    frame->addTraceSpan(span);
+  }
+}
+
+void StageBase::updateStatisticsOutgoing(const Frame::Ptr &frame)
+{
+  updateFpsStatisticsOutgoing();
+  _metric_frames_out->increment();
+  _metric_frame_age->record((tracing::Tracer::now() - frame->getTraceContext().t_acquisition)/1000.0);
+
+  std::unique_lock<std::mutex> lock(_mutex_frame_timing);
+  auto it = _frame_timing.find(frame->getFrameId());
+  if (it == _frame_timing.end())
+    return;
+
+  FrameTiming &timing = it->second;
+  _metric_latency->record(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timing.t_arrival).count());
+
+  if (tracing::Tracer::instance().isEnabled())
+  {
+    tracing::Span span{_stage_name + "/process", frame->getFrameId(), timing.t_processing_trace, tracing::Tracer::now(), 0, 0};
+    tracing::Tracer::instance().record(span);
+    frame->addTraceSpan(span);
+    tracing::Tracer::instance().recordFrame(frame->getFrameId(), frame->getTraceContext());
+  }
+  _frame_timing.erase(it);
+}
+
+void StageBase::updateStatisticsDropped(const Frame::Ptr &frame)
+{
+  _metric_frames_dropped->increment();
+
+  std::unique_lock<std::mutex> lock(_mutex_frame_timing);
+  _frame_timing.erase(frame->getFrameId());
+}
+
+void StageBase::updateStatisticsQueueDepth(size_t depth)
+{
+  _metric_queue_depth->set(static_cast<int64_t>(depth));
 }
 
 void StageBase::setStatisticsPeriod(uint32_t s)
@@ -120,4 +308,18 @@ void StageBase::evaluateFpsStatistic()
     _counter_frames_out = 0;
 
     LOG_F(INFO, "FPS in: %f, out: %f", fps_in, fps_out);
+
+    if (_is_tracing && _is_output_dir_initialized)
+      tracing::Tracer::instance().writeChromeTrace(_stage_path + "/trace.json");
+
+    if (_async_writer)
+    {
+      io::AsyncWriter::Statistics stats = _async_writer->getStatistics(true);
+      _metric_writer_written->increment(stats.num_written);
+      _metric_writer_dropped->increment(stats.num_dropped);
+      _metric_writer_failed->increment(stats.num_failed);
+      LOG_F(INFO, "Writer queue: %lu (max %lu), written: %lu, dropped: %lu, failed: %lu, latency avg: %4.1fms, max: %4.1fms",
+            stats.queue_depth, stats.queue_depth_max, stats.num_written, stats.num_dropped, stats.num_failed,
+            stats.latency_avg_ms, stats.latency_max_ms);
+    }
 }
\ No newline at end of file
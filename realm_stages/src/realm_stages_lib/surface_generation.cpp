@@ -29,6 +29,7 @@ SurfaceGeneration::SurfaceGeneration(const StageSettings::Ptr &settings, double
 : StageBase("surface_generation", (*settings)["path_output"].toString(), rate, (*settings)["queue_size"].toInt()),
   _try_use_elevation((*settings)["try_use_elevation"].toInt() > 0),
   _knn_radius_factor((*settings)["knn_radius_factor"].toDouble()),
+  _GSD((*settings)["GSD"].toDouble()),
   _is_projection_plane_offset_computed(false),
   _projection_plane_offset(0.0),
   _mode_surface_normals(static_cast<DigitalSurfaceModel::SurfaceNormalMode>((*settings)["mode_surface_normals"].toInt())),
@@ -37,18 +38,30 @@ SurfaceGeneration::SurfaceGeneration(const StageSettings::Ptr &settings, double
                   (*settings)["save_elevation"].toInt() > 0,
                   (*settings)["save_normals"].toInt() > 0})
 {
+  setEventDriven((*settings)["event_driven"].toInt() > 0);
+  initAsyncWriter((*settings)["io_threads"].toInt(),
+                  (*settings)["io_queue_size"].toInt(),
+                  (*settings)["io_overflow_policy"].toString());
+  initMetricsExport((*settings)["metrics_period"].toInt(),
+                    (*settings)["metrics_port"].toInt());
+  initTracing((*settings)["trace"].toInt() > 0);
 }
 
 void SurfaceGeneration::addFrame(const Frame::Ptr &frame)
 {
   // First update statistics about incoming frame rate
-  updateFpsStatisticsIncoming();
+  updateStatisticsIncoming(frame);
 
   std::unique_lock<std::mutex> lock(_mutex_buffer);
   _buffer.push_back(frame);
   // Ringbuffer implementation
   if (_buffer.size() > _queue_size)
+  {
+    updateStatisticsDropped(_buffer.front());
     _buffer.pop_front();
+  }
+  updateStatisticsQueueDepth(_buffer.size());
+  notifyWorkAvailable();
 }
 
 bool SurfaceGeneration::process()
@@ -116,18 +129,34 @@ void SurfaceGeneration::reset()
 void SurfaceGeneration::publish(const Frame::Ptr &frame)
 {
   // First update statistics about outgoing frame rate
-  updateFpsStatisticsOutgoing();
+  updateStatisticsOutgoing(frame);
   _transport_frame(frame, "output/frame");
 }
 
 void SurfaceGeneration::saveIter(const CvGridMap &surface, uint32_t id)
 {
-  if (_settings_save.save_valid)
-    io::saveImage(surface["valid"], _stage_path + "/valid", "valid", id);
+  // Surface is the observed map of the frame, which is modified by the following stages. Writes therefore work on a
+  // snapshot.
+  std::vector<std::string> layer_names;
+  if (_settings_save.save_valid || _settings_save.save_elevation || _settings_save.save_normals)
+    layer_names.emplace_back("valid");
   if (_settings_save.save_elevation)
-    io::saveImageColorMap(surface["elevation"], surface["valid"], _stage_path + "/elevation", "elevation", id, io::ColormapType::ELEVATION);
+    layer_names.emplace_back("elevation");
   if (_settings_save.save_normals && surface.exists("elevation_normal"))
-    io::saveImageColorMap(surface["elevation_normal"], surface["valid"], _stage_path + "/normals", "normal", id, io::ColormapType::NORMALS);
+    layer_names.emplace_back("elevation_normal");
+
+  if (layer_names.empty())
+    return;
+
+  CvGridMap snapshot = surface.cloneSubmap(layer_names);
+  std::string path = _stage_path;
+
+  if (_settings_save.save_valid)
+    saveAsync("valid", [=](){ io::saveImage(snapshot["valid"], path + "/valid", "valid", id); });
+  if (_settings_save.save_elevation)
+    saveAsync("elevation", [=](){ io::saveImageColorMap(snapshot["elevation"], snapshot["valid"], path + "/elevation", "elevation", id, io::ColormapType::ELEVATION); });
+  if (_settings_save.save_normals && snapshot.exists("elevation_normal"))
+    saveAsync("normal", [=](){ io::saveImageColorMap(snapshot["elevation_normal"], snapshot["valid"], path + "/normals", "normal", id, io::ColormapType::NORMALS); });
 }
 
 void SurfaceGeneration::initStageCallback()
@@ -150,6 +179,7 @@ void SurfaceGeneration::printSettingsToLog()
   LOG_F(INFO, "### Stage process settings ###");
   LOG_F(INFO, "- try_use_elevation: %i", _try_use_elevation);
   LOG_F(INFO, "- knn_radius_factor: %4.2f", _knn_radius_factor);
+  LOG_F(INFO, "- GSD: %4.2f", _GSD);
   LOG_F(INFO, "- mode_surface_normals: %i", static_cast<int>(_mode_surface_normals));
 
   LOG_F(INFO, "### Stage save settings ###");
@@ -164,6 +194,8 @@ Frame::Ptr SurfaceGeneration::getNewFrame()
   std::unique_lock<std::mutex> lock(_mutex_buffer);
   Frame::Ptr frame = _buffer.front();
   _buffer.pop_front();
+  updateStatisticsQueueDepth(_buffer.size());
+  updateStatisticsProcessing(frame);
   return (std::move(frame));
 }
 
@@ -217,7 +249,7 @@ DigitalSurfaceModel::Ptr SurfaceGeneration::createPlanarSurface(const Frame::Ptr
 
   // Create planar surface in world frame
   cv::Rect2d roi = frame->getCamera()->projectImageBoundsToPlaneRoi(_plane_reference.pt, _plane_reference.n);
-  auto dsm = std::make_shared<DigitalSurfaceModel>(roi, _projection_plane_offset);
+  auto dsm = std::make_shared<DigitalSurfaceModel>(roi, _projection_plane_offset, (_GSD > 0.0 ? _GSD : 1.0));
   return dsm;
 }
 
@@ -225,6 +257,6 @@ DigitalSurfaceModel::Ptr SurfaceGeneration::createElevationSurface(const Frame::
 {
   // Create elevated 2.5D surface in world frame
   cv::Rect2d roi = frame->getCamera()->projectImageBoundsToPlaneRoi(_plane_reference.pt, _plane_reference.n);
-  auto dsm = std::make_shared<DigitalSurfaceModel>(roi, frame->getSurfacePoints(), _mode_surface_normals, _knn_radius_factor);
+  auto dsm = std::make_shared<DigitalSurfaceModel>(roi, frame->getSurfacePoints(), _mode_surface_normals, _knn_radius_factor, _GSD);
   return dsm;
 }
\ No newline at end of file
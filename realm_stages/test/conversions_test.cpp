@@ -0,0 +1,233 @@
+/**
+* This file is part of OpenREALM.
+*
+* Copyright (C) 2018 Alexander Kern <laxnpander at gmail dot com> (Braunschweig University of Technology)
+* For more information see <https://github.com/laxnpander/OpenREALM>
+*
+* OpenREALM is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* OpenREALM is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with OpenREALM. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <realm_stages/conversions.h>
+
+// gtest
+#include <gtest/gtest.h>
+
+using namespace realm;
+
+namespace
+{
+
+/*!
+ * @brief Sequential reference of the conversion to the BGR_NORMAL_64F layout
+ */
+cv::Mat createPointCloudReference(const cv::Mat &img3d, const cv::Mat &color, const cv::Mat &normals,
+                                  const cv::Mat &mask)
+{
+  cv::Mat points;
+  for (int r = 0; r < img3d.rows; ++r)
+    for (int c = 0; c < img3d.cols; ++c)
+    {
+      if (!mask.empty() && mask.at<uchar>(r, c) == 0)
+        continue;
+
+      const cv::Vec3d &pos = img3d.at<cv::Vec3d>(r, c);
+      const cv::Vec3b &bgr = color.at<cv::Vec3b>(r, c);
+      const cv::Vec3f &n = normals.at<cv::Vec3f>(r, c);
+
+      cv::Mat pt = (cv::Mat_<double>(1, 9) << pos[0], pos[1], pos[2],
+                                              bgr[0]/255.0, bgr[1]/255.0, bgr[2]/255.0,
+                                              n[0], n[1], n[2]);
+      points.push_back(pt);
+    }
+  return points;
+}
+
+/*!
+ * @brief Creates random input data for the conversion, the mask has about half of the elements set
+ */
+void createInput(const cv::Size &size, cv::Mat &img3d, cv::Mat &color, cv::Mat &normals, cv::Mat &mask)
+{
+  cv::RNG rng(42);
+
+  img3d = cv::Mat(size, CV_64FC3);
+  rng.fill(img3d, cv::RNG::UNIFORM, cv::Scalar::all(-100.0), cv::Scalar::all(100.0));
+
+  color = cv::Mat(size, CV_8UC3);
+  rng.fill(color, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(256));
+
+  normals = cv::Mat(size, CV_32FC3);
+  rng.fill(normals, cv::RNG::UNIFORM, cv::Scalar::all(-1.0), cv::Scalar::all(1.0));
+
+  cv::Mat noise(size, CV_8UC1);
+  rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar(0), cv::Scalar(2));
+  mask = (noise > 0);
+}
+
+/*!
+ * @brief Creates a grid map with the elevation layer of the given type and a color layer
+ */
+CvGridMap createGridMap(int elevation_type)
+{
+  CvGridMap map(cv::Rect2d(100.0, 200.0, 40.0, 30.0), 0.5);
+
+  cv::Mat elevation(map.size(), elevation_type);
+  cv::randu(elevation, cv::Scalar(-50.0), cv::Scalar(50.0));
+  map.add("elevation", elevation);
+
+  cv::Mat color(map.size(), CV_8UC4);
+  cv::randu(color, cv::Scalar::all(0), cv::Scalar::all(256));
+  map.add("color_rgb", color);
+
+  cv::Mat valid(map.size(), CV_8UC1, cv::Scalar(255));
+  valid.row(3).setTo(0);
+  valid.col(7).setTo(0);
+  map.add("valid", valid);
+
+  return map;
+}
+
+} // namespace
+
+TEST(Conversions, PointCloudMatchesSequential)
+{
+  // The rows are converted in parallel, the point order and values must still be those of a sequential conversion
+  cv::Mat img3d, color, normals, mask;
+  createInput(cv::Size(160, 120), img3d, color, normals, mask);
+
+  for (const cv::Mat &m : {mask, cv::Mat()})
+  {
+    cv::Mat points = cvtToPointCloud(img3d, color, normals, m);
+    cv::Mat reference = createPointCloudReference(img3d, color, normals, m);
+
+    ASSERT_EQ(points.type(), CV_64F);
+    ASSERT_EQ(points.rows, reference.rows);
+    ASSERT_EQ(points.cols, 9);
+    EXPECT_EQ(cv::norm(points, reference, cv::NORM_INF), 0.0);
+  }
+}
+
+TEST(Conversions, PointCloudEmptyMask)
+{
+  // An empty mask converts all elements, a mask without any valid element none
+  cv::Mat img3d, color, normals, mask;
+  createInput(cv::Size(20, 10), img3d, color, normals, mask);
+
+  EXPECT_EQ(cvtToPointCloud(img3d, color, normals, cv::Mat()).rows, 200);
+  EXPECT_EQ(cvtToPointCloud(img3d, color, normals, cv::Mat::zeros(img3d.size(), CV_8UC1)).rows, 0);
+  EXPECT_EQ(cvtToPointCloud(img3d, color, normals, mask).rows, cv::countNonZero(mask));
+}
+
+TEST(Conversions, PointCloudPackedRgb)
+{
+  cv::Mat img3d, color, normals, mask;
+  createInput(cv::Size(16, 12), img3d, color, normals, mask);
+  color.at<cv::Vec3b>(0, 0) = cv::Vec3b(0x12, 0x34, 0x56);
+
+  cv::Mat points = cvtToPointCloud(img3d, color, normals, cv::Mat(), PointCloudFormat::RGB_PACKED_NORMAL_32F);
+  ASSERT_EQ(points.type(), CV_32F);
+  ASSERT_EQ(points.rows, img3d.rows*img3d.cols);
+  ASSERT_EQ(points.cols, 7);
+
+  // Layout of the first point is checked bit exact, 0x00RRGGBB packed into the float
+  uint32_t rgb;
+  memcpy(&rgb, &points.at<float>(0, 3), sizeof(float));
+  EXPECT_EQ(rgb, 0x00563412u);
+
+  for (int r = 0; r < img3d.rows; ++r)
+    for (int c = 0; c < img3d.cols; ++c)
+    {
+      const float* pt = points.ptr<float>(r*img3d.cols + c);
+      const cv::Vec3d &pos = img3d.at<cv::Vec3d>(r, c);
+      const cv::Vec3b &bgr = color.at<cv::Vec3b>(r, c);
+      const cv::Vec3f &n = normals.at<cv::Vec3f>(r, c);
+
+      memcpy(&rgb, &pt[3], sizeof(float));
+      EXPECT_EQ(rgb >> 24, 0u);
+      EXPECT_EQ((rgb >> 16) & 0xFF, static_cast<uint32_t>(bgr[2]));
+      EXPECT_EQ((rgb >> 8) & 0xFF, static_cast<uint32_t>(bgr[1]));
+      EXPECT_EQ(rgb & 0xFF, static_cast<uint32_t>(bgr[0]));
+
+      EXPECT_FLOAT_EQ(pt[0], static_cast<float>(pos[0]));
+      EXPECT_FLOAT_EQ(pt[1], static_cast<float>(pos[1]));
+      EXPECT_FLOAT_EQ(pt[2], static_cast<float>(pos[2]));
+      EXPECT_EQ(pt[4], n[0]);
+      EXPECT_EQ(pt[5], n[1]);
+      EXPECT_EQ(pt[6], n[2]);
+    }
+}
+
+TEST(Conversions, GridMapPointCloud)
+{
+  // Float and double elevations take different position sources, both must match the positions of the grid map
+  for (int type : {CV_32F, CV_64F})
+  {
+    CvGridMap map = createGridMap(type);
+    const cv::Mat &color = map["color_rgb"];
+    const cv::Mat &valid = map["valid"];
+
+    cv::Mat points = cvtToPointCloud(map, "elevation", "color_rgb", "", "valid");
+    ASSERT_EQ(points.rows, cv::countNonZero(valid));
+
+    int idx = 0;
+    for (int r = 0; r < valid.rows; ++r)
+      for (int c = 0; c < valid.cols; ++c)
+      {
+        if (valid.at<uchar>(r, c) == 0)
+          continue;
+
+        const double* pt = points.ptr<double>(idx++);
+        const cv::Point3d pos = map.atPosition3d(r, c, "elevation");
+        const cv::Vec4b &bgra = color.at<cv::Vec4b>(r, c);
+
+        EXPECT_EQ(pt[0], pos.x);
+        EXPECT_EQ(pt[1], pos.y);
+        EXPECT_EQ(pt[2], pos.z);
+        EXPECT_EQ(pt[3], bgra[0]/255.0);
+        EXPECT_EQ(pt[4], bgra[1]/255.0);
+        EXPECT_EQ(pt[5], bgra[2]/255.0);
+        EXPECT_EQ(pt[6], 0.0);
+        EXPECT_EQ(pt[7], 0.0);
+        EXPECT_EQ(pt[8], 0.0);
+      }
+  }
+}
+
+TEST(Conversions, GridMapMesh)
+{
+  for (int type : {CV_32F, CV_64F})
+  {
+    CvGridMap map = createGridMap(type);
+    const cv::Mat &color = map["color_rgb"];
+
+    std::vector<cv::Point2i> vertex_ids = {
+        cv::Point2i(0, 0), cv::Point2i(1, 0), cv::Point2i(0, 1),
+        cv::Point2i(map.size().width - 1, map.size().height - 1), cv::Point2i(5, 2), cv::Point2i(9, 14)
+    };
+
+    std::vector<Face> faces = cvtToMesh(map, "elevation", "color_rgb", vertex_ids);
+    ASSERT_EQ(faces.size(), 2u);
+
+    for (size_t i = 0; i < faces.size(); ++i)
+      for (size_t j = 0; j < 3; ++j)
+      {
+        const cv::Point2i &id = vertex_ids[3*i + j];
+        EXPECT_EQ(faces[i].vertices[j], map.atPosition3d(id.y, id.x, "elevation"));
+        EXPECT_EQ(faces[i].color[j], color.at<cv::Vec4b>(id.y, id.x));
+      }
+  }
+}
@@ -74,7 +74,7 @@ VisualSlamIF::State OrbSlam2::Track(Frame::Ptr &frame)
 
   // T_w2c defined as transformation from world to camera frame
   cv::Mat T_w2c;
-  T_w2c = _slam->TrackMonocular(frame->getResizedImageRaw(), frame->getTimestamp());
+  T_w2c = _slam->TrackMonocular(frame->getResizedImageRaw(_resizing), frame->getTimestamp());
 
   // In case tracking was successfull and slam not lost
   if (!T_w2c.empty())